@@ -0,0 +1,80 @@
+/*
+ * Written by Brendan Whitfield
+ *
+ * Button debouncing. A change is acted on the moment it's seen, then the button is
+ * left alone for BUTTON_DEBOUNCE while its contacts bounce, so a press costs no latency.
+ * A press that's still down after BUTTON_HOLD_TIME also reports a hold.
+ * Reading the pins is left to the port (ButtonsAvr.cpp), which can sleep the cpu in between.
+ */
+
+
+
+#include "Buttons.h"
+
+
+
+static uint8_t down = 0;     //debounced state, bit per button
+static uint8_t settling = 0; //buttons inside their debounce time
+static uint8_t held = 0;     //buttons that have reported BUTTON_HOLD for this press
+static uint16_t changed[BUTTON_COUNT]; //time each button last changed
+static uint8_t events[BUTTON_COUNT];   //latest event of each button, until it's taken
+
+
+
+void beginButtons()
+{
+  buttonPortBegin();
+
+  //a button held through reset doesn't count as a press
+  down = buttonPortRead();
+  held = down;
+}
+
+void updateButtons(uint16_t now)
+{
+  uint8_t pins = buttonPortRead();
+
+  for(uint8_t i = 0; i < BUTTON_COUNT; i++)
+  {
+    uint8_t bit = 1 << i;
+    uint16_t since = now - changed[i];
+
+    //still bouncing from the last change, leave it be
+    if(settling & bit)
+    {
+      if(since < BUTTON_DEBOUNCE) { continue; }
+      settling &= ~bit;
+    }
+
+    if((pins ^ down) & bit)
+    {
+      down ^= bit;
+      held &= ~bit;
+      settling |= bit;
+      changed[i] = now;
+      events[i] = (down & bit) ? BUTTON_PRESS : BUTTON_RELEASE;
+    }
+    else if((down & bit) && !(held & bit) && (since >= BUTTON_HOLD_TIME))
+    {
+      held |= bit;
+      events[i] = BUTTON_HOLD;
+    }
+  }
+}
+
+uint8_t getButtonEvent(uint8_t button)
+{
+  uint8_t event = events[button];
+  events[button] = BUTTON_NONE;
+  return event;
+}
+
+bool isButtonDown(uint8_t button)
+{
+  return down & (1 << button);
+}
+
+bool buttonsIdle()
+{
+  return !down && !settling;
+}
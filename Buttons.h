@@ -0,0 +1,45 @@
+/*
+ * Written by Brendan Whitfield
+ *
+ */
+
+
+#ifndef BUTTONS_H
+#define BUTTONS_H
+
+#include <stdint.h>
+
+
+//numbered after the analog pin they're on (A0-A2)
+#define BUTTON_DOWN  0
+#define BUTTON_UP    1
+#define BUTTON_BANK  2
+#define BUTTON_COUNT 3
+
+#define BUTTON_DEBOUNCE  20  //milliseconds a button is left alone after it changes (while its contacts bounce)
+#define BUTTON_HOLD_TIME 500 //milliseconds down before a press becomes a hold
+
+//events reported by getButtonEvent()
+#define BUTTON_NONE    0
+#define BUTTON_PRESS   1 //went down (reported on the first edge, the bounce after it is ignored)
+#define BUTTON_HOLD    2 //still down BUTTON_HOLD_TIME after the press
+#define BUTTON_RELEASE 3
+
+
+//debounced buttons (call updateButtons() from loop(), it never waits)
+void beginButtons();
+void updateButtons(uint16_t now); //`now` in milliseconds (millis(), wrapping is fine)
+uint8_t getButtonEvent(uint8_t button); //takes the button's latest event, BUTTON_NONE if there isn't one
+bool isButtonDown(uint8_t button);
+bool buttonsIdle(); //true if every button is up and settled (safe to sleep)
+
+
+/*
+ * Port backend. Reads the pins, and puts the cpu to sleep until one of them changes.
+ */
+
+void buttonPortBegin();
+uint8_t buttonPortRead(); //bit per button (1 << BUTTON_*), set while it's pressed
+void buttonPortSleep();   //sleep until a button changes (or another pin change wakes it). The timers stop, so nothing can be sending
+
+#endif
@@ -0,0 +1,59 @@
+/*
+ * Written by Brendan Whitfield
+ *
+ * ATmega328 port backend for the buttons.
+ * The buttons sit on A0-A2 (PC0-PC2) and read HIGH while pressed. They're read as digital
+ * pins, which takes a cycle, where analogRead() took about 110us a pin.
+ * Each pin also raises a pin change interrupt (PCINT1), which is only there to wake the cpu.
+ * (PCINT1 can't be shared, so this doesn't mix with SoftwareSerial)
+ */
+
+
+
+#ifdef __AVR__
+
+#include <Arduino.h>
+#include <avr/sleep.h>
+#include "Buttons.h"
+
+
+#define BUTTON_PINS  B00000111         //PORTC bits, in BUTTON_* order
+#define BUTTON_SLEEP SLEEP_MODE_STANDBY //oscillator keeps running, so waking takes 6 cycles rather than 16K
+
+
+
+void buttonPortBegin()
+{
+  DDRC &= ~BUTTON_PINS;  //inputs
+  PORTC &= ~BUTTON_PINS; //no pull-ups, the buttons drive the pins HIGH
+  PCMSK1 |= BUTTON_PINS; //PCINT8-10
+  PCIFR = _BV(PCIF1);    //drop any stale change
+  PCICR |= _BV(PCIE1);
+}
+
+uint8_t buttonPortRead()
+{
+  return PINC & BUTTON_PINS;
+}
+
+void buttonPortSleep()
+{
+  set_sleep_mode(BUTTON_SLEEP);
+
+  //a change from here on has to wake the sleep below, not land just before it
+  noInterrupts();
+  if(buttonPortRead())
+  {
+    interrupts();
+    return;
+  }
+  sleep_enable();
+  interrupts(); //the instruction after sei always runs before any interrupt, so nothing slips in
+  sleep_cpu();
+  sleep_disable();
+}
+
+//updateButtons() reads the pins once the cpu is awake
+EMPTY_INTERRUPT(PCINT1_vect);
+
+#endif
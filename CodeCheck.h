@@ -0,0 +1,160 @@
+/*
+ * Written by Brendan Whitfield
+ *
+ * Compile time checks for the code tables. Every entry in Codes.cpp is declared through
+ * IR_CODE(), which works out how big code[] has to be for the entry's length and format,
+ * and that every index it holds is inside the dictionary. A mistyped entry fails to compile,
+ * rather than sending garbage (or reading past the end of the table) at runtime.
+ * Sticks to C++11 constexpr, so each check is a single expression and loops are recursion.
+ */
+
+
+#ifndef CODECHECK_H
+#define CODECHECK_H
+
+#include "Codes.h"
+#include "Protocols.h"
+
+
+//bytes taken by `count` values of `width` bits
+constexpr uint16_t packedBytes(uint16_t count, uint8_t width)
+{
+  return ((count * width) + 7) / 8;
+}
+
+//index number `i` of a packed string (same as packedIndex() in Codes.cpp)
+constexpr uint8_t packedAt(const uint8_t* code, uint16_t i, uint8_t width)
+{
+  return ((code[(i * width) / 8] >> ((i * width) % 8))
+          | ((((i * width) % 8) + width > 8) ? (code[((i * width) / 8) + 1] << (8 - ((i * width) % 8))) : 0))
+         & ((1 << width) - 1);
+}
+
+//true if indices `i` to `count` of a packed string are all below `size`
+constexpr bool packedInDict(const uint8_t* code, uint16_t i, uint16_t count, uint8_t width, uint16_t size)
+{
+  return (i >= count) || ((packedAt(code, i, width) < size) && packedInDict(code, i + 1, count, width, size));
+}
+
+//same again, for a Nibbles string
+constexpr bool nibblesInDict(const Nibbles* code, uint16_t i, uint16_t count, uint16_t size)
+{
+  return (i >= count) || ((((i % 2) ? code[i / 2].lo : code[i / 2].hi) < size) && nibblesInDict(code, i + 1, count, size));
+}
+
+
+
+/*
+ * Repeat codes (see Codes.h). `segment` points at the first two byte entry of the segment list
+ */
+
+//true if no segment in the list is empty
+constexpr bool segmentsValid(const uint8_t* segment, uint8_t count)
+{
+  return !count || (segment[0] && (segment[1] & SEGMENT_REPEATS) && segmentsValid(segment + 2, count - 1));
+}
+
+//bursts sent by the segments
+constexpr uint16_t segmentBursts(const uint8_t* segment, uint8_t count)
+{
+  return !count ? 0 : (segment[0] * (segment[1] & SEGMENT_REPEATS)) + segmentBursts(segment + 2, count - 1);
+}
+
+//indices the segments keep in the index string
+constexpr uint16_t segmentIndices(const uint8_t* segment, uint8_t count)
+{
+  return !count ? 0 : segment[0] + ((segment[1] & SEGMENT_FINAL) ? 1 : 0) + segmentIndices(segment + 2, count - 1);
+}
+
+constexpr bool repeatFits(const uint8_t* code, uint16_t size, uint16_t dictSize, uint8_t length, uint8_t width)
+{
+  return (size > 0) && (size >= 1 + (code[0] * 2))
+      && segmentsValid(code + 1, code[0])
+      && (segmentBursts(code + 1, code[0]) == length)
+      && (size - 1 - (code[0] * 2) == packedBytes(segmentIndices(code + 1, code[0]), width))
+      && packedInDict(code + 1 + (code[0] * 2), 0, segmentIndices(code + 1, code[0]), width, dictSize);
+}
+
+
+
+/*
+ * Protocol codes (see Protocols.h). The payload is one bit per burst, less the leader and stops
+ */
+
+constexpr uint8_t protocolFlags(uint8_t format)
+{
+  return protocols[format - 1].flags;
+}
+
+//bursts in each frame of a pulse protocol code
+constexpr uint8_t protocolFrame(uint8_t format, uint8_t length)
+{
+  return protocols[format - 1].frame ? protocols[format - 1].frame
+                                     : length - ((protocolFlags(format) & PROTOCOL_LEADER) ? 1 : 0);
+}
+
+//bits of payload a protocol code of `length` bursts carries
+constexpr uint16_t payloadBits(uint8_t format, uint8_t length)
+{
+  return (protocolFlags(format) & PROTOCOL_MANCHESTER) ? protocols[format - 1].frame
+       : length - ((protocolFlags(format) & PROTOCOL_LEADER) ? 1 : 0)
+                - ((protocolFlags(format) & PROTOCOL_STOP)
+                   ? (length - ((protocolFlags(format) & PROTOCOL_LEADER) ? 1 : 0)) / protocolFrame(format, length) : 0);
+}
+
+//dictionary entries the encoder reads (manchester only needs the unit, SYMBOL_EXTRA comes with a leader or a stop between frames)
+constexpr uint8_t protocolSymbols(uint8_t format, uint8_t length)
+{
+  return (protocolFlags(format) & PROTOCOL_MANCHESTER) ? 1
+       : ((protocolFlags(format) & PROTOCOL_LEADER)
+          || ((protocolFlags(format) & PROTOCOL_STOP) && (protocolFrame(format, length) < length))) ? 3 : 2;
+}
+
+constexpr bool protocolFits(uint16_t size, uint16_t dictSize, uint8_t length, uint8_t format)
+{
+  return (format - 1 < (int)NUM_ELEM(protocols))
+      && (protocolFrame(format, length) > 0)
+      && (size == packedBytes(payloadBits(format, length), 1))
+      && (dictSize >= protocolSymbols(format, length));
+}
+
+
+
+/*
+ * Whole entries. Byte strings are packed indices, repeat codes, or protocol payloads,
+ * Nibbles strings are always FORMAT_NIBBLES
+ */
+
+template<uint16_t N, uint16_t D>
+constexpr bool codeFits(const uint8_t (&code)[N], const BurstPair (&)[D], uint8_t length, uint8_t format)
+{
+  return (length > 0)
+      && (IS_PROTOCOL(format) ? protocolFits(N, D, length, format)
+        : (format & FORMAT_REPEAT) ? ((format & FORMAT_BITS) && ((format & FORMAT_WIDTH) > 0) && ((format & FORMAT_WIDTH) <= 8)
+                                      && repeatFits(code, N, D, length, format & FORMAT_WIDTH))
+        : (format & FORMAT_BITS) ? (((format & FORMAT_WIDTH) > 0) && ((format & FORMAT_WIDTH) <= 8)
+                                    && (N == packedBytes(length, format & FORMAT_WIDTH))
+                                    && packedInDict(code, 0, length, format & FORMAT_WIDTH, D))
+        : false);
+}
+
+template<uint16_t N, uint16_t D>
+constexpr bool codeFits(const Nibbles (&code)[N], const BurstPair (&)[D], uint8_t length, uint8_t format)
+{
+  return (length > 0) && (format == FORMAT_NIBBLES) && (N == packedBytes(length, 4)) && nibblesInDict(code, 0, length, D);
+}
+
+//hands back the length, if the entry checked out
+template<bool fits, bool carried, uint8_t length>
+struct CheckedLength
+{
+  static_assert(fits, "IRCode doesn't match its code[]: wrong length or format, or an index past the end of the dictionary");
+  static_assert(carried, "IRCode has no carrier (sendCode() turns it away with SEND_BAD)");
+  static constexpr uint8_t value = length;
+};
+
+//an IRCode, checked against its dictionary and code string
+#define IR_CODE(dict, code, carrier, length, format) \
+  {dict, code, carrier, CheckedLength<codeFits(code, dict, length, format), (carrier) != 0, length>::value, format}
+
+#endif
@@ -10,6 +10,9 @@
 
 
 #include "Codes.h"
+#include "Protocols.h"
+#include "Pronto.h"
+#include "CodeCheck.h"
 
 
 
@@ -18,45 +21,155 @@
  * Accepts pointer to IRCode struct from codeSet array.
  * Returns array of burst pairs, ready for sending.
  * DON'T FORGET to delete[] the memory
+ * (prefer the CodeCursor functions below, which decode in place without the heap)
  */
 
 BurstPair* getCode(const IRCode* desired)
 {
-  //get struct information
-  PGM_P current = (PGM_P)desired;
-  BurstPair* dict = (BurstPair*)pgm_read_word(current);
-  current += sizeof(BurstPair*);
-  Nibbles* code = (Nibbles*)pgm_read_word(current);
-  uint8_t codeLength = (uint8_t) getLength(desired);
+  CodeCursor cursor;
+  beginCode(&cursor, desired);
   
   //allocate a place for the finished product to go
-  BurstPair* pairs = new BurstPair[codeLength];
+  BurstPair* pairs = new BurstPair[cursor.length];
   
   //decompress and build burst pair array
-  for(int i = 0; i < codeLength; i++)
+  for(int i = 0; nextBurst(&cursor, pairs + i); i++);
+  
+  return pairs;
+}
+
+/*
+ * Streaming accessors. A CodeCursor walks the index string of an IRCode (or has
+ * the protocol encoder build it), decoding one burst pair at a time straight out of flash.
+ * Uses a constant few bytes of RAM, regardless of code length.
+ */
+
+void beginCode(CodeCursor* cursor, const IRCode* desired, uint8_t space)
+{
+  //get struct information (read once here, the cursor keeps everything needed to send)
+  if(space != CODE_FLASH)
+  {
+    cursor->dict = desired->dict;
+    cursor->code = desired->code;
+    cursor->carrier = desired->carrier;
+    cursor->length = desired->codeLength;
+    cursor->format = desired->format;
+  }
+  else
+  {
+    cursor->dict = (const BurstPair*)pgm_read_ptr(&desired->dict);
+    cursor->code = pgm_read_ptr(&desired->code);
+    cursor->carrier = pgm_read_word(&desired->carrier);
+    cursor->length = pgm_read_byte(&desired->codeLength);
+    cursor->format = pgm_read_byte(&desired->format);
+  }
+  cursor->index = 0;
+  cursor->space = space;
+  
+  if(IS_PROTOCOL(cursor->format)) { beginProtocol(cursor); }
+  
+  if(cursor->format & FORMAT_REPEAT)
+  {
+    //step over the segment list to the index string
+    const uint8_t* header = (const uint8_t*)cursor->code;
+    cursor->segment = header + 1;
+    cursor->code = header + 1 + (pgm_read_byte(header) * 2);
+    cursor->start = 0;
+    cursor->step = 0;
+    cursor->passes = 0;
+  }
+}
+
+//reads index number `i` of a string of `width` bit indices (LSB first)
+static uint8_t packedIndex(const uint8_t* code, uint8_t i, uint8_t width)
+{
+  uint16_t offset = (uint16_t)i * width;
+  uint8_t shift = offset & 7;
+  const uint8_t* at = code + (offset >> 3);
+  uint8_t value = pgm_read_byte(at) >> shift;
+  
+  //the index runs over into the next byte
+  if(shift + width > 8) { value |= pgm_read_byte(at + 1) << (8 - shift); }
+  
+  return value & ((1 << width) - 1);
+}
+
+//position in the index string of the next burst of a repeat code
+static uint8_t repeatIndex(CodeCursor* cursor)
+{
+  uint8_t bursts = pgm_read_byte(cursor->segment);
+  uint8_t repeats = pgm_read_byte(cursor->segment + 1);
+  uint8_t i = cursor->start + cursor->step;
+  
+  if(!cursor->passes) { cursor->passes = repeats & SEGMENT_REPEATS; }
+  if(++cursor->step < bursts) { return i; }
+  
+  //end of a pass
+  cursor->step = 0;
+  if(--cursor->passes) { return i; }
+  
+  //end of the segment, the final pass may end on its own burst
+  if(repeats & SEGMENT_FINAL) { i++; cursor->start++; }
+  cursor->start += bursts;
+  cursor->segment += 2;
+  return i;
+}
+
+//fetches the next burst pair into *pair. Returns false once the code is exhausted
+bool nextBurst(CodeCursor* cursor, BurstPair* pair)
+{
+  //a stream has no length, it ends when the serial port says so
+  if(cursor->space == CODE_STREAM) { return nextStreamBurst(pair); }
+  if(cursor->index >= cursor->length) { return false; }
+  
+  if(IS_PROTOCOL(cursor->format))
+  {
+    nextProtocolBurst(cursor, pair);
+    cursor->index++;
+    return true;
+  }
+  
+  uint8_t i = cursor->index;
+  if(cursor->format & FORMAT_REPEAT) { i = repeatIndex(cursor); }
+  
+  BurstUnion b;
+  if(cursor->space == CODE_RAM)
+  {
+    //learned codes are always nibbles
+    const Nibbles* n = (const Nibbles*)cursor->code + (i / 2);
+    b.b = cursor->dict[(i % 2) ? n->lo : n->hi];
+  }
+  else if(cursor->format == FORMAT_NIBBLES)
   {
     NibbleUnion n;
-    BurstUnion b;
-    n.i = pgm_read_byte(code + ((int)(i / 2)));
-    if(i % 2) { b.i = pgm_read_dword(dict + n.n.lo); } //use LOW
-    else      { b.i = pgm_read_dword(dict + n.n.hi); } //use HI
-    pairs[i] = b.b;
+    n.i = pgm_read_byte((const Nibbles*)cursor->code + (i / 2));
+    if(i % 2) { b.i = pgm_read_dword(cursor->dict + n.n.lo); } //use LOW
+    else      { b.i = pgm_read_dword(cursor->dict + n.n.hi); } //use HI
+  }
+  else
+  {
+    uint8_t width = cursor->format & FORMAT_WIDTH;
+    b.i = pgm_read_dword(cursor->dict + packedIndex((const uint8_t*)cursor->code, i, width));
   }
+  *pair = b.b;
   
-  return pairs;
+  cursor->index++;
+  return true;
 }
 
 int getLength(const IRCode* desired)
 {
-  return (int)(uint8_t)pgm_read_byte(((PGM_P)desired) + sizeof(BurstPair*)
-                                                      + sizeof(Nibbles*));
+  return (int)(uint8_t)pgm_read_byte(&desired->codeLength);
 }
 
 int getCarrier(const IRCode* desired)
 {
-  return (int)(uint8_t)pgm_read_byte(((PGM_P)desired) + sizeof(BurstPair*)
-                                                      + sizeof(Nibbles*)
-                                                      + 1);
+  return (int)(uint16_t)pgm_read_word(&desired->carrier);
+}
+
+int getFormat(const IRCode* desired)
+{
+  return (int)(uint8_t)pgm_read_byte(&desired->format);
 }
 
 
@@ -65,152 +178,155 @@ int getCarrier(const IRCode* desired)
  * Raw dictionary and code data. Linked to functions by pointers (shared dictionaries save space)
  * Dictionaries store the different burst pairs.
  * Codes store the a list of dictionary indices in the order of transmission.
- * Indices for the codes are stored in nibbles to save space (hence the grouping)
- * Full list of burst pairs is compiled prior to transmission (slower, but saves space)
+ * Indices for the codes are stored in nibbles to save space (hence the grouping),
+ * or packed even tighter when the dictionary is small (FORMAT_BITS_*)
+ * Repeated frames and runs of the same burst are stored once, with a count (FORMAT_REPEAT)
+ * Codes in a standard protocol store just their payload bits, and use the dictionary for timing (see Protocols.h)
+ * Bursts are decoded one at a time during transmission (see CodeCursor)
+ *
+ * Generated by tools/gencodes.py from codes/manifest.txt, edit those rather than this
  */
 
 //TVs
 
-const BurstPair dict_samsung_tv[] PROGMEM = {{172, 171}, {21, 65}, {21, 22}};
-const Nibbles code_samsung_tv_POWER_ON[]     PROGMEM = {{0, 1}, {1, 1}, {2, 2}, {2, 2}, {2, 1}, {1, 1}, {2, 2}, {2, 2}, {2, 1}, {2, 2}, {1, 1}, {2, 2}, {1, 2}, {1, 1}, {2, 2}, {1, 1}, {2, 2}};
-const Nibbles code_samsung_tv_POWER_OFF[]    PROGMEM = {{0, 1}, {1, 1}, {2, 2}, {2, 2}, {2, 1}, {1, 1}, {2, 2}, {2, 2}, {2, 2}, {2, 2}, {1, 1}, {2, 2}, {1, 1}, {1, 1}, {2, 2}, {1, 1}, {2, 2}};
-const Nibbles code_samsung_tv_MUTE[]         PROGMEM = {{0, 1}, {1, 1}, {2, 2}, {2, 2}, {2, 1}, {1, 1}, {2, 2}, {2, 2}, {2, 1}, {1, 1}, {1, 2}, {2, 2}, {2, 2}, {2, 2}, {2, 1}, {1, 1}, {1, 2}};
-const Nibbles code_samsung_tv_VOLUME_UP[]    PROGMEM = {{0, 1}, {1, 1}, {2, 2}, {2, 2}, {2, 1}, {1, 1}, {2, 2}, {2, 2}, {2, 1}, {1, 1}, {2, 2}, {2, 2}, {2, 2}, {2, 2}, {1, 1}, {1, 1}, {1, 2}};
-const Nibbles code_samsung_tv_VOLUME_DOWN[]  PROGMEM = {{0, 1}, {1, 1}, {2, 2}, {2, 2}, {2, 1}, {1, 1}, {2, 2}, {2, 2}, {2, 1}, {1, 2}, {1, 2}, {2, 2}, {2, 2}, {2, 1}, {2, 1}, {1, 1}, {1, 2}};
-const Nibbles code_samsung_tv_CHANNEL_UP[]   PROGMEM = {{0, 1}, {1, 1}, {2, 2}, {2, 2}, {2, 1}, {1, 1}, {2, 2}, {2, 2}, {2, 2}, {1, 2}, {2, 1}, {2, 2}, {2, 1}, {2, 1}, {1, 2}, {1, 1}, {1, 2}};
-const Nibbles code_samsung_tv_CHANNEL_DOWN[] PROGMEM = {{0, 1}, {1, 1}, {2, 2}, {2, 2}, {2, 1}, {1, 1}, {2, 2}, {2, 2}, {2, 2}, {2, 2}, {2, 1}, {2, 2}, {2, 1}, {1, 1}, {1, 2}, {1, 1}, {1, 2}};
-
-const BurstPair dict_lge_tv[] PROGMEM = {{343, 171}, {22, 21}, {22, 63}};
-const Nibbles code_lge_tv_POWER_ON[]     PROGMEM = {{0, 1}, {1, 2}, {1, 1}, {1, 1}, {1, 2}, {2, 1}, {2, 2}, {2, 2}, {2, 1}, {1, 2}, {1, 1}, {1, 2}, {2, 2}, {2, 1}, {2, 2}, {2, 1}, {1, 1}};
-const Nibbles code_lge_tv_POWER_OFF[]    PROGMEM = {{0, 1}, {1, 2}, {1, 1}, {1, 1}, {1, 2}, {2, 1}, {2, 2}, {2, 2}, {2, 2}, {1, 2}, {1, 1}, {1, 2}, {2, 1}, {2, 1}, {2, 2}, {2, 1}, {1, 1}};
-const Nibbles code_lge_tv_MUTE[]         PROGMEM = {{0, 1}, {1, 2}, {1, 1}, {1, 1}, {1, 2}, {2, 1}, {2, 2}, {2, 2}, {2, 2}, {1, 1}, {2, 1}, {1, 1}, {1, 1}, {2, 2}, {1, 2}, {2, 2}, {2, 1}};
-const Nibbles code_lge_tv_VOLUME_UP[]    PROGMEM = {{0, 1}, {1, 2}, {1, 1}, {1, 1}, {1, 2}, {2, 1}, {2, 2}, {2, 2}, {2, 1}, {2, 1}, {1, 1}, {1, 1}, {1, 2}, {1, 2}, {2, 2}, {2, 2}, {2, 1}};
-const Nibbles code_lge_tv_VOLUME_DOWN[]  PROGMEM = {{0, 1}, {1, 2}, {1, 1}, {1, 1}, {1, 2}, {2, 1}, {2, 2}, {2, 2}, {2, 2}, {2, 1}, {1, 1}, {1, 1}, {1, 1}, {1, 2}, {2, 2}, {2, 2}, {2, 1}};
-const Nibbles code_lge_tv_CHANNEL_UP[]   PROGMEM = {{0, 1}, {1, 2}, {1, 1}, {1, 1}, {1, 2}, {2, 1}, {2, 2}, {2, 2}, {2, 1}, {1, 1}, {1, 1}, {1, 1}, {1, 2}, {2, 2}, {2, 2}, {2, 2}, {2, 1}};
-const Nibbles code_lge_tv_CHANNEL_DOWN[] PROGMEM = {{0, 1}, {1, 2}, {1, 1}, {1, 1}, {1, 2}, {2, 1}, {2, 2}, {2, 2}, {2, 2}, {1, 1}, {1, 1}, {1, 1}, {1, 1}, {2, 2}, {2, 2}, {2, 2}, {2, 1}};
-
-const BurstPair dict_sony_tv[] PROGMEM = {{96, 24}, {24, 24}, {48, 24}};
-const Nibbles code_sony_tv_POWER_ON[]     PROGMEM = {{0, 1}, {2, 2}, {2, 1}, {2, 1}, {2, 1}, {1, 1}, {1, 0}};
-const Nibbles code_sony_tv_POWER_OFF[]    PROGMEM = {{0, 2}, {2, 2}, {2, 1}, {2, 1}, {2, 1}, {1, 1}, {1, 0}};
-const Nibbles code_sony_tv_MUTE[]         PROGMEM = {{0, 1}, {1, 2}, {1, 2}, {1, 1}, {2, 1}, {1, 1}, {1, 0}};
-const Nibbles code_sony_tv_VOLUME_UP[]    PROGMEM = {{0, 1}, {2, 1}, {1, 2}, {1, 1}, {2, 1}, {1, 1}, {1, 0}};
-const Nibbles code_sony_tv_VOLUME_DOWN[]  PROGMEM = {{0, 2}, {2, 1}, {1, 2}, {1, 1}, {2, 1}, {1, 1}, {1, 0}};
-const Nibbles code_sony_tv_CHANNEL_UP[]   PROGMEM = {{0, 1}, {1, 1}, {1, 2}, {1, 1}, {2, 1}, {1, 1}, {1, 0}};
-const Nibbles code_sony_tv_CHANNEL_DOWN[] PROGMEM = {{0, 2}, {1, 1}, {1, 2}, {1, 1}, {2, 1}, {1, 1}, {1, 0}};
-
-const BurstPair dict_panasonic_tv[] PROGMEM = {{16, 16}, {16, 48}, {128, 64}};
-const Nibbles code_panasonic_tv_POWER_ON[]     PROGMEM = {{2, 0}, {1, 0}, {0, 0}, {0, 0}, {0, 0}, {0, 0}, {0, 0}, {1, 0}, {0, 0}, {0, 0}, {0, 0}, {0, 0}, {1, 0}, {0, 0}, {0, 0}, {0, 0}, {0, 0}, {1, 1}, {1, 1}, {1, 0}, {0, 0}, {1, 1}, {1, 1}, {1, 0}, {1, 0}};
-const Nibbles code_panasonic_tv_POWER_OFF[]    PROGMEM = {{2, 0}, {1, 0}, {0, 0}, {0, 0}, {0, 0}, {0, 0}, {0, 0}, {1, 0}, {0, 0}, {0, 0}, {0, 0}, {0, 0}, {1, 0}, {0, 0}, {0, 0}, {0, 0}, {0, 1}, {1, 1}, {1, 1}, {1, 0}, {0, 1}, {1, 1}, {1, 1}, {1, 0}, {1, 0}};
-const Nibbles code_panasonic_tv_MUTE[]         PROGMEM = {{2, 0}, {1, 0}, {0, 0}, {0, 0}, {0, 0}, {0, 0}, {0, 0}, {1, 0}, {0, 0}, {0, 0}, {0, 0}, {0, 0}, {1, 0}, {0, 0}, {0, 0}, {0, 0}, {0, 0}, {1, 0}, {0, 1}, {1, 0}, {0, 0}, {1, 0}, {0, 1}, {1, 0}, {1, 0}};
-const Nibbles code_panasonic_tv_VOLUME_UP[]    PROGMEM = {{2, 0}, {1, 0}, {0, 0}, {0, 0}, {0, 0}, {0, 0}, {0, 0}, {1, 0}, {0, 0}, {0, 0}, {0, 0}, {0, 0}, {1, 0}, {0, 0}, {0, 0}, {0, 0}, {0, 0}, {0, 0}, {0, 0}, {1, 0}, {0, 0}, {0, 0}, {0, 0}, {1, 0}, {1, 0}};
-const Nibbles code_panasonic_tv_VOLUME_DOWN[]  PROGMEM = {{2, 0}, {1, 0}, {0, 0}, {0, 0}, {0, 0}, {0, 0}, {0, 0}, {1, 0}, {0, 0}, {0, 0}, {0, 0}, {0, 0}, {1, 0}, {0, 0}, {0, 0}, {0, 0}, {0, 1}, {0, 0}, {0, 0}, {1, 0}, {0, 1}, {0, 0}, {0, 0}, {1, 0}, {1, 0}};
-const Nibbles code_panasonic_tv_CHANNEL_UP[]   PROGMEM = {{2, 0}, {1, 0}, {0, 0}, {0, 0}, {0, 0}, {0, 0}, {0, 0}, {1, 0}, {0, 0}, {0, 0}, {0, 0}, {0, 0}, {1, 0}, {0, 0}, {0, 0}, {0, 0}, {0, 0}, {0, 1}, {0, 1}, {1, 0}, {0, 0}, {0, 1}, {0, 1}, {1, 0}, {1, 0}};
-const Nibbles code_panasonic_tv_CHANNEL_DOWN[] PROGMEM = {{2, 0}, {1, 0}, {0, 0}, {0, 0}, {0, 0}, {0, 0}, {0, 0}, {1, 0}, {0, 0}, {0, 0}, {0, 0}, {0, 0}, {1, 0}, {0, 0}, {0, 0}, {0, 0}, {0, 1}, {0, 1}, {0, 1}, {1, 0}, {0, 1}, {0, 1}, {0, 1}, {1, 0}, {1, 0}};
-
-const BurstPair dict_sharp_tv[] PROGMEM = {{10, 72}, {10, 29}};
-const Nibbles code_sharp_tv_POWER_ON[]     PROGMEM = {{0, 1}, {1, 1}, {0, 1}, {0, 1}, {0, 1}, {1, 0}, {1, 0}, {1, 1}};
-const Nibbles code_sharp_tv_POWER_OFF[]    PROGMEM = {{0, 1}, {1, 1}, {0, 0}, {0, 1}, {0, 1}, {1, 0}, {1, 0}, {1, 1}};
-const Nibbles code_sharp_tv_MUTE[]         PROGMEM = {{0, 1}, {1, 1}, {1, 0}, {0, 0}, {1, 0}, {1, 1}, {1, 0}, {1, 1}};
-const Nibbles code_sharp_tv_VOLUME_UP[]    PROGMEM = {{0, 1}, {1, 1}, {1, 1}, {1, 0}, {1, 0}, {1, 1}, {1, 0}, {1, 1}};
-const Nibbles code_sharp_tv_VOLUME_DOWN[]  PROGMEM = {{0, 1}, {1, 1}, {1, 0}, {1, 0}, {1, 0}, {1, 1}, {1, 0}, {1, 1}};
-const Nibbles code_sharp_tv_CHANNEL_UP[]   PROGMEM = {{0, 1}, {1, 1}, {1, 0}, {1, 1}, {1, 0}, {1, 1}, {1, 0}, {1, 1}};
-const Nibbles code_sharp_tv_CHANNEL_DOWN[] PROGMEM = {{0, 1}, {1, 1}, {1, 1}, {0, 1}, {1, 0}, {1, 1}, {1, 0}, {1, 1}};
-
-const BurstPair dict_philips_tv[] PROGMEM = {{32, 32}, {64, 32}, {32, 64}, {64, 64}};
-const Nibbles code_philips_tv_POWER_ON[]     PROGMEM = {{0, 1}, {0, 0}, {0, 0}, {2, 0}, {0, 0}, {0, 0}, {0, 0}};
-const Nibbles code_philips_tv_POWER_OFF[]    PROGMEM = {{0, 1}, {0, 0}, {0, 0}, {2, 0}, {0, 0}, {3, 0}};
-const Nibbles code_philips_tv_MUTE[]         PROGMEM = {{0, 1}, {0, 0}, {0, 0}, {0, 0}, {2, 0}, {3, 0}};
-const Nibbles code_philips_tv_VOLUME_UP[]    PROGMEM = {{0, 1}, {0, 0}, {0, 0}, {0, 2}, {1, 0}, {0, 0}};
-const Nibbles code_philips_tv_VOLUME_DOWN[]  PROGMEM = {{0, 1}, {0, 0}, {0, 0}, {0, 2}, {1, 0}, {2, 0}};
-const Nibbles code_philips_tv_CHANNEL_UP[]   PROGMEM = {{0, 1}, {0, 0}, {0, 0}, {2, 1}, {0, 0}, {0, 0}};
-const Nibbles code_philips_tv_CHANNEL_DOWN[] PROGMEM = {{0, 1}, {0, 0}, {0, 0}, {2, 1}, {0, 0}, {2, 0}};
-
-const BurstPair dict_vizio_tv[] PROGMEM = {{343, 172}, {21, 22}, {21, 65}};
-const Nibbles code_vizio_tv_POWER_ON[]     PROGMEM = {{0, 1}, {1, 2}, {1, 1}, {1, 1}, {1, 2}, {2, 1}, {2, 2}, {2, 2}, {2, 1}, {2, 1}, {2, 1}, {2, 1}, {1, 2}, {1, 2}, {1, 2}, {1, 2}, {2, 1}};
-const Nibbles code_vizio_tv_POWER_OFF[]    PROGMEM = {{0, 1}, {1, 2}, {1, 1}, {1, 1}, {1, 2}, {2, 1}, {2, 2}, {2, 2}, {2, 2}, {1, 2}, {1, 1}, {2, 1}, {1, 1}, {2, 1}, {2, 2}, {1, 2}, {2, 1}};
-const Nibbles code_vizio_tv_MUTE_ON[]      PROGMEM = {{0, 1}, {1, 2}, {1, 1}, {1, 1}, {1, 2}, {2, 1}, {2, 2}, {2, 2}, {2, 1}, {1, 1}, {1, 1}, {2, 1}, {1, 2}, {2, 2}, {2, 2}, {1, 2}, {2, 1}};
-const Nibbles code_vizio_tv_MUTE_OFF[]     PROGMEM = {{0, 1}, {1, 2}, {1, 1}, {1, 1}, {1, 2}, {2, 1}, {2, 2}, {2, 2}, {2, 2}, {1, 1}, {1, 1}, {2, 1}, {1, 1}, {2, 2}, {2, 2}, {1, 2}, {2, 1}};
-const Nibbles code_vizio_tv_VOLUME_UP[]    PROGMEM = {{0, 1}, {1, 2}, {1, 1}, {1, 1}, {1, 2}, {2, 1}, {2, 2}, {2, 2}, {2, 1}, {2, 1}, {1, 1}, {1, 1}, {1, 2}, {1, 2}, {2, 2}, {2, 2}, {2, 1}};
-const Nibbles code_vizio_tv_VOLUME_DOWN[]  PROGMEM = {{0, 1}, {1, 2}, {1, 1}, {1, 1}, {1, 2}, {2, 1}, {2, 2}, {2, 2}, {2, 2}, {2, 1}, {1, 1}, {1, 1}, {1, 1}, {1, 2}, {2, 2}, {2, 2}, {2, 1}};
-const Nibbles code_vizio_tv_CHANNEL_UP[]   PROGMEM = {{0, 1}, {1, 2}, {1, 1}, {1, 1}, {1, 2}, {2, 1}, {2, 2}, {2, 2}, {2, 1}, {1, 1}, {1, 1}, {1, 1}, {1, 2}, {2, 2}, {2, 2}, {2, 2}, {2, 1}};
-const Nibbles code_vizio_tv_CHANNEL_DOWN[] PROGMEM = {{0, 1}, {1, 2}, {1, 1}, {1, 1}, {1, 2}, {2, 1}, {2, 2}, {2, 2}, {2, 2}, {1, 1}, {1, 1}, {1, 1}, {1, 1}, {2, 2}, {2, 2}, {2, 2}, {2, 1}};
-
-const BurstPair dict_pioneer_tv[] PROGMEM = {{360, 180}, {22, 22}, {22, 67}};
-const Nibbles code_pioneer_tv_POWER_ON[]     PROGMEM = {{0, 1}, {2, 1}, {2, 1}, {2, 1}, {2, 2}, {1, 2}, {1, 2}, {1, 2}, {1, 1}, {1, 2}, {2, 2}, {1, 1}, {1, 2}, {2, 1}, {1, 1}, {2, 2}, {2, 1}};
-const Nibbles code_pioneer_tv_POWER_OFF[]    PROGMEM = {{0, 1}, {2, 1}, {2, 1}, {2, 1}, {2, 2}, {1, 2}, {1, 2}, {1, 2}, {1, 2}, {2, 1}, {2, 2}, {1, 1}, {1, 1}, {1, 2}, {1, 1}, {2, 2}, {2, 1}};
-const Nibbles code_pioneer_tv_MUTE[]         PROGMEM = {{0, 1}, {2, 1}, {2, 1}, {2, 1}, {2, 2}, {1, 2}, {1, 2}, {1, 2}, {1, 2}, {1, 1}, {2, 1}, {1, 2}, {1, 1}, {2, 2}, {1, 2}, {2, 1}, {2, 1}};
-const Nibbles code_pioneer_tv_VOLUME_UP[]    PROGMEM = {{0, 1}, {2, 1}, {2, 1}, {2, 1}, {2, 2}, {1, 2}, {1, 2}, {1, 2}, {1, 1}, {2, 1}, {2, 1}, {1, 1}, {1, 2}, {1, 2}, {1, 2}, {2, 2}, {2, 1}};
-const Nibbles code_pioneer_tv_VOLUME_DOWN[]  PROGMEM = {{0, 1}, {2, 1}, {2, 1}, {2, 1}, {2, 2}, {1, 2}, {1, 2}, {1, 2}, {1, 2}, {2, 1}, {2, 1}, {1, 1}, {1, 1}, {1, 2}, {1, 2}, {2, 2}, {2, 1}};
-const Nibbles code_pioneer_tv_CHANNEL_UP[]   PROGMEM = {{0, 1}, {2, 1}, {2, 1}, {2, 1}, {2, 2}, {1, 2}, {1, 2}, {1, 2}, {1, 1}, {1, 1}, {1, 2}, {1, 1}, {1, 2}, {2, 2}, {2, 1}, {2, 2}, {2, 1}};
-const Nibbles code_pioneer_tv_CHANNEL_DOWN[] PROGMEM = {{0, 1}, {2, 1}, {2, 1}, {2, 1}, {2, 2}, {1, 2}, {1, 2}, {1, 2}, {1, 2}, {1, 1}, {1, 2}, {1, 1}, {1, 1}, {2, 2}, {2, 1}, {2, 2}, {2, 1}};
-
-const BurstPair dict_mitsubishi_tv[] PROGMEM = {{10, 68}, {10, 29}};
-const Nibbles code_mitsubishi_tv_POWER_ON[]     PROGMEM = {{0, 0}, {0, 1}, {1, 1}, {0, 1}, {1, 0}, {1, 1}, {1, 1}, {0, 1}, {1, 0}};
-const Nibbles code_mitsubishi_tv_POWER_OFF[]    PROGMEM = {{0, 0}, {0, 1}, {1, 1}, {0, 1}, {1, 0}, {1, 0}, {1, 1}, {0, 1}, {1, 0}};
-const Nibbles code_mitsubishi_tv_MUTE[]         PROGMEM = {{0, 0}, {0, 1}, {1, 1}, {0, 1}, {1, 0}, {1, 1}, {0, 0}, {1, 1}, {1, 0}};
-const Nibbles code_mitsubishi_tv_VOLUME_UP[]    PROGMEM = {{0, 0}, {0, 1}, {1, 1}, {0, 1}, {1, 0}, {1, 1}, {1, 0}, {1, 1}, {1, 0}};
-const Nibbles code_mitsubishi_tv_VOLUME_DOWN[]  PROGMEM = {{0, 0}, {0, 1}, {1, 1}, {0, 1}, {1, 0}, {1, 0}, {1, 0}, {1, 1}, {1, 0}};
-const Nibbles code_mitsubishi_tv_CHANNEL_UP[]   PROGMEM = {{0, 0}, {0, 1}, {1, 1}, {0, 1}, {1, 0}, {1, 0}, {1, 1}, {1, 1}, {1, 0}};
-const Nibbles code_mitsubishi_tv_CHANNEL_DOWN[] PROGMEM = {{0, 0}, {0, 1}, {1, 1}, {0, 1}, {1, 0}, {1, 1}, {0, 1}, {1, 1}, {1, 0}};
-
-const BurstPair dict_fujitsu_tv[] PROGMEM = {{122, 61}, {15, 15}, {15, 46}};
-const Nibbles code_fujitsu_tv_POWER_ON[]     PROGMEM = {{0, 1}, {1, 2}, {1, 2}, {1, 1}, {1, 2}, {2, 1}, {1, 1}, {2, 2}, {1, 1}, {1, 1}, {1, 1}, {1, 1}, {1, 1}, {1, 2}, {1, 1}, {1, 1}, {2, 1}, {2, 1}, {2, 1}, {1, 1}, {2, 2}, {1, 1}, {1, 1}, {1, 1}, {1, 1}};
-const Nibbles code_fujitsu_tv_POWER_OFF[]    PROGMEM = {{0, 1}, {1, 2}, {1, 2}, {1, 1}, {1, 2}, {2, 1}, {1, 1}, {2, 2}, {1, 1}, {1, 1}, {1, 1}, {1, 1}, {1, 1}, {1, 2}, {1, 1}, {1, 1}, {2, 1}, {2, 1}, {2, 1}, {1, 1}, {2, 1}, {2, 1}, {1, 1}, {1, 1}, {1, 1}};
-const Nibbles code_fujitsu_tv_MUTE[]         PROGMEM = {{0, 1}, {1, 2}, {1, 2}, {1, 1}, {1, 2}, {2, 1}, {1, 1}, {2, 2}, {1, 1}, {1, 1}, {1, 1}, {1, 1}, {1, 1}, {1, 2}, {1, 1}, {1, 1}, {2, 1}, {1, 2}, {2, 1}, {1, 1}, {2, 1}, {2, 1}, {1, 2}, {1, 1}, {1, 1}};
-const Nibbles code_fujitsu_tv_VOLUME_UP[]    PROGMEM = {{0, 1}, {1, 2}, {1, 2}, {1, 1}, {1, 2}, {2, 1}, {1, 1}, {2, 2}, {1, 1}, {1, 1}, {1, 1}, {1, 1}, {1, 1}, {1, 2}, {1, 1}, {1, 1}, {2, 1}, {1, 2}, {2, 1}, {1, 1}, {2, 1}, {1, 1}, {1, 2}, {1, 1}, {1, 1}};
-const Nibbles code_fujitsu_tv_VOLUME_DOWN[]  PROGMEM = {{0, 1}, {1, 2}, {1, 2}, {1, 1}, {1, 2}, {2, 1}, {1, 1}, {2, 2}, {1, 1}, {1, 1}, {1, 1}, {1, 1}, {1, 1}, {1, 2}, {1, 1}, {1, 1}, {2, 1}, {1, 2}, {2, 1}, {1, 1}, {2, 2}, {1, 1}, {1, 2}, {1, 1}, {1, 1}};
-const Nibbles code_fujitsu_tv_CHANNEL_UP[]   PROGMEM = {{0, 1}, {1, 2}, {1, 2}, {1, 1}, {1, 2}, {2, 1}, {1, 1}, {2, 2}, {1, 1}, {1, 1}, {1, 1}, {1, 1}, {1, 1}, {1, 2}, {1, 1}, {1, 1}, {2, 2}, {1, 2}, {2, 1}, {1, 1}, {2, 2}, {2, 1}, {2, 1}, {1, 1}, {1, 1}};
-const Nibbles code_fujitsu_tv_CHANNEL_DOWN[] PROGMEM = {{0, 1}, {1, 2}, {1, 2}, {1, 1}, {1, 2}, {2, 1}, {1, 1}, {2, 2}, {1, 1}, {1, 1}, {1, 1}, {1, 1}, {1, 1}, {1, 2}, {1, 1}, {1, 1}, {2, 2}, {1, 2}, {2, 1}, {1, 1}, {2, 1}, {1, 2}, {2, 1}, {1, 1}, {1, 1}};
-
-const BurstPair dict_toshiba_tv[] PROGMEM = {{343, 172}, {21, 22}, {21, 65}};
-const Nibbles code_toshiba_tv_POWER_ON[]     PROGMEM = {{0, 1}, {1, 1}, {1, 1}, {1, 2}, {1, 1}, {1, 1}, {1, 1}, {1, 1}, {1, 2}, {2, 2}, {2, 2}, {2, 2}, {1, 1}, {1, 1}, {1, 1}, {1, 1}, {2, 1}};
-const Nibbles code_toshiba_tv_POWER_OFF[]    PROGMEM = {{0, 1}, {1, 1}, {1, 1}, {1, 2}, {1, 1}, {1, 1}, {1, 1}, {1, 1}, {1, 1}, {2, 2}, {2, 2}, {2, 2}, {1, 2}, {1, 1}, {1, 1}, {1, 1}, {2, 1}};
-const Nibbles code_toshiba_tv_MUTE[]         PROGMEM = {{0, 1}, {1, 1}, {1, 1}, {1, 2}, {1, 1}, {1, 1}, {1, 1}, {1, 1}, {1, 1}, {1, 1}, {1, 2}, {1, 1}, {1, 2}, {2, 2}, {2, 1}, {2, 2}, {2, 1}};
-const Nibbles code_toshiba_tv_VOLUME_UP[]    PROGMEM = {{0, 1}, {1, 1}, {1, 1}, {1, 2}, {1, 1}, {1, 1}, {1, 1}, {1, 1}, {1, 1}, {2, 1}, {2, 2}, {1, 1}, {1, 2}, {1, 2}, {1, 1}, {2, 2}, {2, 1}};
-const Nibbles code_toshiba_tv_VOLUME_DOWN[]  PROGMEM = {{0, 1}, {1, 1}, {1, 1}, {1, 2}, {1, 1}, {1, 1}, {1, 1}, {1, 1}, {1, 1}, {2, 2}, {2, 2}, {1, 1}, {1, 2}, {1, 1}, {1, 1}, {2, 2}, {2, 1}};
-const Nibbles code_toshiba_tv_CHANNEL_UP[]   PROGMEM = {{0, 1}, {1, 1}, {1, 1}, {1, 2}, {1, 1}, {1, 1}, {1, 1}, {1, 1}, {1, 2}, {2, 1}, {2, 2}, {1, 1}, {1, 1}, {1, 2}, {1, 1}, {2, 2}, {2, 1}};
-const Nibbles code_toshiba_tv_CHANNEL_DOWN[] PROGMEM = {{0, 1}, {1, 1}, {1, 1}, {1, 2}, {1, 1}, {1, 1}, {1, 1}, {1, 1}, {1, 2}, {2, 2}, {2, 2}, {1, 1}, {1, 1}, {1, 1}, {1, 1}, {2, 2}, {2, 1}};
-
-const BurstPair dict_sanyo_tv[] PROGMEM = {{343, 172}, {21, 22}, {21, 65}};
-const Nibbles code_sanyo_tv_POWER_ON[]     PROGMEM = {{0, 1}, {1, 1}, {2, 2}, {2, 1}, {1, 2}, {2, 2}, {1, 1}, {1, 2}, {2, 1}, {2, 1}, {1, 2}, {1, 1}, {1, 2}, {1, 2}, {2, 1}, {2, 2}, {2, 1}};
-const Nibbles code_sanyo_tv_POWER_OFF[]    PROGMEM = {{0, 1}, {1, 1}, {2, 2}, {2, 1}, {1, 2}, {2, 2}, {1, 1}, {1, 2}, {2, 1}, {2, 2}, {1, 2}, {2, 2}, {1, 2}, {1, 1}, {2, 1}, {1, 1}, {2, 1}};
-const Nibbles code_sanyo_tv_MUTE[]         PROGMEM = {{0, 1}, {1, 1}, {2, 2}, {2, 1}, {1, 2}, {2, 2}, {1, 1}, {1, 2}, {2, 1}, {1, 1}, {2, 2}, {1, 1}, {1, 2}, {2, 2}, {1, 1}, {2, 2}, {2, 1}};
-const Nibbles code_sanyo_tv_VOLUME_UP[]    PROGMEM = {{0, 1}, {1, 1}, {2, 2}, {2, 1}, {1, 2}, {2, 2}, {1, 1}, {1, 2}, {2, 1}, {2, 2}, {2, 1}, {1, 1}, {1, 2}, {1, 1}, {1, 2}, {2, 2}, {2, 1}};
-const Nibbles code_sanyo_tv_VOLUME_DOWN[]  PROGMEM = {{0, 1}, {1, 1}, {2, 2}, {2, 1}, {1, 2}, {2, 2}, {1, 1}, {1, 2}, {2, 2}, {2, 2}, {2, 1}, {1, 1}, {1, 1}, {1, 1}, {1, 2}, {2, 2}, {2, 1}};
-const Nibbles code_sanyo_tv_CHANNEL_UP[]   PROGMEM = {{0, 1}, {1, 1}, {2, 2}, {2, 1}, {1, 2}, {2, 2}, {1, 1}, {1, 2}, {2, 1}, {2, 1}, {2, 1}, {1, 1}, {1, 2}, {1, 2}, {1, 2}, {2, 2}, {2, 1}};
-const Nibbles code_sanyo_tv_CHANNEL_DOWN[] PROGMEM = {{0, 1}, {1, 1}, {2, 2}, {2, 1}, {1, 2}, {2, 2}, {1, 1}, {1, 2}, {2, 2}, {2, 1}, {2, 1}, {1, 1}, {1, 1}, {1, 2}, {1, 2}, {2, 2}, {2, 1}};
-
-const BurstPair dict_jvc_tv[] PROGMEM = {{321, 160}, {20, 60}, {20, 20}};
-const Nibbles code_jvc_tv_POWER_ON[]     PROGMEM = {{0, 1}, {1, 2}, {2, 1}, {2, 1}, {2, 1}, {2, 1}, {1, 1}, {2, 2}, {2, 2}};
-const Nibbles code_jvc_tv_POWER_OFF[]    PROGMEM = {{0, 1}, {1, 2}, {2, 1}, {2, 1}, {2, 2}, {1, 2}, {1, 1}, {2, 2}, {2, 2}};
-const Nibbles code_jvc_tv_MUTE[]         PROGMEM = {{0, 1}, {1, 2}, {2, 1}, {2, 1}, {2, 2}, {2, 1}, {1, 1}, {2, 2}, {2, 2}};
-const Nibbles code_jvc_tv_VOLUME_UP[]    PROGMEM = {{0, 1}, {1, 2}, {2, 1}, {2, 1}, {2, 2}, {1, 1}, {1, 1}, {2, 2}, {2, 2}};
-const Nibbles code_jvc_tv_VOLUME_DOWN[]  PROGMEM = {{0, 1}, {1, 2}, {2, 1}, {2, 1}, {2, 1}, {1, 1}, {1, 1}, {2, 2}, {2, 2}};
-const Nibbles code_jvc_tv_CHANNEL_UP[]   PROGMEM = {{0, 1}, {1, 2}, {2, 1}, {2, 1}, {2, 1}, {2, 2}, {1, 1}, {2, 2}, {2, 2}};
-const Nibbles code_jvc_tv_CHANNEL_DOWN[] PROGMEM = {{0, 1}, {1, 2}, {2, 1}, {2, 1}, {2, 2}, {2, 2}, {1, 1}, {2, 2}, {2, 2}};
-
-const BurstPair dict_rca_tv[] PROGMEM = {{1152, 217}, {29, 55}, {63, 458}, {232, 1}, {29, 111}};
-const Nibbles code_rca_tv_POWER_ON[]     PROGMEM = {{0, 4}, {4, 4}, {4, 1}, {1, 4}, {4, 4}, {1, 4}, {1, 1}, {1, 1}, {1, 4}, {4, 1}, {1, 1}, {4, 1}, {4, 2}, {3, 0}};
-const Nibbles code_rca_tv_POWER_OFF[]    PROGMEM = {{0, 4}, {4, 4}, {4, 1}, {1, 4}, {4, 4}, {1, 4}, {4, 1}, {1, 1}, {1, 4}, {4, 1}, {1, 1}, {4, 1}, {1, 2}, {3, 0}};
-const Nibbles code_rca_tv_MUTE[]         PROGMEM = {{0, 4}, {4, 4}, {4, 1}, {1, 4}, {4, 4}, {4, 4}, {4, 1}, {1, 1}, {1, 4}, {4, 1}, {1, 1}, {1, 1}, {1, 2}, {3, 0}};
-const Nibbles code_rca_tv_VOLUME_UP[]    PROGMEM = {{0, 4}, {4, 4}, {4, 1}, {1, 4}, {1, 4}, {4, 4}, {4, 1}, {1, 1}, {1, 4}, {4, 1}, {4, 1}, {1, 1}, {1, 2}, {3, 0}};
-const Nibbles code_rca_tv_VOLUME_DOWN[]  PROGMEM = {{0, 4}, {4, 4}, {4, 1}, {1, 4}, {1, 4}, {4, 4}, {1, 1}, {1, 1}, {1, 4}, {4, 1}, {4, 1}, {1, 1}, {4, 2}, {3, 0}};
-const Nibbles code_rca_tv_CHANNEL_UP[]   PROGMEM = {{0, 4}, {4, 4}, {4, 1}, {1, 4}, {1, 4}, {4, 1}, {4, 1}, {1, 1}, {1, 4}, {4, 1}, {4, 1}, {1, 4}, {1, 2}, {3, 0}};
-const Nibbles code_rca_tv_CHANNEL_DOWN[] PROGMEM = {{0, 4}, {4, 4}, {4, 1}, {1, 4}, {1, 4}, {4, 1}, {1, 1}, {1, 1}, {1, 4}, {4, 1}, {4, 1}, {1, 4}, {4, 2}, {3, 0}};
+constexpr BurstPair dict_samsung_tv[] PROGMEM = {{21, 22}, {21, 65}, {172, 171}};
+constexpr uint8_t code_samsung_tv_POWER_ON[]     PROGMEM = {0x07, 0x07, 0x99, 0x66};
+constexpr uint8_t code_samsung_tv_POWER_OFF[]    PROGMEM = {0x07, 0x07, 0x98, 0x67};
+constexpr uint8_t code_samsung_tv_MUTE[]         PROGMEM = {0x07, 0x07, 0x0F, 0xF0};
+constexpr uint8_t code_samsung_tv_VOLUME_UP[]    PROGMEM = {0x07, 0x07, 0x07, 0xF8};
+constexpr uint8_t code_samsung_tv_VOLUME_DOWN[]  PROGMEM = {0x07, 0x07, 0x0B, 0xF4};
+constexpr uint8_t code_samsung_tv_CHANNEL_UP[]   PROGMEM = {0x07, 0x07, 0x12, 0xED};
+constexpr uint8_t code_samsung_tv_CHANNEL_DOWN[] PROGMEM = {0x07, 0x07, 0x10, 0xEF};
+
+constexpr BurstPair dict_lge_tv[] PROGMEM = {{22, 21}, {22, 63}, {343, 171}};
+constexpr uint8_t code_lge_tv_POWER_ON[]     PROGMEM = {0x04, 0xFB, 0xC4, 0x3B};
+constexpr uint8_t code_lge_tv_POWER_OFF[]    PROGMEM = {0x04, 0xFB, 0xC5, 0x3A};
+constexpr uint8_t code_lge_tv_MUTE[]         PROGMEM = {0x04, 0xFB, 0x09, 0xF6};
+constexpr uint8_t code_lge_tv_VOLUME_UP[]    PROGMEM = {0x04, 0xFB, 0x02, 0xFD};
+constexpr uint8_t code_lge_tv_VOLUME_DOWN[]  PROGMEM = {0x04, 0xFB, 0x03, 0xFC};
+constexpr uint8_t code_lge_tv_CHANNEL_UP[]   PROGMEM = {0x04, 0xFB, 0x00, 0xFF};
+constexpr uint8_t code_lge_tv_CHANNEL_DOWN[] PROGMEM = {0x04, 0xFB, 0x01, 0xFE};
+
+constexpr BurstPair dict_sony_tv[] PROGMEM = {{24, 24}, {48, 24}, {96, 24}};
+constexpr uint8_t code_sony_tv_POWER_ON[]     PROGMEM = {0xAE, 0x00};
+constexpr uint8_t code_sony_tv_POWER_OFF[]    PROGMEM = {0xAF, 0x00};
+constexpr uint8_t code_sony_tv_MUTE[]         PROGMEM = {0x94, 0x00};
+constexpr uint8_t code_sony_tv_VOLUME_UP[]    PROGMEM = {0x92, 0x00};
+constexpr uint8_t code_sony_tv_VOLUME_DOWN[]  PROGMEM = {0x93, 0x00};
+constexpr uint8_t code_sony_tv_CHANNEL_UP[]   PROGMEM = {0x90, 0x00};
+constexpr uint8_t code_sony_tv_CHANNEL_DOWN[] PROGMEM = {0x91, 0x00};
+
+constexpr BurstPair dict_panasonic_tv[] PROGMEM = {{16, 16}, {16, 48}, {128, 64}};
+constexpr uint8_t code_panasonic_tv_POWER_ON[]     PROGMEM = {0x02, 0x20, 0x80, 0x00, 0x3E, 0xBE};
+constexpr uint8_t code_panasonic_tv_POWER_OFF[]    PROGMEM = {0x02, 0x20, 0x80, 0x00, 0x3F, 0xBF};
+constexpr uint8_t code_panasonic_tv_MUTE[]         PROGMEM = {0x02, 0x20, 0x80, 0x00, 0x32, 0xB2};
+constexpr uint8_t code_panasonic_tv_VOLUME_UP[]    PROGMEM = {0x02, 0x20, 0x80, 0x00, 0x20, 0xA0};
+constexpr uint8_t code_panasonic_tv_VOLUME_DOWN[]  PROGMEM = {0x02, 0x20, 0x80, 0x00, 0x21, 0xA1};
+constexpr uint8_t code_panasonic_tv_CHANNEL_UP[]   PROGMEM = {0x02, 0x20, 0x80, 0x00, 0x34, 0xB4};
+constexpr uint8_t code_panasonic_tv_CHANNEL_DOWN[] PROGMEM = {0x02, 0x20, 0x80, 0x00, 0x35, 0xB5};
+
+constexpr BurstPair dict_sharp_tv[] PROGMEM = {{10, 29}, {10, 72}};
+constexpr uint8_t code_sharp_tv_POWER_ON[]     PROGMEM = {0x51, 0x29};
+constexpr uint8_t code_sharp_tv_POWER_OFF[]    PROGMEM = {0x71, 0x29};
+constexpr uint8_t code_sharp_tv_MUTE[]         PROGMEM = {0xE1, 0x22};
+constexpr uint8_t code_sharp_tv_VOLUME_UP[]    PROGMEM = {0x81, 0x22};
+constexpr uint8_t code_sharp_tv_VOLUME_DOWN[]  PROGMEM = {0xA1, 0x22};
+constexpr uint8_t code_sharp_tv_CHANNEL_UP[]   PROGMEM = {0x21, 0x22};
+constexpr uint8_t code_sharp_tv_CHANNEL_DOWN[] PROGMEM = {0x41, 0x22};
+
+constexpr BurstPair dict_philips_tv[] PROGMEM = {{32, 32}};
+constexpr uint8_t code_philips_tv_POWER_ON[]     PROGMEM = {0x03, 0x3F};
+constexpr uint8_t code_philips_tv_POWER_OFF[]    PROGMEM = {0x03, 0x2F};
+constexpr uint8_t code_philips_tv_MUTE[]         PROGMEM = {0x03, 0x2C};
+constexpr uint8_t code_philips_tv_VOLUME_UP[]    PROGMEM = {0x03, 0x02};
+constexpr uint8_t code_philips_tv_VOLUME_DOWN[]  PROGMEM = {0x03, 0x22};
+constexpr uint8_t code_philips_tv_CHANNEL_UP[]   PROGMEM = {0x03, 0x01};
+constexpr uint8_t code_philips_tv_CHANNEL_DOWN[] PROGMEM = {0x03, 0x21};
+
+constexpr BurstPair dict_vizio_tv[] PROGMEM = {{21, 22}, {21, 65}, {343, 172}};
+constexpr uint8_t code_vizio_tv_POWER_ON[]     PROGMEM = {0x04, 0xFB, 0x2A, 0xD5};
+constexpr uint8_t code_vizio_tv_POWER_OFF[]    PROGMEM = {0x04, 0xFB, 0x25, 0xDA};
+constexpr uint8_t code_vizio_tv_MUTE_ON[]      PROGMEM = {0x04, 0xFB, 0x20, 0xDF};
+constexpr uint8_t code_vizio_tv_MUTE_OFF[]     PROGMEM = {0x04, 0xFB, 0x21, 0xDE};
+constexpr uint8_t code_vizio_tv_VOLUME_UP[]    PROGMEM = {0x04, 0xFB, 0x02, 0xFD};
+constexpr uint8_t code_vizio_tv_VOLUME_DOWN[]  PROGMEM = {0x04, 0xFB, 0x03, 0xFC};
+constexpr uint8_t code_vizio_tv_CHANNEL_UP[]   PROGMEM = {0x04, 0xFB, 0x00, 0xFF};
+constexpr uint8_t code_vizio_tv_CHANNEL_DOWN[] PROGMEM = {0x04, 0xFB, 0x01, 0xFE};
+
+constexpr BurstPair dict_pioneer_tv[] PROGMEM = {{22, 22}, {22, 67}, {360, 180}};
+constexpr uint8_t code_pioneer_tv_POWER_ON[]     PROGMEM = {0xAA, 0x55, 0x1C, 0xE3};
+constexpr uint8_t code_pioneer_tv_POWER_OFF[]    PROGMEM = {0xAA, 0x55, 0x1B, 0xE4};
+constexpr uint8_t code_pioneer_tv_MUTE[]         PROGMEM = {0xAA, 0x55, 0x49, 0xB6};
+constexpr uint8_t code_pioneer_tv_VOLUME_UP[]    PROGMEM = {0xAA, 0x55, 0x0A, 0xF5};
+constexpr uint8_t code_pioneer_tv_VOLUME_DOWN[]  PROGMEM = {0xAA, 0x55, 0x0B, 0xF4};
+constexpr uint8_t code_pioneer_tv_CHANNEL_UP[]   PROGMEM = {0xAA, 0x55, 0x10, 0xEF};
+constexpr uint8_t code_pioneer_tv_CHANNEL_DOWN[] PROGMEM = {0xAA, 0x55, 0x11, 0xEE};
+
+constexpr BurstPair dict_mitsubishi_tv[] PROGMEM = {{10, 29}, {10, 68}};
+constexpr uint8_t code_mitsubishi_tv_POWER_ON[]     PROGMEM = {0x47, 0x42};
+constexpr uint8_t code_mitsubishi_tv_POWER_OFF[]    PROGMEM = {0x47, 0x4A};
+constexpr uint8_t code_mitsubishi_tv_MUTE[]         PROGMEM = {0x47, 0x32};
+constexpr uint8_t code_mitsubishi_tv_VOLUME_UP[]    PROGMEM = {0x47, 0x22};
+constexpr uint8_t code_mitsubishi_tv_VOLUME_DOWN[]  PROGMEM = {0x47, 0x2A};
+constexpr uint8_t code_mitsubishi_tv_CHANNEL_UP[]   PROGMEM = {0x47, 0x0A};
+constexpr uint8_t code_mitsubishi_tv_CHANNEL_DOWN[] PROGMEM = {0x47, 0x12};
+
+constexpr BurstPair dict_fujitsu_tv[] PROGMEM = {{15, 15}, {15, 46}, {122, 61}};
+constexpr uint8_t code_fujitsu_tv_POWER_ON[]     PROGMEM = {0x14, 0x63, 0x00, 0x84, 0x8A, 0x01};
+constexpr uint8_t code_fujitsu_tv_POWER_OFF[]    PROGMEM = {0x14, 0x63, 0x00, 0x84, 0x8A, 0x02};
+constexpr uint8_t code_fujitsu_tv_MUTE[]         PROGMEM = {0x14, 0x63, 0x00, 0x84, 0x8C, 0x12};
+constexpr uint8_t code_fujitsu_tv_VOLUME_UP[]    PROGMEM = {0x14, 0x63, 0x00, 0x84, 0x8C, 0x10};
+constexpr uint8_t code_fujitsu_tv_VOLUME_DOWN[]  PROGMEM = {0x14, 0x63, 0x00, 0x84, 0x8C, 0x11};
+constexpr uint8_t code_fujitsu_tv_CHANNEL_UP[]   PROGMEM = {0x14, 0x63, 0x00, 0x84, 0x8D, 0x0B};
+constexpr uint8_t code_fujitsu_tv_CHANNEL_DOWN[] PROGMEM = {0x14, 0x63, 0x00, 0x84, 0x8D, 0x0C};
+
+constexpr uint8_t code_toshiba_tv_POWER_ON[]     PROGMEM = {0x40, 0x00, 0x7F, 0x80};
+constexpr uint8_t code_toshiba_tv_POWER_OFF[]    PROGMEM = {0x40, 0x00, 0x7E, 0x81};
+constexpr uint8_t code_toshiba_tv_MUTE[]         PROGMEM = {0x40, 0x00, 0x10, 0xEF};
+constexpr uint8_t code_toshiba_tv_VOLUME_UP[]    PROGMEM = {0x40, 0x00, 0x1A, 0xE5};
+constexpr uint8_t code_toshiba_tv_VOLUME_DOWN[]  PROGMEM = {0x40, 0x00, 0x1E, 0xE1};
+constexpr uint8_t code_toshiba_tv_CHANNEL_UP[]   PROGMEM = {0x40, 0x00, 0x1B, 0xE4};
+constexpr uint8_t code_toshiba_tv_CHANNEL_DOWN[] PROGMEM = {0x40, 0x00, 0x1F, 0xE0};
+
+constexpr uint8_t code_sanyo_tv_POWER_ON[]     PROGMEM = {0x38, 0xC7, 0x12, 0xED};
+constexpr uint8_t code_sanyo_tv_POWER_OFF[]    PROGMEM = {0x38, 0xC7, 0x76, 0x89};
+constexpr uint8_t code_sanyo_tv_MUTE[]         PROGMEM = {0x38, 0xC7, 0x18, 0xE7};
+constexpr uint8_t code_sanyo_tv_VOLUME_UP[]    PROGMEM = {0x38, 0xC7, 0x0E, 0xF1};
+constexpr uint8_t code_sanyo_tv_VOLUME_DOWN[]  PROGMEM = {0x38, 0xC7, 0x0F, 0xF0};
+constexpr uint8_t code_sanyo_tv_CHANNEL_UP[]   PROGMEM = {0x38, 0xC7, 0x0A, 0xF5};
+constexpr uint8_t code_sanyo_tv_CHANNEL_DOWN[] PROGMEM = {0x38, 0xC7, 0x0B, 0xF4};
+
+constexpr BurstPair dict_jvc_tv[] PROGMEM = {{20, 20}, {20, 60}, {321, 160}};
+constexpr uint8_t code_jvc_tv_POWER_ON[]     PROGMEM = {0x53, 0x1D};
+constexpr uint8_t code_jvc_tv_POWER_OFF[]    PROGMEM = {0x53, 0x1A};
+constexpr uint8_t code_jvc_tv_MUTE[]         PROGMEM = {0x53, 0x1C};
+constexpr uint8_t code_jvc_tv_VOLUME_UP[]    PROGMEM = {0x53, 0x1E};
+constexpr uint8_t code_jvc_tv_VOLUME_DOWN[]  PROGMEM = {0x53, 0x1F};
+constexpr uint8_t code_jvc_tv_CHANNEL_UP[]   PROGMEM = {0x53, 0x19};
+constexpr uint8_t code_jvc_tv_CHANNEL_DOWN[] PROGMEM = {0x53, 0x18};
+
+constexpr BurstPair dict_rca_tv[] PROGMEM = {{1152, 217}, {29, 111}, {29, 55}, {63, 458}, {232, 1}};
+constexpr uint8_t code_rca_tv_POWER_ON[]     PROGMEM = {0x48, 0x12, 0x29, 0x89, 0x22, 0x49, 0x4A, 0x24, 0x45, 0x19, 0x01};
+constexpr uint8_t code_rca_tv_POWER_OFF[]    PROGMEM = {0x48, 0x12, 0x29, 0x89, 0x12, 0x49, 0x4A, 0x24, 0x45, 0x1A, 0x01};
+constexpr uint8_t code_rca_tv_MUTE[]         PROGMEM = {0x48, 0x12, 0x29, 0x49, 0x12, 0x49, 0x4A, 0x24, 0x49, 0x1A, 0x01};
+constexpr uint8_t code_rca_tv_VOLUME_UP[]    PROGMEM = {0x48, 0x12, 0x29, 0x4A, 0x12, 0x49, 0x4A, 0x14, 0x49, 0x1A, 0x01};
+constexpr uint8_t code_rca_tv_VOLUME_DOWN[]  PROGMEM = {0x48, 0x12, 0x29, 0x4A, 0x22, 0x49, 0x4A, 0x14, 0x49, 0x19, 0x01};
+constexpr uint8_t code_rca_tv_CHANNEL_UP[]   PROGMEM = {0x48, 0x12, 0x29, 0x4A, 0x14, 0x49, 0x4A, 0x14, 0x29, 0x1A, 0x01};
+constexpr uint8_t code_rca_tv_CHANNEL_DOWN[] PROGMEM = {0x48, 0x12, 0x29, 0x4A, 0x24, 0x49, 0x4A, 0x14, 0x29, 0x19, 0x01};
 
 //projectors
 
-const BurstPair dict_sharp_projector[] PROGMEM = {{10, 70}, {10, 30}, {10, 1657}};
-const Nibbles code_sharp_projector_POWER_STANDBY[] PROGMEM = {{0, 1}, {0, 0}, {1, 0}, {0, 1}, {0, 1}, {1, 1}, {0, 0}, {1, 2}, {0, 1}, {0, 0}, {1, 1}, {1, 0}, {1, 0}, {0, 0}, {1, 1}, {0, 1}};
-const Nibbles code_sharp_projector_POWER_ON[] PROGMEM = {{0, 1}, {0, 0}, {1, 1}, {0, 0}, {1, 0}, {1, 0}, {1, 0}, {1, 2}, {0, 1}, {0, 0}, {1, 0}, {1, 1}, {0, 1}, {0, 1}, {0, 1}, {0, 1}};
-const Nibbles code_sharp_projector_VOLUME_UP[] PROGMEM = {{0, 1}, {0, 0}, {1, 1}, {1, 0}, {1, 0}, {1, 1}, {1, 0}, {1, 2}, {0, 1}, {0, 0}, {1, 0}, {0, 1}, {0, 1}, {0, 0}, {0, 1}, {0, 1}};
-const Nibbles code_sharp_projector_VOLUME_DOWN[] PROGMEM = {{0, 1}, {0, 0}, {1, 0}, {1, 0}, {1, 0}, {1, 1}, {1, 0}, {1, 2}, {0, 1}, {0, 0}, {1, 1}, {0, 1}, {0, 1}, {0, 0}, {0, 1}, {0, 1}};
+constexpr BurstPair dict_sharp_projector[] PROGMEM = {{10, 30}, {10, 70}, {10, 1657}};
+constexpr uint8_t code_sharp_projector_POWER_ON[]      PROGMEM = {0xCD, 0xAA, 0x96, 0x2A};
+constexpr uint8_t code_sharp_projector_POWER_STANDBY[] PROGMEM = {0x6D, 0xB1, 0x46, 0x27};
+constexpr uint8_t code_sharp_projector_VOLUME_UP[]     PROGMEM = {0x8D, 0xA2, 0xB6, 0x2E};
+constexpr uint8_t code_sharp_projector_VOLUME_DOWN[]   PROGMEM = {0xAD, 0xA2, 0xA6, 0x2E};
 
-const BurstPair dict_sharp2_projector[] PROGMEM = {{10, 70}, {10, 30}, {10, 1632}, {10, 1636}, {10, 1716}, {10, 1676}};
-const Nibbles code_sharp2_projector_POWER_ON[] PROGMEM = {{0, 1}, {0, 0}, {1, 1}, {0, 0}, {1, 0}, {1, 0}, {1, 0}, {1, 2}, {0, 1}, {0, 0}, {1, 0}, {1, 1}, {0, 1}, {0, 1}, {0, 1}, {0, 2}, {0, 1}, {0, 0}, {1, 1}, {0, 0}, {1, 0}, {1, 0}, {1, 0}, {1, 2}, {0, 1}, {0, 0}, {1, 0}, {1, 1}, {0, 1}, {0, 1}, {0, 1}, {0, 2}, {0, 1}, {0, 0}, {1, 1}, {0, 0}, {1, 0}, {1, 0}, {1, 0}, {1, 1}};
-const Nibbles code_sharp2_projector_POWER_OFF[] PROGMEM = {{0, 1}, {0, 0}, {1, 1}, {0, 0}, {1, 0}, {1, 1}, {0, 0}, {1, 3}, {0, 1}, {0, 0}, {1, 0}, {1, 1}, {0, 1}, {0, 0}, {1, 1}, {0, 3}, {0, 1}, {0, 0}, {1, 1}, {0, 0}, {1, 0}, {1, 1}, {0, 0}, {1, 3}, {0, 1}, {0, 0}, {1, 0}, {1, 1}, {0, 1}, {0, 0}, {1, 1}, {0, 3}, {0, 1}, {0, 0}, {1, 1}, {0, 0}, {1, 0}, {1, 1}, {0, 0}, {1, 1}};
-const Nibbles code_sharp2_projector_VOLUME_UP[] PROGMEM = {{0, 1}, {0, 0}, {1, 1}, {1, 0}, {1, 0}, {1, 1}, {1, 0}, {1, 4}, {0, 1}, {0, 0}, {1, 0}, {0, 1}, {0, 1}, {0, 0}, {0, 1}, {0, 4}, {0, 1}, {0, 0}, {1, 1}, {1, 0}, {1, 0}, {1, 1}, {1, 0}, {1, 4}, {0, 1}, {0, 0}, {1, 0}, {0, 1}, {0, 1}, {0, 0}, {0, 1}, {0, 4}, {0, 1}, {0, 0}, {1, 1}, {1, 0}, {1, 0}, {1, 1}, {1, 0}, {1, 4}, {0, 1}, {0, 0}, {1, 0}, {0, 1}, {0, 1}, {0, 0}, {0, 1}, {0, 4}, {0, 1}, {0, 0}, {1, 1}, {1, 0}, {1, 0}, {1, 1}, {1, 0}, {1, 4}, {0, 1}, {0, 0}, {1, 0}, {0, 1}, {0, 1}, {0, 0}, {0, 1}, {0, 1}};
-const Nibbles code_sharp2_projector_VOLUME_DOWN[] PROGMEM = {{0, 1}, {0, 0}, {1, 0}, {1, 0}, {1, 0}, {1, 1}, {1, 0}, {1, 5}, {0, 1}, {0, 0}, {1, 1}, {0, 1}, {0, 1}, {0, 0}, {0, 1}, {0, 5}, {0, 1}, {0, 0}, {1, 0}, {1, 0}, {1, 0}, {1, 1}, {1, 0}, {1, 5}, {0, 1}, {0, 0}, {1, 1}, {0, 1}, {0, 1}, {0, 0}, {0, 1}, {0, 5}, {0, 1}, {0, 0}, {1, 0}, {1, 0}, {1, 0}, {1, 1}, {1, 0}, {1, 5}, {0, 1}, {0, 0}, {1, 1}, {0, 1}, {0, 1}, {0, 0}, {0, 1}, {0, 5}, {0, 1}, {0, 0}, {1, 0}, {1, 0}, {1, 0}, {1, 1}, {1, 0}, {1, 5}, {0, 1}, {0, 0}, {1, 1}, {0, 1}, {0, 1}, {0, 0}, {0, 1}, {0, 1}};
+constexpr BurstPair dict_sharp2_projector[] PROGMEM = {{10, 70}, {10, 30}, {10, 1654}, {10, 1716}};
+constexpr uint8_t code_sharp2_projector_POWER_ON[]    PROGMEM = {0x02, 0x20, 0x02, 0x10, 0x01, 0x04, 0x05, 0x11, 0x91, 0x04, 0x51, 0x44, 0x84, 0x04, 0x05, 0x11, 0x51};
+constexpr uint8_t code_sharp2_projector_POWER_OFF[]   PROGMEM = {0x02, 0x20, 0x02, 0x10, 0x01, 0x04, 0x05, 0x51, 0x90, 0x04, 0x51, 0x04, 0x85, 0x04, 0x05, 0x51, 0x50};
+constexpr uint8_t code_sharp2_projector_VOLUME_UP[]   PROGMEM = {0x01, 0x20, 0x84, 0x04, 0x15, 0x51, 0xD1, 0x04, 0x41, 0x04, 0xC4, 0x01};
+constexpr uint8_t code_sharp2_projector_VOLUME_DOWN[] PROGMEM = {0x01, 0x20, 0x84, 0x04, 0x11, 0x51, 0x91, 0x04, 0x45, 0x04, 0x84, 0x01};
 
 
 
@@ -223,165 +339,186 @@ const Nibbles code_sharp2_projector_VOLUME_DOWN[] PROGMEM = {{0, 1}, {0, 0}, {1,
 
 //POWER ON==================================================
 const IRCode POWER_ON[] PROGMEM = {
-  {dict_samsung_tv, code_samsung_tv_POWER_ON, 34, 13},
-  {dict_lge_tv, code_lge_tv_POWER_ON, 34, 13},
-  {dict_sony_tv, code_sony_tv_POWER_ON, 13, 12},
-  {dict_panasonic_tv, code_panasonic_tv_POWER_ON, 50, 14},
-  {dict_sharp_tv, code_sharp_tv_POWER_ON, 16, 13},
-  {dict_philips_tv, code_philips_tv_POWER_ON, 13, 14},
-  {dict_vizio_tv, code_vizio_tv_POWER_ON, 34, 13},
-  {dict_pioneer_tv, code_pioneer_tv_POWER_ON, 34, 13},
-  {dict_mitsubishi_tv, code_mitsubishi_tv_POWER_ON, 17, 15},
-  {dict_fujitsu_tv, code_fujitsu_tv_POWER_ON, 50, 13},
-  {dict_toshiba_tv, code_toshiba_tv_POWER_ON, 34, 13},
-  {dict_sanyo_tv, code_sanyo_tv_POWER_ON, 34, 13},
-  {dict_jvc_tv, code_jvc_tv_POWER_ON, 18, 13},
-  {dict_rca_tv, code_rca_tv_POWER_ON, 27, 9}
+  IR_CODE(dict_samsung_tv, code_samsung_tv_POWER_ON, 417, 34, PROTOCOL_NEC),
+  IR_CODE(dict_lge_tv, code_lge_tv_POWER_ON, 417, 34, PROTOCOL_NEC),
+  IR_CODE(dict_sony_tv, code_sony_tv_POWER_ON, 382, 13, PROTOCOL_SIRC),
+  IR_CODE(dict_panasonic_tv, code_panasonic_tv_POWER_ON, 448, 50, PROTOCOL_KASEIKYO),
+  IR_CODE(dict_sharp_tv, code_sharp_tv_POWER_ON, 417, 16, PROTOCOL_SHARP),
+  IR_CODE(dict_philips_tv, code_philips_tv_POWER_ON, 448, 13, PROTOCOL_RC5),
+  IR_CODE(dict_vizio_tv, code_vizio_tv_POWER_ON, 417, 34, PROTOCOL_NEC),
+  IR_CODE(dict_pioneer_tv, code_pioneer_tv_POWER_ON, 417, 34, PROTOCOL_NEC),
+  IR_CODE(dict_mitsubishi_tv, code_mitsubishi_tv_POWER_ON, 479, 17, PROTOCOL_MITSUBISHI),
+  IR_CODE(dict_fujitsu_tv, code_fujitsu_tv_POWER_ON, 417, 50, PROTOCOL_KASEIKYO),
+  IR_CODE(dict_vizio_tv, code_toshiba_tv_POWER_ON, 417, 34, PROTOCOL_NEC),
+  IR_CODE(dict_vizio_tv, code_sanyo_tv_POWER_ON, 417, 34, PROTOCOL_NEC),
+  IR_CODE(dict_jvc_tv, code_jvc_tv_POWER_ON, 417, 18, PROTOCOL_JVC),
+  IR_CODE(dict_rca_tv, code_rca_tv_POWER_ON, 289, 27, FORMAT_BITS_3)
 };
-const uint8_t POWER_ON_TOTAL = NUM_ELEM(POWER_ON);
+static_assert(NUM_ELEM(POWER_ON) == POWER_ON_TOTAL, "POWER_ON_TOTAL is out of date");
 
 //POWER OFF=================================================
 const IRCode POWER_OFF[] PROGMEM = {
-  {dict_samsung_tv, code_samsung_tv_POWER_OFF, 34, 13},
-  {dict_lge_tv, code_lge_tv_POWER_OFF, 34, 13},
-  {dict_sony_tv, code_sony_tv_POWER_OFF, 13, 12},
-  {dict_panasonic_tv, code_panasonic_tv_POWER_OFF, 50, 14},
-  {dict_sharp_tv, code_sharp_tv_POWER_OFF, 16, 13},
-  {dict_philips_tv, code_philips_tv_POWER_OFF, 12, 14},
-  {dict_vizio_tv, code_vizio_tv_POWER_OFF, 34, 13},
-  {dict_pioneer_tv, code_pioneer_tv_POWER_OFF, 34, 13},
-  {dict_mitsubishi_tv, code_mitsubishi_tv_POWER_OFF, 17, 15},
-  {dict_fujitsu_tv, code_fujitsu_tv_POWER_OFF, 50, 13},
-  {dict_toshiba_tv, code_toshiba_tv_POWER_OFF, 34, 13},
-  {dict_sanyo_tv, code_sanyo_tv_POWER_OFF, 34, 13},
-  {dict_jvc_tv, code_jvc_tv_POWER_OFF, 18, 13},
-  {dict_rca_tv, code_rca_tv_POWER_OFF, 27, 9}
+  IR_CODE(dict_samsung_tv, code_samsung_tv_POWER_OFF, 417, 34, PROTOCOL_NEC),
+  IR_CODE(dict_lge_tv, code_lge_tv_POWER_OFF, 417, 34, PROTOCOL_NEC),
+  IR_CODE(dict_sony_tv, code_sony_tv_POWER_OFF, 382, 13, PROTOCOL_SIRC),
+  IR_CODE(dict_panasonic_tv, code_panasonic_tv_POWER_OFF, 448, 50, PROTOCOL_KASEIKYO),
+  IR_CODE(dict_sharp_tv, code_sharp_tv_POWER_OFF, 417, 16, PROTOCOL_SHARP),
+  IR_CODE(dict_philips_tv, code_philips_tv_POWER_OFF, 448, 12, PROTOCOL_RC5),
+  IR_CODE(dict_vizio_tv, code_vizio_tv_POWER_OFF, 417, 34, PROTOCOL_NEC),
+  IR_CODE(dict_pioneer_tv, code_pioneer_tv_POWER_OFF, 417, 34, PROTOCOL_NEC),
+  IR_CODE(dict_mitsubishi_tv, code_mitsubishi_tv_POWER_OFF, 479, 17, PROTOCOL_MITSUBISHI),
+  IR_CODE(dict_fujitsu_tv, code_fujitsu_tv_POWER_OFF, 417, 50, PROTOCOL_KASEIKYO),
+  IR_CODE(dict_vizio_tv, code_toshiba_tv_POWER_OFF, 417, 34, PROTOCOL_NEC),
+  IR_CODE(dict_vizio_tv, code_sanyo_tv_POWER_OFF, 417, 34, PROTOCOL_NEC),
+  IR_CODE(dict_jvc_tv, code_jvc_tv_POWER_OFF, 417, 18, PROTOCOL_JVC),
+  IR_CODE(dict_rca_tv, code_rca_tv_POWER_OFF, 289, 27, FORMAT_BITS_3)
 };
-const uint8_t POWER_OFF_TOTAL = NUM_ELEM(POWER_OFF);
+static_assert(NUM_ELEM(POWER_OFF) == POWER_OFF_TOTAL, "POWER_OFF_TOTAL is out of date");
 
 //MUTE======================================================
 const IRCode MUTE[] PROGMEM = {
-  {dict_samsung_tv, code_samsung_tv_MUTE, 34, 13},
-  {dict_lge_tv, code_lge_tv_MUTE, 34, 13},
-  {dict_sony_tv, code_sony_tv_MUTE, 13, 12},
-  {dict_panasonic_tv, code_panasonic_tv_MUTE, 50, 14},
-  {dict_sharp_tv, code_sharp_tv_MUTE, 16, 13},
-  {dict_philips_tv, code_philips_tv_MUTE, 12, 14},
-  //{dict_vizio_tv, code_vizio_tv_MUTE, 34, 13},
-  {dict_pioneer_tv, code_pioneer_tv_MUTE, 34, 13},
-  {dict_mitsubishi_tv, code_mitsubishi_tv_MUTE, 17, 15},
-  {dict_fujitsu_tv, code_fujitsu_tv_MUTE, 50, 13},
-  {dict_toshiba_tv, code_toshiba_tv_MUTE, 34, 13},
-  {dict_sanyo_tv, code_sanyo_tv_MUTE, 34, 13},
-  {dict_jvc_tv, code_jvc_tv_MUTE, 18, 13},
-  {dict_rca_tv, code_rca_tv_MUTE, 27, 9}
+  IR_CODE(dict_samsung_tv, code_samsung_tv_MUTE, 417, 34, PROTOCOL_NEC),
+  IR_CODE(dict_lge_tv, code_lge_tv_MUTE, 417, 34, PROTOCOL_NEC),
+  IR_CODE(dict_sony_tv, code_sony_tv_MUTE, 382, 13, PROTOCOL_SIRC),
+  IR_CODE(dict_panasonic_tv, code_panasonic_tv_MUTE, 448, 50, PROTOCOL_KASEIKYO),
+  IR_CODE(dict_sharp_tv, code_sharp_tv_MUTE, 417, 16, PROTOCOL_SHARP),
+  IR_CODE(dict_philips_tv, code_philips_tv_MUTE, 448, 12, PROTOCOL_RC5),
+  IR_CODE(dict_pioneer_tv, code_pioneer_tv_MUTE, 417, 34, PROTOCOL_NEC),
+  IR_CODE(dict_mitsubishi_tv, code_mitsubishi_tv_MUTE, 479, 17, PROTOCOL_MITSUBISHI),
+  IR_CODE(dict_fujitsu_tv, code_fujitsu_tv_MUTE, 417, 50, PROTOCOL_KASEIKYO),
+  IR_CODE(dict_vizio_tv, code_toshiba_tv_MUTE, 417, 34, PROTOCOL_NEC),
+  IR_CODE(dict_vizio_tv, code_sanyo_tv_MUTE, 417, 34, PROTOCOL_NEC),
+  IR_CODE(dict_jvc_tv, code_jvc_tv_MUTE, 417, 18, PROTOCOL_JVC),
+  IR_CODE(dict_rca_tv, code_rca_tv_MUTE, 289, 27, FORMAT_BITS_3)
 };
-const uint8_t MUTE_TOTAL = NUM_ELEM(MUTE);
+static_assert(NUM_ELEM(MUTE) == MUTE_TOTAL, "MUTE_TOTAL is out of date");
 
 //VOLUME UP=================================================
 const IRCode VOLUME_UP[] PROGMEM = {
-  {dict_samsung_tv, code_samsung_tv_VOLUME_UP, 34, 13},
-  {dict_lge_tv, code_lge_tv_VOLUME_UP, 34, 13},
-  {dict_sony_tv, code_sony_tv_VOLUME_UP, 13, 12},
-  {dict_panasonic_tv, code_panasonic_tv_VOLUME_UP, 50, 14},
-  {dict_sharp_tv, code_sharp_tv_VOLUME_UP, 16, 13},
-  {dict_philips_tv, code_philips_tv_VOLUME_UP, 12, 14},
-  {dict_vizio_tv, code_vizio_tv_VOLUME_UP, 34, 13},
-  {dict_pioneer_tv, code_pioneer_tv_VOLUME_UP, 34, 13},
-  {dict_mitsubishi_tv, code_mitsubishi_tv_VOLUME_UP, 17, 15},
-  {dict_fujitsu_tv, code_fujitsu_tv_VOLUME_UP, 50, 13},
-  {dict_toshiba_tv, code_toshiba_tv_VOLUME_UP, 34, 13},
-  {dict_sanyo_tv, code_sanyo_tv_VOLUME_UP, 34, 13},
-  {dict_jvc_tv, code_jvc_tv_VOLUME_UP, 18, 13},
-  {dict_rca_tv, code_rca_tv_VOLUME_UP, 27, 9}
+  IR_CODE(dict_samsung_tv, code_samsung_tv_VOLUME_UP, 417, 34, PROTOCOL_NEC),
+  IR_CODE(dict_lge_tv, code_lge_tv_VOLUME_UP, 417, 34, PROTOCOL_NEC),
+  IR_CODE(dict_sony_tv, code_sony_tv_VOLUME_UP, 382, 13, PROTOCOL_SIRC),
+  IR_CODE(dict_panasonic_tv, code_panasonic_tv_VOLUME_UP, 448, 50, PROTOCOL_KASEIKYO),
+  IR_CODE(dict_sharp_tv, code_sharp_tv_VOLUME_UP, 417, 16, PROTOCOL_SHARP),
+  IR_CODE(dict_philips_tv, code_philips_tv_VOLUME_UP, 448, 12, PROTOCOL_RC5),
+  IR_CODE(dict_vizio_tv, code_vizio_tv_VOLUME_UP, 417, 34, PROTOCOL_NEC),
+  IR_CODE(dict_pioneer_tv, code_pioneer_tv_VOLUME_UP, 417, 34, PROTOCOL_NEC),
+  IR_CODE(dict_mitsubishi_tv, code_mitsubishi_tv_VOLUME_UP, 479, 17, PROTOCOL_MITSUBISHI),
+  IR_CODE(dict_fujitsu_tv, code_fujitsu_tv_VOLUME_UP, 417, 50, PROTOCOL_KASEIKYO),
+  IR_CODE(dict_vizio_tv, code_toshiba_tv_VOLUME_UP, 417, 34, PROTOCOL_NEC),
+  IR_CODE(dict_vizio_tv, code_sanyo_tv_VOLUME_UP, 417, 34, PROTOCOL_NEC),
+  IR_CODE(dict_jvc_tv, code_jvc_tv_VOLUME_UP, 417, 18, PROTOCOL_JVC),
+  IR_CODE(dict_rca_tv, code_rca_tv_VOLUME_UP, 289, 27, FORMAT_BITS_3)
 };
-const uint8_t VOLUME_UP_TOTAL = NUM_ELEM(VOLUME_UP);
+static_assert(NUM_ELEM(VOLUME_UP) == VOLUME_UP_TOTAL, "VOLUME_UP_TOTAL is out of date");
 
 //VOLUME DOWN===============================================
 const IRCode VOLUME_DOWN[] PROGMEM = {
-  {dict_samsung_tv, code_samsung_tv_VOLUME_DOWN, 34, 13},
-  {dict_lge_tv, code_lge_tv_VOLUME_DOWN, 34, 13},
-  {dict_sony_tv, code_sony_tv_VOLUME_DOWN, 13, 12},
-  {dict_panasonic_tv, code_panasonic_tv_VOLUME_DOWN, 50, 14},
-  {dict_sharp_tv, code_sharp_tv_VOLUME_DOWN, 16, 13},
-  {dict_philips_tv, code_philips_tv_VOLUME_DOWN, 12, 14},
-  {dict_vizio_tv, code_vizio_tv_VOLUME_DOWN, 34, 13},
-  {dict_pioneer_tv, code_pioneer_tv_VOLUME_DOWN, 34, 13},
-  {dict_mitsubishi_tv, code_mitsubishi_tv_VOLUME_DOWN, 17, 15},
-  {dict_fujitsu_tv, code_fujitsu_tv_VOLUME_DOWN, 50, 13},
-  {dict_toshiba_tv, code_toshiba_tv_VOLUME_DOWN, 34, 13},
-  {dict_sanyo_tv, code_sanyo_tv_VOLUME_DOWN, 34, 13},
-  {dict_jvc_tv, code_jvc_tv_VOLUME_DOWN, 18, 13},
-  {dict_rca_tv, code_rca_tv_VOLUME_DOWN, 27, 9}
+  IR_CODE(dict_samsung_tv, code_samsung_tv_VOLUME_DOWN, 417, 34, PROTOCOL_NEC),
+  IR_CODE(dict_lge_tv, code_lge_tv_VOLUME_DOWN, 417, 34, PROTOCOL_NEC),
+  IR_CODE(dict_sony_tv, code_sony_tv_VOLUME_DOWN, 382, 13, PROTOCOL_SIRC),
+  IR_CODE(dict_panasonic_tv, code_panasonic_tv_VOLUME_DOWN, 448, 50, PROTOCOL_KASEIKYO),
+  IR_CODE(dict_sharp_tv, code_sharp_tv_VOLUME_DOWN, 417, 16, PROTOCOL_SHARP),
+  IR_CODE(dict_philips_tv, code_philips_tv_VOLUME_DOWN, 448, 12, PROTOCOL_RC5),
+  IR_CODE(dict_vizio_tv, code_vizio_tv_VOLUME_DOWN, 417, 34, PROTOCOL_NEC),
+  IR_CODE(dict_pioneer_tv, code_pioneer_tv_VOLUME_DOWN, 417, 34, PROTOCOL_NEC),
+  IR_CODE(dict_mitsubishi_tv, code_mitsubishi_tv_VOLUME_DOWN, 479, 17, PROTOCOL_MITSUBISHI),
+  IR_CODE(dict_fujitsu_tv, code_fujitsu_tv_VOLUME_DOWN, 417, 50, PROTOCOL_KASEIKYO),
+  IR_CODE(dict_vizio_tv, code_toshiba_tv_VOLUME_DOWN, 417, 34, PROTOCOL_NEC),
+  IR_CODE(dict_vizio_tv, code_sanyo_tv_VOLUME_DOWN, 417, 34, PROTOCOL_NEC),
+  IR_CODE(dict_jvc_tv, code_jvc_tv_VOLUME_DOWN, 417, 18, PROTOCOL_JVC),
+  IR_CODE(dict_rca_tv, code_rca_tv_VOLUME_DOWN, 289, 27, FORMAT_BITS_3)
 };
-const uint8_t VOLUME_DOWN_TOTAL = NUM_ELEM(VOLUME_DOWN);
+static_assert(NUM_ELEM(VOLUME_DOWN) == VOLUME_DOWN_TOTAL, "VOLUME_DOWN_TOTAL is out of date");
 
 //CHANNEL UP================================================
 const IRCode CHANNEL_UP[] PROGMEM = {
-  {dict_samsung_tv, code_samsung_tv_CHANNEL_UP, 34, 13},
-  {dict_lge_tv, code_lge_tv_CHANNEL_UP, 34, 13},
-  {dict_sony_tv, code_sony_tv_CHANNEL_UP, 13, 12},
-  {dict_panasonic_tv, code_panasonic_tv_CHANNEL_UP, 50, 14},
-  {dict_sharp_tv, code_sharp_tv_CHANNEL_UP, 16, 13},
-  {dict_philips_tv, code_philips_tv_CHANNEL_UP, 12, 14},
-  {dict_vizio_tv, code_vizio_tv_CHANNEL_UP, 34, 13},
-  {dict_pioneer_tv, code_pioneer_tv_CHANNEL_UP, 34, 13},
-  {dict_mitsubishi_tv, code_mitsubishi_tv_CHANNEL_UP, 17, 15},
-  {dict_fujitsu_tv, code_fujitsu_tv_CHANNEL_UP, 50, 13},
-  {dict_toshiba_tv, code_toshiba_tv_CHANNEL_UP, 34, 13},
-  {dict_sanyo_tv, code_sanyo_tv_CHANNEL_UP, 34, 13},
-  {dict_jvc_tv, code_jvc_tv_CHANNEL_UP, 18, 13},
-  {dict_rca_tv, code_rca_tv_CHANNEL_UP, 27, 9}
+  IR_CODE(dict_samsung_tv, code_samsung_tv_CHANNEL_UP, 417, 34, PROTOCOL_NEC),
+  IR_CODE(dict_lge_tv, code_lge_tv_CHANNEL_UP, 417, 34, PROTOCOL_NEC),
+  IR_CODE(dict_sony_tv, code_sony_tv_CHANNEL_UP, 382, 13, PROTOCOL_SIRC),
+  IR_CODE(dict_panasonic_tv, code_panasonic_tv_CHANNEL_UP, 448, 50, PROTOCOL_KASEIKYO),
+  IR_CODE(dict_sharp_tv, code_sharp_tv_CHANNEL_UP, 417, 16, PROTOCOL_SHARP),
+  IR_CODE(dict_philips_tv, code_philips_tv_CHANNEL_UP, 448, 12, PROTOCOL_RC5),
+  IR_CODE(dict_vizio_tv, code_vizio_tv_CHANNEL_UP, 417, 34, PROTOCOL_NEC),
+  IR_CODE(dict_pioneer_tv, code_pioneer_tv_CHANNEL_UP, 417, 34, PROTOCOL_NEC),
+  IR_CODE(dict_mitsubishi_tv, code_mitsubishi_tv_CHANNEL_UP, 479, 17, PROTOCOL_MITSUBISHI),
+  IR_CODE(dict_fujitsu_tv, code_fujitsu_tv_CHANNEL_UP, 417, 50, PROTOCOL_KASEIKYO),
+  IR_CODE(dict_vizio_tv, code_toshiba_tv_CHANNEL_UP, 417, 34, PROTOCOL_NEC),
+  IR_CODE(dict_vizio_tv, code_sanyo_tv_CHANNEL_UP, 417, 34, PROTOCOL_NEC),
+  IR_CODE(dict_jvc_tv, code_jvc_tv_CHANNEL_UP, 417, 18, PROTOCOL_JVC),
+  IR_CODE(dict_rca_tv, code_rca_tv_CHANNEL_UP, 289, 27, FORMAT_BITS_3)
 };
-const uint8_t CHANNEL_UP_TOTAL = NUM_ELEM(CHANNEL_UP);
+static_assert(NUM_ELEM(CHANNEL_UP) == CHANNEL_UP_TOTAL, "CHANNEL_UP_TOTAL is out of date");
 
 //CHANNEL DOWN==============================================
 const IRCode CHANNEL_DOWN[] PROGMEM = {
-  {dict_samsung_tv, code_samsung_tv_CHANNEL_DOWN, 34, 13},
-  {dict_lge_tv, code_lge_tv_CHANNEL_DOWN, 34, 13},
-  {dict_sony_tv, code_sony_tv_CHANNEL_DOWN, 13, 12},
-  {dict_panasonic_tv, code_panasonic_tv_CHANNEL_DOWN, 50, 14},
-  {dict_sharp_tv, code_sharp_tv_CHANNEL_DOWN, 16, 13},
-  {dict_philips_tv, code_philips_tv_CHANNEL_DOWN, 12, 14},
-  {dict_vizio_tv, code_vizio_tv_CHANNEL_DOWN, 34, 13},
-  {dict_pioneer_tv, code_pioneer_tv_CHANNEL_DOWN, 34, 13},
-  {dict_mitsubishi_tv, code_mitsubishi_tv_CHANNEL_DOWN, 17, 15},
-  {dict_fujitsu_tv, code_fujitsu_tv_CHANNEL_DOWN, 50, 13},
-  {dict_toshiba_tv, code_toshiba_tv_CHANNEL_DOWN, 34, 13},
-  {dict_sanyo_tv, code_sanyo_tv_CHANNEL_DOWN, 34, 13},
-  {dict_jvc_tv, code_jvc_tv_CHANNEL_DOWN, 18, 13},
-  {dict_rca_tv, code_rca_tv_CHANNEL_DOWN, 27, 9}
+  IR_CODE(dict_samsung_tv, code_samsung_tv_CHANNEL_DOWN, 417, 34, PROTOCOL_NEC),
+  IR_CODE(dict_lge_tv, code_lge_tv_CHANNEL_DOWN, 417, 34, PROTOCOL_NEC),
+  IR_CODE(dict_sony_tv, code_sony_tv_CHANNEL_DOWN, 382, 13, PROTOCOL_SIRC),
+  IR_CODE(dict_panasonic_tv, code_panasonic_tv_CHANNEL_DOWN, 448, 50, PROTOCOL_KASEIKYO),
+  IR_CODE(dict_sharp_tv, code_sharp_tv_CHANNEL_DOWN, 417, 16, PROTOCOL_SHARP),
+  IR_CODE(dict_philips_tv, code_philips_tv_CHANNEL_DOWN, 448, 12, PROTOCOL_RC5),
+  IR_CODE(dict_vizio_tv, code_vizio_tv_CHANNEL_DOWN, 417, 34, PROTOCOL_NEC),
+  IR_CODE(dict_pioneer_tv, code_pioneer_tv_CHANNEL_DOWN, 417, 34, PROTOCOL_NEC),
+  IR_CODE(dict_mitsubishi_tv, code_mitsubishi_tv_CHANNEL_DOWN, 479, 17, PROTOCOL_MITSUBISHI),
+  IR_CODE(dict_fujitsu_tv, code_fujitsu_tv_CHANNEL_DOWN, 417, 50, PROTOCOL_KASEIKYO),
+  IR_CODE(dict_vizio_tv, code_toshiba_tv_CHANNEL_DOWN, 417, 34, PROTOCOL_NEC),
+  IR_CODE(dict_vizio_tv, code_sanyo_tv_CHANNEL_DOWN, 417, 34, PROTOCOL_NEC),
+  IR_CODE(dict_jvc_tv, code_jvc_tv_CHANNEL_DOWN, 417, 18, PROTOCOL_JVC),
+  IR_CODE(dict_rca_tv, code_rca_tv_CHANNEL_DOWN, 289, 27, FORMAT_BITS_3)
 };
-const uint8_t CHANNEL_DOWN_TOTAL = NUM_ELEM(CHANNEL_DOWN);
-
-
+static_assert(NUM_ELEM(CHANNEL_DOWN) == CHANNEL_DOWN_TOTAL, "CHANNEL_DOWN_TOTAL is out of date");
 
 //projectors
 
-
-//POWER ON=================================================
+//POWER ON==================================================
 const IRCode PROJ_POWER_ON[] PROGMEM = {
-  {dict_sharp_projector, code_sharp_projector_POWER_ON, 32, 13}//,
-  //{dict_sharp2_projector, code_sharp2_projector_POWER_ON, 80, 13}
+  IR_CODE(dict_sharp_projector, code_sharp_projector_POWER_ON, 417, 32, PROTOCOL_SHARP)
 };
-const uint8_t PROJ_POWER_ON_TOTAL = NUM_ELEM(PROJ_POWER_ON);
+static_assert(NUM_ELEM(PROJ_POWER_ON) == PROJ_POWER_ON_TOTAL, "PROJ_POWER_ON_TOTAL is out of date");
 
-//POWER OFF/standby==================================================
+//POWER OFF=================================================
 const IRCode PROJ_POWER_OFF[] PROGMEM = {
-  {dict_sharp_projector, code_sharp_projector_POWER_STANDBY, 32, 13}
+  IR_CODE(dict_sharp_projector, code_sharp_projector_POWER_STANDBY, 417, 32, PROTOCOL_SHARP)
 };
-const uint8_t PROJ_POWER_OFF_TOTAL = NUM_ELEM(PROJ_POWER_OFF);
+static_assert(NUM_ELEM(PROJ_POWER_OFF) == PROJ_POWER_OFF_TOTAL, "PROJ_POWER_OFF_TOTAL is out of date");
 
 //VOLUME UP=================================================
 const IRCode PROJ_VOLUME_UP[] PROGMEM = {
-  {dict_sharp_projector, code_sharp_projector_VOLUME_UP, 32, 13}//,
-  //{dict_sharp2_projector, code_sharp2_projector_VOLUME_UP, 128, 13}
+  IR_CODE(dict_sharp_projector, code_sharp_projector_VOLUME_UP, 417, 32, PROTOCOL_SHARP)
 };
-const uint8_t PROJ_VOLUME_UP_TOTAL = NUM_ELEM(PROJ_VOLUME_UP);
+static_assert(NUM_ELEM(PROJ_VOLUME_UP) == PROJ_VOLUME_UP_TOTAL, "PROJ_VOLUME_UP_TOTAL is out of date");
 
 //VOLUME DOWN===============================================
 const IRCode PROJ_VOLUME_DOWN[] PROGMEM = {
-  {dict_sharp_projector, code_sharp_projector_VOLUME_DOWN, 32, 13}//,
-  //{dict_sharp2_projector, code_sharp2_projector_VOLUME_DOWN, 128, 13}
+  IR_CODE(dict_sharp_projector, code_sharp_projector_VOLUME_DOWN, 417, 32, PROTOCOL_SHARP)
+};
+static_assert(NUM_ELEM(PROJ_VOLUME_DOWN) == PROJ_VOLUME_DOWN_TOTAL, "PROJ_VOLUME_DOWN_TOTAL is out of date");
+
+//codes in no table, for the checks in host/ (nothing in the sketch uses them, so they're left out of its flash)
+const IRCode UNLISTED[] PROGMEM = {
+  IR_CODE(dict_vizio_tv, code_vizio_tv_MUTE_ON, 417, 34, PROTOCOL_NEC),
+  IR_CODE(dict_vizio_tv, code_vizio_tv_MUTE_OFF, 417, 34, PROTOCOL_NEC),
+  IR_CODE(dict_sharp2_projector, code_sharp2_projector_POWER_ON, 417, 80, FORMAT_BITS_2 | FORMAT_REPEAT),
+  IR_CODE(dict_sharp2_projector, code_sharp2_projector_POWER_OFF, 417, 80, FORMAT_BITS_2 | FORMAT_REPEAT),
+  IR_CODE(dict_sharp2_projector, code_sharp2_projector_VOLUME_UP, 417, 128, FORMAT_BITS_2 | FORMAT_REPEAT),
+  IR_CODE(dict_sharp2_projector, code_sharp2_projector_VOLUME_DOWN, 417, 128, FORMAT_BITS_2 | FORMAT_REPEAT)
+};
+static_assert(NUM_ELEM(UNLISTED) == UNLISTED_TOTAL, "UNLISTED_TOTAL is out of date");
+
+
+
+//every table, numbered by its TABLE_ constant
+const CodeTable codeTables[NUM_TABLES] PROGMEM = {
+  {POWER_ON, POWER_ON_TOTAL},
+  {POWER_OFF, POWER_OFF_TOTAL},
+  {MUTE, MUTE_TOTAL},
+  {VOLUME_UP, VOLUME_UP_TOTAL},
+  {VOLUME_DOWN, VOLUME_DOWN_TOTAL},
+  {CHANNEL_UP, CHANNEL_UP_TOTAL},
+  {CHANNEL_DOWN, CHANNEL_DOWN_TOTAL},
+  {PROJ_POWER_ON, PROJ_POWER_ON_TOTAL},
+  {PROJ_POWER_OFF, PROJ_POWER_OFF_TOTAL},
+  {PROJ_VOLUME_UP, PROJ_VOLUME_UP_TOTAL},
+  {PROJ_VOLUME_DOWN, PROJ_VOLUME_DOWN_TOTAL}
 };
-const uint8_t PROJ_VOLUME_DOWN_TOTAL = NUM_ELEM(PROJ_VOLUME_DOWN);
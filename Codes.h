@@ -4,11 +4,16 @@
  */
 
 
+#ifndef CODES_H
+#define CODES_H
+
 #include <avr/pgmspace.h>
 #include <stdint.h>
 
 
-#define NUM_ELEM(x) (sizeof (x) / sizeof (*(x)));
+#define NUM_ELEM(x) (sizeof (x) / sizeof (*(x)))
+
+#define CARRIER_SCALE 16 //carrier periods are stored in 1/16ths of a microsecond (a cpu cycle at 16MHz)
 
 
 struct BurstPair
@@ -39,43 +44,121 @@ union NibbleUnion
   uint8_t i;
 };
 
+//IRCode formats. Anything else is a protocol ID (see Protocols.h)
+#define FORMAT_NIBBLES 0    //code[] is a Nibbles string of indices into dict[]
+#define FORMAT_BITS    0x10 //code[] packs each index into fewer bits, LSB first (small dictionaries)
+#define FORMAT_WIDTH   0x0F //bits per index of a FORMAT_BITS code
+#define FORMAT_BITS_1  (FORMAT_BITS | 1)
+#define FORMAT_BITS_2  (FORMAT_BITS | 2)
+#define FORMAT_BITS_3  (FORMAT_BITS | 3)
+#define FORMAT_BITS_4  (FORMAT_BITS | 4)
+#define FORMAT_REPEAT  0x20 //code[] starts with a list of segments to repeat, then packed indices (use with FORMAT_BITS_*)
+
+#define IS_PROTOCOL(format) (((format) & FORMAT_WIDTH) && !((format) & FORMAT_BITS))
+
+/*
+ * Repeat codes. code[0] is the number of segments, followed by two bytes for each:
+ * the bursts in one pass of the segment, and the number of passes (SEGMENT_FINAL set if
+ * the last pass ends on a different burst). The index string follows the segment list,
+ * holding each segment's bursts once, then its final burst if it has one.
+ * A run of one burst is a segment of length 1, a repeated frame is a segment of length N.
+ */
+#define SEGMENT_REPEATS 0x7F
+#define SEGMENT_FINAL   0x80 //last pass swaps its last burst for the extra index after the segment
+
+//where an IRCode and everything it points to lives
+#define CODE_FLASH  0 //the tables in Codes.cpp
+#define CODE_RAM    1 //learned codes, loaded out of EEPROM (always FORMAT_NIBBLES, see Learn.h)
+#define CODE_STREAM 2 //the open stream, played as it comes in over the serial port (see Pronto.h)
+
 struct IRCode
 {
   const BurstPair* dict;       //dictionary of burst pairs
-  const Nibbles*   code;       //code in terms of burst pairs in dict;
-  const uint8_t    codeLength; //number of nibbles in code[]
-  const uint8_t    carrier;    //microseconds of on time (wavelength / 2)
+  const void*      code;       //code in terms of burst pairs in dict, or a protocol payload
+  uint16_t         carrier;    //period of the carrier, in 1/CARRIER_SCALE microseconds
+  uint8_t          codeLength; //number of bursts in the code
+  uint8_t          format;     //how code[] is stored
+};
+
+//a table of codes, and how many it holds
+struct CodeTable
+{
+  const IRCode* codes;
+  uint8_t       total;
+};
+
+//streaming decoder state (decodes one burst at a time, no heap)
+struct CodeCursor
+{
+  const BurstPair* dict;   //dictionary of burst pairs (flash, or RAM for a CODE_RAM code)
+  const void*      code;   //nibble string or protocol payload
+  uint16_t         carrier; //period of the carrier (copied out of flash, for the transmit engine)
+  uint8_t          length; //number of bursts in code
+  uint8_t          index;  //next burst to be decoded
+  uint8_t          format;
+  uint8_t          space;  //CODE_FLASH, CODE_RAM or CODE_STREAM
+  uint8_t          bit;    //next payload bit (protocol codes)
+  uint8_t          frame;  //bursts left in the current frame (protocol codes)
+  const uint8_t*   segment; //segment being played (repeat codes)
+  uint8_t          start;   //index of its first burst in the index string (repeat codes)
+  uint8_t          step;    //next burst of the current pass (repeat codes)
+  uint8_t          passes;  //passes left, 0 before the segment starts (repeat codes)
 };
 
 //accessor methods (retrieves and decompresses from flash)
 BurstPair* getCode(const IRCode* code);
 int getCarrier(const IRCode* desired);
 int getLength(const IRCode* desired);
+int getFormat(const IRCode* desired);
+
+void beginCode(CodeCursor* cursor, const IRCode* desired, uint8_t space = CODE_FLASH);
+bool nextBurst(CodeCursor* cursor, BurstPair* pair);
 
 //code tables
 
 //TVs
 extern const IRCode POWER_ON[] PROGMEM;
-extern const uint8_t POWER_ON_TOTAL;
+constexpr uint8_t POWER_ON_TOTAL = 14;
 extern const IRCode POWER_OFF[] PROGMEM;
-extern const uint8_t POWER_OFF_TOTAL;
+constexpr uint8_t POWER_OFF_TOTAL = 14;
 extern const IRCode MUTE[] PROGMEM;
-extern const uint8_t MUTE_TOTAL;
+constexpr uint8_t MUTE_TOTAL = 13;
 extern const IRCode VOLUME_UP[] PROGMEM;
-extern const uint8_t VOLUME_UP_TOTAL;
+constexpr uint8_t VOLUME_UP_TOTAL = 14;
 extern const IRCode VOLUME_DOWN[] PROGMEM;
-extern const uint8_t VOLUME_DOWN_TOTAL;
+constexpr uint8_t VOLUME_DOWN_TOTAL = 14;
 extern const IRCode CHANNEL_UP[] PROGMEM;
-extern const uint8_t CHANNEL_UP_TOTAL;
+constexpr uint8_t CHANNEL_UP_TOTAL = 14;
 extern const IRCode CHANNEL_DOWN[] PROGMEM;
-extern const uint8_t CHANNEL_DOWN_TOTAL;
+constexpr uint8_t CHANNEL_DOWN_TOTAL = 14;
 
 //projectors
-extern const IRCode PROJ_POWER_OFF[] PROGMEM;
-extern const uint8_t PROJ_POWER_OFF_TOTAL;
 extern const IRCode PROJ_POWER_ON[] PROGMEM;
-extern const uint8_t PROJ_POWER_ON_TOTAL;
+constexpr uint8_t PROJ_POWER_ON_TOTAL = 1;
+extern const IRCode PROJ_POWER_OFF[] PROGMEM;
+constexpr uint8_t PROJ_POWER_OFF_TOTAL = 1;
 extern const IRCode PROJ_VOLUME_UP[] PROGMEM;
-extern const uint8_t PROJ_VOLUME_UP_TOTAL;
+constexpr uint8_t PROJ_VOLUME_UP_TOTAL = 1;
 extern const IRCode PROJ_VOLUME_DOWN[] PROGMEM;
-extern const uint8_t PROJ_VOLUME_DOWN_TOTAL;
+constexpr uint8_t PROJ_VOLUME_DOWN_TOTAL = 1;
+
+//codes in no table (not in codeTables)
+extern const IRCode UNLISTED[] PROGMEM;
+constexpr uint8_t UNLISTED_TOTAL = 6;
+
+//every table (codeTables[TABLE_...])
+constexpr uint8_t TABLE_POWER_ON = 0;
+constexpr uint8_t TABLE_POWER_OFF = 1;
+constexpr uint8_t TABLE_MUTE = 2;
+constexpr uint8_t TABLE_VOLUME_UP = 3;
+constexpr uint8_t TABLE_VOLUME_DOWN = 4;
+constexpr uint8_t TABLE_CHANNEL_UP = 5;
+constexpr uint8_t TABLE_CHANNEL_DOWN = 6;
+constexpr uint8_t TABLE_PROJ_POWER_ON = 7;
+constexpr uint8_t TABLE_PROJ_POWER_OFF = 8;
+constexpr uint8_t TABLE_PROJ_VOLUME_UP = 9;
+constexpr uint8_t TABLE_PROJ_VOLUME_DOWN = 10;
+constexpr uint8_t NUM_TABLES = 11;
+extern const CodeTable codeTables[NUM_TABLES] PROGMEM;
+
+#endif
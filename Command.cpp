@@ -0,0 +1,472 @@
+/*
+ * Written by Brendan Whitfield
+ *
+ * Serial commands. Frames are read a byte at a time as they come in, checked, and their
+ * commands go into a ring, so the emitters keep going while the next batch arrives.
+ * A command is started as soon as the one before it has finished queueing its codes, and
+ * the codes of both share the send queues, so there's no pause between them either.
+ * The time a command took is taken from loop(), so it's good to within a pass of it.
+ * A stream's bytes skip the ring and go straight to Pronto.cpp, so they can pile up there
+ * while the commands ahead of it run.
+ * Uses a fixed COMMAND_FRAME + COMMAND_RING * 8 bytes of RAM or so, and nothing on the heap.
+ */
+
+
+
+#include "Command.h"
+#include "Transmit.h"
+#include "Sweep.h"
+#include "Protocols.h"
+#include "Pronto.h"
+
+
+#define NO_TICKET -1
+
+//where the frame reader is up to
+#define READ_SYNC    0
+#define READ_LENGTH  1
+#define READ_PAYLOAD 2
+#define READ_CRC     3
+
+//a command waiting in the ring, or running
+struct Command
+{
+  uint8_t  type;    //COMMAND_SEND, COMMAND_SWEEP or COMMAND_STREAM
+  uint8_t  id;
+  uint8_t  table;
+  uint8_t  index;   //(COMMAND_SEND)
+  uint8_t  channel; //(COMMAND_SEND and COMMAND_STREAM)
+  uint8_t  repeats; //times to run it
+  uint16_t gap;     //microseconds after each code, 0 for its usual gap (COMMAND_SEND)
+};
+
+
+
+//frame being read
+static uint8_t frame[COMMAND_FRAME];
+static uint8_t reading = READ_SYNC;
+static uint8_t length = 0;
+static uint8_t got = 0;
+static uint8_t crc = 0;
+static uint32_t frameStart = 0;
+
+//commands waiting (head and tail run freely)
+static Command ring[COMMAND_RING];
+static uint8_t head = 0;
+static uint8_t tail = 0;
+static uint8_t nextId = 0;
+
+//command running
+static bool running = false;
+static Command current;
+static const IRCode* codes; //its table
+static uint8_t total;
+static uint8_t left;        //runs still to queue
+static uint16_t sent;       //codes queued
+static uint16_t dropped;    //codes sendCode() turned away (SEND_BAD)
+static int first;           //ticket of its first code
+static int last[SEND_CHANNELS]; //ticket of its last code on each emitter
+static bool started = false;
+static uint32_t startTime = 0;
+
+//the stream
+static uint32_t streamTaken = 0; //when its COMMAND_STREAM came in
+static uint32_t streamFed = 0;   //when it was last given bytes (or started playing)
+static uint8_t credited = 0;     //pairs played that the sender's been given back
+
+//last command done, and the line
+static uint8_t lastId = 0;
+static uint32_t lastTime = 0;
+static bool listening = false; //the line has been active within COMMAND_LINGER
+static uint32_t heardAt = 0;
+
+
+
+static uint8_t crc8(uint8_t crc, uint8_t data)
+{
+  crc ^= data;
+  for(uint8_t i = 0; i < 8; i++)
+  {
+    crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : (crc << 1);
+  }
+  return crc;
+}
+
+static void reply(const uint8_t* payload, uint8_t size)
+{
+  uint8_t start[2] = {COMMAND_SYNC, size};
+  uint8_t check = crc8(0, size);
+  for(uint8_t i = 0; i < size; i++) { check = crc8(check, payload[i]); }
+
+  commandPortWrite(start, 2);
+  commandPortWrite(payload, size);
+  commandPortWrite(&check, 1);
+}
+
+static void put32(uint8_t* at, uint32_t value)
+{
+  for(uint8_t i = 0; i < 4; i++) { at[i] = value >> (8 * i); }
+}
+
+static uint8_t waiting()
+{
+  return head - tail;
+}
+
+static void replyFrame(uint8_t status, uint8_t taken, uint8_t firstId)
+{
+  uint8_t payload[5] = {REPLY_FRAME, status, taken, firstId, (uint8_t)(COMMAND_RING - waiting())};
+  reply(payload, sizeof(payload));
+}
+
+static void replyStatus()
+{
+  uint8_t payload[10] = {REPLY_STATUS, (uint8_t)(waiting() + running), (uint8_t)(COMMAND_RING - waiting()),
+                         isSending(), nextId, lastId};
+  put32(payload + 6, lastTime);
+  reply(payload, sizeof(payload));
+}
+
+//bytes the command at `at` takes, with its arguments. 0 if there's no such command
+static uint8_t commandSize(uint8_t at)
+{
+  switch(frame[at])
+  {
+    case COMMAND_SEND:   return 4;
+    case COMMAND_SWEEP:  return 2;
+    case COMMAND_REPEAT: return 4;
+    case COMMAND_STATUS: return 1;
+    case COMMAND_STREAM: return 5;
+    case COMMAND_DATA:   return (length - at >= 2) ? length - at : 0; //the rest of the frame
+  }
+  return 0;
+}
+
+//checks every command of the frame, and counts the ones that go in the ring and the pairs its stream bytes finish. False if any is bad
+static bool checkFrame(uint8_t* count, uint8_t* pairs)
+{
+  *count = 0;
+  *pairs = 0;
+  bool repeat = false; //a REPEAT is waiting for its command
+  bool opens = false;  //a STREAM is opened by this frame
+
+  for(uint8_t at = 0; at < length; at += commandSize(at))
+  {
+    uint8_t type = frame[at];
+    uint8_t size = commandSize(at);
+    if(!size || (at + size > length)) { return false; }
+
+    if((type == COMMAND_SEND) || (type == COMMAND_SWEEP))
+    {
+      uint8_t table = frame[at + 1];
+      if(table >= NUM_TABLES) { return false; }
+      if((type == COMMAND_SEND)
+         && ((frame[at + 2] >= pgm_read_byte(&codeTables[table].total)) || (frame[at + 3] >= SEND_CHANNELS))) { return false; }
+      (*count)++;
+      repeat = false;
+    }
+    else if(type == COMMAND_REPEAT)
+    {
+      if(!frame[at + 1] || repeat) { return false; }
+      repeat = true;
+    }
+    else if(type == COMMAND_STREAM)
+    {
+      //one at a time, and only once
+      if(repeat || opens || streamOpen() || (frame[at + 1] >= SEND_CHANNELS)) { return false; }
+      if((frame[at + 2] != STREAM_PRONTO) && ((frame[at + 2] != STREAM_BINARY) || !(frame[at + 3] | frame[at + 4]))) { return false; }
+      (*count)++;
+      opens = true;
+    }
+    else if(type == COMMAND_DATA)
+    {
+      if(repeat || !streamOpen() || streamEnded()) { return false; }
+      int found = checkStream(frame + at + 2, size - 2, frame[at + 1]);
+      if(found < 0) { return false; }
+      *pairs = found;
+    }
+  }
+  return !repeat;
+}
+
+//takes a whole frame's commands, or none of them
+static void takeFrame()
+{
+  uint8_t count;
+  uint8_t pairs;
+  if(!checkFrame(&count, &pairs))          { replyFrame(COMMAND_BAD, 0, nextId); return; }
+  if(count > COMMAND_RING - waiting())     { replyFrame(COMMAND_FULL, 0, nextId); return; }
+  if(pairs > streamRoom())                 { replyFrame(COMMAND_FULL, 0, nextId); return; }
+
+  uint8_t firstId = nextId;
+  uint8_t repeats = 1;
+  uint16_t gap = 0;
+  bool status = false;
+
+  for(uint8_t at = 0; at < length; at += commandSize(at))
+  {
+    uint8_t type = frame[at];
+    if(type == COMMAND_STATUS) { status = true; }
+    else if(type == COMMAND_DATA)
+    {
+      writeStream(frame + at + 2, length - at - 2, frame[at + 1]);
+      streamFed = frameStart;
+    }
+    else if(type == COMMAND_REPEAT)
+    {
+      repeats = frame[at + 1];
+      gap = frame[at + 2] | (frame[at + 3] << 8);
+    }
+    else
+    {
+      Command* c = ring + (head % COMMAND_RING);
+      c->type = type;
+      c->id = nextId++;
+      c->table = frame[at + 1];
+      c->index = (type == COMMAND_SEND) ? frame[at + 2] : 0;
+      c->channel = (type == COMMAND_SEND) ? frame[at + 3] : 0;
+      c->repeats = repeats;
+      c->gap = gap;
+      head++;
+      repeats = 1;
+      gap = 0;
+
+      if(type == COMMAND_STREAM)
+      {
+        c->channel = frame[at + 1];
+        openStream(frame[at + 2], frame[at + 3] | (frame[at + 4] << 8));
+        streamTaken = frameStart;
+        credited = 0;
+      }
+    }
+  }
+
+  replyFrame(COMMAND_OK, count, firstId);
+  if(status) { replyStatus(); }
+}
+
+static void readByte(uint8_t data, uint32_t now)
+{
+  switch(reading)
+  {
+    case READ_SYNC:
+      if(data == COMMAND_SYNC)
+      {
+        reading = READ_LENGTH;
+        frameStart = now;
+      }
+      break;
+
+    case READ_LENGTH:
+      if(!data || (data > COMMAND_FRAME))
+      {
+        reading = READ_SYNC; //not a frame after all
+        break;
+      }
+      length = data;
+      got = 0;
+      crc = crc8(0, data);
+      reading = READ_PAYLOAD;
+      break;
+
+    case READ_PAYLOAD:
+      frame[got++] = data;
+      crc = crc8(crc, data);
+      if(got == length) { reading = READ_CRC; }
+      break;
+
+    case READ_CRC:
+      reading = READ_SYNC;
+      if(data == crc) { takeFrame(); }
+      else            { replyFrame(COMMAND_BAD_CRC, 0, nextId); }
+      break;
+  }
+}
+
+
+
+//sets the command at the tail of the ring going
+static void startCommand()
+{
+  current = ring[tail % COMMAND_RING];
+  tail++;
+
+  if(current.type != COMMAND_STREAM)
+  {
+    codes = (const IRCode*)pgm_read_ptr(&codeTables[current.table].codes);
+    total = pgm_read_byte(&codeTables[current.table].total);
+  }
+  if(current.type == COMMAND_SWEEP) { beginSweep(codes, total); }
+
+  left = current.repeats;
+  sent = 0;
+  dropped = 0;
+  first = NO_TICKET;
+  for(uint8_t i = 0; i < SEND_CHANNELS; i++) { last[i] = NO_TICKET; }
+  started = false;
+  running = true;
+}
+
+//queues as many of the running command's codes as there's room for
+static void queueCodes()
+{
+  while(left)
+  {
+    int ticket;
+    if(current.type == COMMAND_SEND)
+    {
+      const IRCode* code = codes + current.index;
+      uint8_t format = getFormat(code);
+      uint16_t gap = current.gap ? current.gap : (IS_PROTOCOL(format) ? getProtocolGap(format) : SEND_GAP);
+      ticket = sendCode(code, gap, CODE_FLASH, current.channel);
+      if(ticket == SEND_FULL) { return; }
+      left--;
+    }
+    else if(current.type == COMMAND_STREAM)
+    {
+      //half the ring is in before it plays, so it doesn't run dry straight away
+      //(one that timed out before its carrier came in has no code, and is dropped)
+      if(!streamReady()) { return; }
+      const IRCode* code = streamCode();
+      ticket = code ? sendCode(code, SEND_GAP, CODE_STREAM, current.channel) : SEND_BAD;
+      if(ticket == SEND_FULL) { return; }
+      left--;
+    }
+    else
+    {
+      ticket = sweep(NULL);
+      if(ticket == SEND_FULL) { return; }
+      if(ticket == SWEEP_DONE)
+      {
+        if(--left) { beginSweep(codes, total); }
+        continue;
+      }
+    }
+
+    if(ticket == SEND_BAD)
+    {
+      dropped++;
+      continue;
+    }
+
+    if(first == NO_TICKET) { first = ticket; }
+    last[SEND_CHANNEL(ticket)] = ticket;
+    sent++;
+  }
+}
+
+//true once every code the running command queued has gone out
+static bool codesDone()
+{
+  for(uint8_t i = 0; i < SEND_CHANNELS; i++)
+  {
+    if((last[i] != NO_TICKET) && (getSendStatus(last[i]) != SEND_DONE)) { return false; }
+  }
+  return true;
+}
+
+//a stream's REPLY_STREAM, and it's closed for the next one
+static void replyStream(uint32_t now)
+{
+  StreamStats stats;
+  getStreamStats(&stats);
+  closeStream();
+
+  uint8_t payload[18] = {REPLY_STREAM, current.id};
+  put32(payload + 2, stats.pairs);
+  put32(payload + 6, stats.bytes);
+  payload[10] = stats.underruns;
+  payload[11] = stats.underruns >> 8;
+  payload[12] = stats.starved;
+  payload[13] = stats.starved >> 8;
+  put32(payload + 14, now - streamTaken);
+  reply(payload, sizeof(payload));
+}
+
+//gives the sender back the room the stream has played out of the ring, half of it at a time
+static void creditStream()
+{
+  uint8_t played = streamPlayed();
+  if(!streamOpen() || ((uint8_t)(played - credited) < STREAM_HALF)) { return; }
+
+  uint8_t payload[2] = {REPLY_CREDIT, (uint8_t)(played - credited)};
+  reply(payload, sizeof(payload));
+  credited = played;
+}
+
+static void runCommands(uint32_t now)
+{
+  while(running || waiting())
+  {
+    if(!running)
+    {
+      startCommand();
+      streamFed = now;
+    }
+
+    //a stream the sender stopped feeding ends with what it has
+    if((current.type == COMMAND_STREAM) && !streamEnded() && (now - streamFed >= (uint32_t)STREAM_TIMEOUT * 1000)) { endStream(); }
+    queueCodes();
+
+    if(!started && (first != NO_TICKET) && (getSendStatus(first) != SEND_QUEUED))
+    {
+      started = true;
+      startTime = now;
+    }
+    if(left || !codesDone()) { return; }
+
+    //done (the trailing gap of its last code is still going, the next command's codes follow it)
+    running = false;
+    lastId = current.id;
+    lastTime = started ? now - startTime : 0;
+
+    uint8_t payload[10] = {REPLY_DONE, current.id, (uint8_t)sent, (uint8_t)(sent >> 8)};
+    put32(payload + 4, lastTime);
+    payload[8] = dropped;
+    payload[9] = dropped >> 8;
+    reply(payload, sizeof(payload));
+    if(current.type == COMMAND_STREAM) { replyStream(now); }
+  }
+}
+
+
+
+void beginCommands()
+{
+  commandPortBegin();
+}
+
+void updateCommands()
+{
+  uint32_t now = commandPortMicros();
+
+  if(commandPortHeard())
+  {
+    listening = true;
+    heardAt = now;
+  }
+  else if(listening && (now - heardAt >= (uint32_t)COMMAND_LINGER * 1000))
+  {
+    listening = false;
+  }
+
+  for(int data = commandPortRead(); data >= 0; data = commandPortRead())
+  {
+    readByte(data, now);
+  }
+
+  //a frame that stopped halfway would swallow the start of the next one
+  if((reading != READ_SYNC) && (now - frameStart >= (uint32_t)COMMAND_TIMEOUT * 1000))
+  {
+    reading = READ_SYNC;
+    replyFrame(COMMAND_LATE, 0, nextId);
+  }
+
+  runCommands(now);
+  creditStream();
+}
+
+bool commandsIdle()
+{
+  return !running && !waiting() && (reading == READ_SYNC) && !listening;
+}
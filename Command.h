@@ -0,0 +1,100 @@
+/*
+ * Written by Brendan Whitfield
+ *
+ */
+
+
+#ifndef COMMAND_H
+#define COMMAND_H
+
+#include "Codes.h"
+
+
+#define COMMAND_BAUD    57600 //0.8% off at 16MHz, where 115200 is 2.1% off
+#define COMMAND_FRAME   32    //most payload bytes in a frame
+#define COMMAND_RING    16    //commands waiting to run (a full frame of sweeps fits)
+#define COMMAND_LINGER  50    //milliseconds to stay awake after the line was last active
+#define COMMAND_TIMEOUT 100   //milliseconds a frame can take to arrive before it's dropped
+
+/*
+ * Frames, both ways:  COMMAND_SYNC, length, payload[length], crc
+ * crc is a CRC-8 (polynomial 0x07) of the length and the payload. Multi-byte values are
+ * little endian. A frame to the board holds one or more commands, back to back:
+ *
+ *   COMMAND_SEND    table, index, channel   send codeTables[table].codes[index] on an emitter
+ *   COMMAND_SWEEP   table                   sweep the table (see Sweep.h), over every emitter
+ *   COMMAND_REPEAT  count, gap(2)           run the next command `count` times. `gap` is the
+ *                                           silence after each code in microseconds (sends
+ *                                           only, 0 leaves each code its usual gap)
+ *   COMMAND_STATUS                          answered straight away with a REPLY_STATUS
+ *   COMMAND_STREAM  channel, format, carrier(2)   open a stream, a code that's played as it comes
+ *                                           in (see Pronto.h). `carrier` as in IRCode (STREAM_BINARY
+ *                                           only, a Pronto header has its own)
+ *   COMMAND_DATA    last, bytes...          the next bytes of the open stream, to the end of the
+ *                                           frame. A non-zero `last` ends it
+ *
+ * Every frame is answered with a REPLY_FRAME. If it's taken, its commands are numbered from
+ * `first` on, and each one is answered with a REPLY_DONE when its last code has gone out.
+ * A frame is taken whole or not at all, so a rejected one can just be sent again.
+ *
+ *   REPLY_FRAME   status, taken, first, free
+ *   REPLY_DONE    id, codes(2), microseconds(4), dropped(2)   first mark to the end of the last code (its
+ *                                           last space). `dropped` codes were turned away by
+ *                                           sendCode() (SEND_BAD), and aren't in `codes`
+ *   REPLY_STATUS  waiting, free, sending, next, last, microseconds(4)   of the last command done
+ *   REPLY_CREDIT  pairs                     room freed in the stream's ring
+ *   REPLY_STREAM  id, pairs(4), bytes(4), underruns(2), starved(2), microseconds(4)
+ *                                           follows a stream's REPLY_DONE (see StreamStats), timed
+ *                                           from its COMMAND_STREAM coming in
+ *
+ * A stream is a command like the others, and waits its turn in the ring, but its DATA is
+ * taken straight away (in frames after the one that opened it), so the ring can fill before
+ * it starts. The sender starts with STREAM_PAIRS pairs of credit. Every DATA frame spends
+ * the burst pairs it finishes, every REPLY_CREDIT gives some back, and a DATA frame that
+ * doesn't fit is answered with COMMAND_FULL. A stream that runs dry for STREAM_TIMEOUT
+ * once it's playing is ended. One that ends before it has a carrier (a Pronto stream cut
+ * off ahead of its frequency word) is dropped, and its REPLY_DONE counts it as such.
+ */
+
+#define COMMAND_SYNC 0xA5
+
+//commands
+#define COMMAND_SEND   0x01
+#define COMMAND_SWEEP  0x02
+#define COMMAND_REPEAT 0x03
+#define COMMAND_STATUS 0x04
+#define COMMAND_STREAM 0x05
+#define COMMAND_DATA   0x06
+
+//replies
+#define REPLY_FRAME  0x81
+#define REPLY_DONE   0x82
+#define REPLY_STATUS 0x83
+#define REPLY_CREDIT 0x84
+#define REPLY_STREAM 0x85
+
+//REPLY_FRAME status
+#define COMMAND_OK      0
+#define COMMAND_BAD_CRC 1 //the frame was damaged
+#define COMMAND_BAD     2 //an unknown command, a table, index or channel that doesn't exist, or a stream that's malformed or not open
+#define COMMAND_FULL    3 //not enough room for all of its commands (or its stream), try again after some REPLY_DONEs (or REPLY_CREDITs)
+#define COMMAND_LATE    4 //the rest of the frame never came
+
+
+//serial commands (call updateCommands() from loop(), it never waits)
+void beginCommands();
+void updateCommands(); //reads the serial port, runs the commands, and sends the replies
+bool commandsIdle();   //true if nothing is waiting, running or arriving (the buttons can send, and the cpu can sleep)
+
+
+/*
+ * Port backend. The serial port, and a clock to time the commands with.
+ */
+
+void commandPortBegin();  //open the serial port at COMMAND_BAUD, and let a byte coming in wake the cpu
+int commandPortRead();    //next byte received, -1 if there isn't one
+void commandPortWrite(const uint8_t* data, uint8_t length);
+bool commandPortHeard();  //true if the line has been active since the last call
+uint32_t commandPortMicros();
+
+#endif
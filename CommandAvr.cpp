@@ -0,0 +1,60 @@
+/*
+ * Written by Brendan Whitfield
+ *
+ * ATmega328 port backend for the serial commands.
+ * The hardware serial port (pins 0 and 1, and the USB adapter), through the Arduino core's
+ * buffered Serial. The receive pin (PD0) also raises a pin change interrupt (PCINT2), so the
+ * start bit of a byte wakes the cpu from standby. The oscillator keeps running in standby,
+ * so it's awake 6 cycles later, well inside the start bit, and the byte still comes in whole.
+ */
+
+
+
+#ifdef __AVR__
+
+#include <Arduino.h>
+#include "Command.h"
+
+
+
+static volatile bool heard = false;
+
+
+
+void commandPortBegin()
+{
+  Serial.begin(COMMAND_BAUD);
+  PCMSK2 |= _BV(PCINT16); //PD0
+  PCIFR = _BV(PCIF2);     //drop any stale change
+  PCICR |= _BV(PCIE2);
+}
+
+int commandPortRead()
+{
+  return Serial.read();
+}
+
+void commandPortWrite(const uint8_t* data, uint8_t length)
+{
+  Serial.write(data, length);
+}
+
+bool commandPortHeard()
+{
+  //the flag is a single byte, so reading and clearing it can't be torn
+  bool was = heard;
+  heard = false;
+  return was;
+}
+
+uint32_t commandPortMicros()
+{
+  return micros();
+}
+
+ISR(PCINT2_vect)
+{
+  heard = true;
+}
+
+#endif
@@ -0,0 +1,291 @@
+/*
+ * Written by Brendan Whitfield
+ *
+ * Hit cache. The code tables are in order of how common each brand is, which is no help
+ * in a room where the equipment is all one of the last brands. This notes which code of a
+ * sweep the equipment reacted to, going by when the button was let go, and has the next
+ * sweep of the table send it first.
+ * The hits of each table are a HitRecord, written to a log of HITS_SLOTS records in EEPROM.
+ * Each write goes in the next slot along (a table's latest record is the one that counts,
+ * and the older ones are written over in time), so the writes are spread over the whole
+ * log rather than wearing out the same few cells. A live record of another table in the
+ * way is written again where it is, with a newer seq, so every slot takes its turn, and
+ * the seqs in the log never get more than a lap apart.
+ * Only where each table's record is sits in RAM, getHits() reads it from EEPROM.
+ */
+
+
+
+#include <stddef.h>
+#include "Hits.h"
+#include "Transmit.h"
+
+
+
+//a code of the sweep being watched
+struct Watched
+{
+  int           ticket;
+  unsigned long at; //millis() it finished, once it has (all of it, a button can be held past a 16 bit wrap)
+  uint8_t       index;
+  bool          done;
+};
+
+
+
+static uint8_t slotOf[NUM_TABLES]; //slot of each table's latest record, HITS_EMPTY if it has none
+static uint8_t head = 0;           //slot the next record goes in
+static uint16_t seq = 0;           //of the next record
+
+static Watched watched[HITS_WATCH];
+static uint8_t watching = HITS_EMPTY; //table being swept
+static uint8_t latest = 0;            //codes watched since watchSweep() (only the last HITS_WATCH are kept)
+
+
+
+static uint8_t crc8(uint8_t crc, uint8_t data)
+{
+  crc ^= data;
+  for(uint8_t i = 0; i < 8; i++)
+  {
+    crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : (crc << 1);
+  }
+  return crc;
+}
+
+static uint8_t checkRecord(const HitRecord* record)
+{
+  const uint8_t* bytes = (const uint8_t*)record;
+  uint8_t check = 0;
+  for(uint8_t i = 0; i < (uint8_t)offsetof(HitRecord, check); i++) { check = crc8(check, bytes[i]); }
+  return check;
+}
+
+static bool validRecord(const HitRecord* record)
+{
+  return (record->table < NUM_TABLES) && (record->check == checkRecord(record));
+}
+
+//true if seq a was written after b (they wrap)
+static bool newer(uint16_t a, uint16_t b)
+{
+  return (int16_t)(a - b) > 0;
+}
+
+//TABLE_ number of a table, HITS_EMPTY if it's not in codeTables
+static uint8_t tableNumber(const IRCode* table)
+{
+  for(uint8_t t = 0; t < NUM_TABLES; t++)
+  {
+    if(pgm_read_ptr(&codeTables[t].codes) == table) { return t; }
+  }
+  return HITS_EMPTY;
+}
+
+//the table's latest record, or an empty one
+static void readHits(uint8_t table, HitRecord* record)
+{
+  if(slotOf[table] != HITS_EMPTY)
+  {
+    hitsPortRead(slotOf[table], record);
+    return;
+  }
+  record->table = table;
+  for(uint8_t i = 0; i < HITS_DEPTH; i++)
+  {
+    record->hits[i] = HITS_EMPTY;
+    record->scores[i] = 0;
+  }
+}
+
+//writes the record at the head of the log
+static void writeHits(HitRecord* record)
+{
+  //other tables' records are brought up to date where they stand, rather than skipped
+  HitRecord other;
+  for(;;)
+  {
+    hitsPortRead(head, &other);
+    if(!validRecord(&other) || (other.table == record->table) || (slotOf[other.table] != head)) { break; }
+    other.seq = seq++;
+    other.check = checkRecord(&other);
+    hitsPortWrite(head, &other);
+    head = (head + 1) % HITS_SLOTS;
+  }
+
+  record->seq = seq++;
+  record->check = checkRecord(record);
+  hitsPortWrite(head, record);
+  slotOf[record->table] = head;
+  head = (head + 1) % HITS_SLOTS;
+}
+
+//adds `score` to a code's, making room for it if it's new and doesn't score below every other
+static void scoreHit(HitRecord* record, uint8_t index, uint8_t score)
+{
+  uint8_t lowest = 0; //an empty place, or else the lowest scoring one
+  for(uint8_t i = 0; i < HITS_DEPTH; i++)
+  {
+    if(record->hits[i] == index)
+    {
+      record->scores[i] += score;
+      return;
+    }
+    if(record->hits[lowest] == HITS_EMPTY) { continue; }
+    if((record->hits[i] == HITS_EMPTY) || (record->scores[i] < record->scores[lowest])) { lowest = i; }
+  }
+
+  if((record->hits[lowest] != HITS_EMPTY) && (record->scores[lowest] > score)) { return; }
+  record->hits[lowest] = index;
+  record->scores[lowest] = score;
+}
+
+
+
+void beginHits()
+{
+  uint16_t seqOf[NUM_TABLES];
+  bool found = false;
+  HitRecord record;
+
+  for(uint8_t t = 0; t < NUM_TABLES; t++) { slotOf[t] = HITS_EMPTY; }
+  head = 0;
+  seq = 0;
+  watching = HITS_EMPTY;
+
+  for(uint8_t slot = 0; slot < HITS_SLOTS; slot++)
+  {
+    hitsPortRead(slot, &record);
+    if(!validRecord(&record)) { continue; }
+
+    if(!found || newer(record.seq, seq - 1))
+    {
+      seq = record.seq + 1;
+      head = (slot + 1) % HITS_SLOTS;
+      found = true;
+    }
+    if((slotOf[record.table] == HITS_EMPTY) || newer(record.seq, seqOf[record.table]))
+    {
+      slotOf[record.table] = slot;
+      seqOf[record.table] = record.seq;
+    }
+  }
+}
+
+uint8_t getHits(const IRCode* table, uint8_t* hits)
+{
+  uint8_t t = tableNumber(table);
+  if((t == HITS_EMPTY) || (slotOf[t] == HITS_EMPTY)) { return 0; }
+
+  HitRecord record;
+  readHits(t, &record);
+  uint8_t total = pgm_read_byte(&codeTables[t].total);
+  uint8_t count = 0;
+  for(uint8_t i = 0; i < HITS_DEPTH; i++)
+  {
+    //(a table that's shrunk since leaves indices past its end)
+    if((record.hits[i] != HITS_EMPTY) && (record.hits[i] < total)) { hits[count++] = record.hits[i]; }
+  }
+  return count;
+}
+
+void watchSweep(const IRCode* table)
+{
+  watching = tableNumber(table);
+  latest = 0;
+}
+
+void watchCode(uint8_t index, int ticket)
+{
+  if(watching == HITS_EMPTY) { return; }
+
+  //equipment reacts the first time it sees its code, a sweep going round again tells nothing new
+  uint8_t kept = (latest < HITS_WATCH) ? latest : HITS_WATCH;
+  for(uint8_t i = 0; i < kept; i++)
+  {
+    if(watched[i].index == index) { return; }
+  }
+
+  Watched* w = watched + (latest % HITS_WATCH);
+  w->ticket = ticket;
+  w->index = index;
+  w->done = false;
+  latest++;
+  if(latest == 2 * HITS_WATCH) { latest = HITS_WATCH; } //(only how many are kept matters past here)
+}
+
+void updateHits(unsigned long now)
+{
+  uint8_t kept = (latest < HITS_WATCH) ? latest : HITS_WATCH;
+  for(uint8_t i = 0; i < kept; i++)
+  {
+    Watched* w = watched + i;
+    if(!w->done && (getSendStatus(w->ticket) == SEND_DONE))
+    {
+      w->at = now;
+      w->done = true;
+    }
+  }
+}
+
+void sweepReleased(unsigned long now)
+{
+  if(watching == HITS_EMPTY) { return; }
+
+  //how likely each code is to have been the one, going by how long before the release it finished
+  uint8_t kept = (latest < HITS_WATCH) ? latest : HITS_WATCH;
+  uint8_t likely[HITS_WATCH];
+  bool any = false;
+  for(uint8_t i = 0; i < kept; i++)
+  {
+    unsigned long age = now - watched[i].at;
+    unsigned long off = (age > HITS_REACTION) ? age - HITS_REACTION : HITS_REACTION - age;
+    likely[i] = 0;
+    if(watched[i].done && (off < HITS_SPREAD)) { likely[i] = (HITS_WEIGHT * (HITS_SPREAD - off) + HITS_SPREAD - 1) / HITS_SPREAD; }
+    any |= (likely[i] != 0);
+  }
+  uint8_t table = watching;
+  watching = HITS_EMPTY;
+  if(!any) { return; } //let go before anything could have worked
+
+  HitRecord record;
+  readHits(table, &record);
+
+  //hits that were sent, but too long before (or too soon before) to have been the one, lose half their score
+  for(uint8_t i = 0; i < kept; i++)
+  {
+    if(!watched[i].done || likely[i]) { continue; }
+    for(uint8_t h = 0; h < HITS_DEPTH; h++)
+    {
+      if(record.hits[h] == watched[i].index) { record.scores[h] /= 2; }
+    }
+  }
+
+  //the likeliest first, so they're the ones that find room
+  for(uint8_t score = HITS_WEIGHT; score > 0; score--)
+  {
+    for(uint8_t i = 0; i < kept; i++)
+    {
+      if(likely[i] == score) { scoreHit(&record, watched[i].index, score); }
+    }
+  }
+
+  //halve the scores past HITS_MOST, then put the best first (the earlier of a tie stays first)
+  bool halve = false;
+  for(uint8_t h = 0; h < HITS_DEPTH; h++) { halve |= (record.scores[h] > HITS_MOST); }
+  for(uint8_t h = 0; halve && (h < HITS_DEPTH); h++) { record.scores[h] /= 2; }
+  for(uint8_t h = 1; h < HITS_DEPTH; h++)
+  {
+    for(uint8_t j = h; (j > 0) && (record.scores[j] > record.scores[j - 1]); j--)
+    {
+      uint8_t hit = record.hits[j];
+      uint8_t score = record.scores[j];
+      record.hits[j] = record.hits[j - 1];
+      record.scores[j] = record.scores[j - 1];
+      record.hits[j - 1] = hit;
+      record.scores[j - 1] = score;
+    }
+  }
+
+  writeHits(&record);
+}
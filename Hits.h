@@ -0,0 +1,63 @@
+/*
+ * Written by Brendan Whitfield
+ *
+ */
+
+
+#ifndef HITS_H
+#define HITS_H
+
+#include "Codes.h"
+
+
+#define HITS_DEPTH    4   //codes remembered for each table, sent before the rest of it
+#define HITS_WATCH    16  //latest codes of a sweep kept track of, to find the one that worked
+#define HITS_REACTION 300 //milliseconds the button's likeliest to be let go after the equipment reacts
+#define HITS_SPREAD   200 //how far either side of that it might be
+#define HITS_WEIGHT   4   //score of a code that finished HITS_REACTION before the release (less the further off it is)
+#define HITS_MOST     15  //highest score, every score of the table is halved past it (old hits fade out)
+#define HITS_SLOTS    40  //records in the EEPROM log (each table's latest one counts, writes go round all of them)
+#define HITS_EEPROM   512 //EEPROM address of the first record (past the learned slots, see Learn.h)
+
+#define HITS_EMPTY 0xFF //a table or code that isn't there (erased EEPROM)
+
+//a table's hits, as they're logged to EEPROM
+struct HitRecord
+{
+  uint16_t seq;                //writes to the log before this one (the newest record of a table is the one that counts)
+  uint8_t  table;              //TABLE_ number (see codeTables)
+  uint8_t  hits[HITS_DEPTH];   //indices into the table, best first, HITS_EMPTY after the last
+  uint8_t  scores[HITS_DEPTH]; //how often each of them looked like it worked, lately
+  uint8_t  check;              //CRC-8 of the rest, so a write cut short is passed over
+};
+
+
+/*
+ * Hit cache. Remembers which codes of each table the equipment reacted to, so the next
+ * sweep of the table can send them before the rest. A sweep is watched while its button
+ * is held (the first time each code goes out), and when it's let go, the codes that finished
+ * around HITS_REACTION before are scored, the nearer the more, and hits that finished well
+ * outside of that lose half of theirs. The code that worked is in the running every time,
+ * so it comes out on top over a few presses, where the ones sent along with it don't.
+ * The scores are kept in a log in EEPROM that every write moves along, so no cell
+ * takes more than its share of them.
+ */
+
+void beginHits(); //finds the latest records in EEPROM
+uint8_t getHits(const IRCode* table, uint8_t* hits); //fills hits[HITS_DEPTH] with indices into the table, best first. Returns how many
+
+//watching a sweep (`now` in milliseconds, millis())
+void watchSweep(const IRCode* table);      //a new sweep of `table` started (forgets the last one)
+void watchCode(uint8_t index, int ticket); //a code of it was queued, sendCode()'s ticket
+void updateHits(unsigned long now);        //call from loop(), notes when the codes finish
+void sweepReleased(unsigned long now);     //its button was let go, score what might have worked
+
+
+/*
+ * Port backend. Stores the log.
+ */
+
+void hitsPortRead(uint8_t slot, HitRecord* record);
+void hitsPortWrite(uint8_t slot, const HitRecord* record);
+
+#endif
@@ -0,0 +1,33 @@
+/*
+ * Written by Brendan Whitfield
+ *
+ * ATmega328 port backend for the hit cache. The log lives in the EEPROM, past the learned slots.
+ */
+
+
+
+#ifdef __AVR__
+
+#include <avr/eeprom.h>
+#include "Hits.h"
+#include "Learn.h"
+
+
+static_assert(HITS_EEPROM >= LEARN_EEPROM + (LEARN_SLOTS * sizeof(LearnedCode)), "the hit log runs into the learned slots");
+static_assert(HITS_EEPROM + (HITS_SLOTS * sizeof(HitRecord)) <= E2END + 1, "the hit log doesn't fit in the EEPROM");
+static_assert(HITS_SLOTS > NUM_TABLES, "the hit log needs a slot to spare past one for every table");
+
+
+
+void hitsPortRead(uint8_t slot, HitRecord* record)
+{
+  eeprom_read_block(record, (const void*)(HITS_EEPROM + (slot * sizeof(HitRecord))), sizeof(HitRecord));
+}
+
+void hitsPortWrite(uint8_t slot, const HitRecord* record)
+{
+  //only the bytes that changed are written (a record written again in place is mostly the same)
+  eeprom_update_block(record, (void*)(HITS_EEPROM + (slot * sizeof(HitRecord))), sizeof(HitRecord));
+}
+
+#endif
@@ -5,18 +5,65 @@
 
 
 #include "Codes.h"
+#include "Transmit.h"
+#include "Sweep.h"
+#include "Buttons.h"
+#include "Learn.h"
+#include "Command.h"
+#include "Hits.h"
 
 
 #define OUTPUT_DISPLAY 2 //occupies pins [x, x+9]
-#define INPUT_BANK A2
-#define INPUT_UP A1
-#define INPUT_DOWN A0
-#define CODE_DELAY 8
+//buttons are on A0-A2 (see Buttons.h), the serial commands on pins 0 and 1 (see Command.h)
+
+//what a bank does with its buttons
+#define BANK_HOLD 0 //a held button sweeps its table over and over
+#define BANK_TAP  1 //one sweep per press (toggles like mute, where a second sweep would undo the first)
+#define BANK_LEARNED 2 //a press sends the code learned into the button's slot, holding it learns a new one
+
+#define BANK_LEARN_WAIT 10000 //milliseconds to wait for the other remote while learning
+
+struct Bank
+{
+  const IRCode* up;   //table swept by the UP button (NULL for none)
+  const IRCode* down; //table swept by the DOWN button
+  uint8_t upTotal;   //(or the EEPROM slot, for BANK_LEARNED)
+  uint8_t downTotal;
+  uint8_t mode;
+};
+
+#define BANK(up, down, mode) {up, down, up##_TOTAL, down##_TOTAL, mode}
+#define LEARNED(up, down)    {NULL, NULL, up, down, BANK_LEARNED}
+#define NO_BANK              {NULL, NULL, 0, 0, BANK_HOLD}
+
+//one bank per bar of the display, selected by the bank button in turn
+//(adding a bank is just a matter of filling in a row)
+//against the two switches this replaced, an estimate worked out by hand rather than measured: a few
+//tens of bytes less flash, and about the same cycles a press (the host tools charge loop() a fixed
+//LOOP_CYCLES, so they can't tell the two apart)
+const Bank banks[] PROGMEM = {
+  BANK(POWER_ON, POWER_OFF, BANK_HOLD),             //0: TV power
+  BANK(VOLUME_UP, VOLUME_DOWN, BANK_HOLD),          //1: TV volume
+  BANK(CHANNEL_UP, CHANNEL_DOWN, BANK_HOLD),        //2: TV channel
+  BANK(MUTE, MUTE, BANK_TAP),                       //3: TV mute (either button)
+  NO_BANK,                                          //4
+  NO_BANK,                                          //5
+  LEARNED(0, 1),                                    //6: learned slots 0 (UP) and 1 (DOWN)
+  LEARNED(2, 3),                                    //7: learned slots 2 and 3
+  BANK(PROJ_POWER_ON, PROJ_POWER_OFF, BANK_HOLD),   //8: Sharp projector power on, off/standby
+  BANK(PROJ_VOLUME_UP, PROJ_VOLUME_DOWN, BANK_HOLD) //9: Sharp projector volume
+};
+
+#define NUM_BANKS NUM_ELEM(banks)
+static_assert(NUM_BANKS <= 10, "the display only has 10 bars");
 
 //running vars
 int bankNum = 0; //current code bank (bar graph indicator)
-int lastBank = 0; //old button value (to detect DOWN press)
-int currentCode = 0; //current code to send (incremented every loop())
+int currentCode = 0; //last code sent from the current table (shown on the display)
+const IRCode* sweeping = NULL; //table being swept while its button is held
+bool swept = false; //a BANK_TAP press has had its sweep
+int learning = -1; //slot being learned (the transmitter is off meanwhile)
+unsigned long learnStarted = 0;
 
 void setup()
 {
@@ -26,6 +73,11 @@ void setup()
     pinMode(i, OUTPUT);
   }
   
+  beginTransmit();
+  beginButtons();
+  beginCommands();
+  beginHits();
+  
   //wake-up flash
   for(int i = 19; i >= 0; i--)
   {
@@ -34,108 +86,125 @@ void setup()
   }
 }
 
+//sweeps a table from the top, with the codes that worked before it ahead of the rest
+void startSweep(const IRCode* table, uint8_t total)
+{
+  uint8_t hits[HITS_DEPTH];
+  uint8_t found = getHits(table, hits);
+  beginSweep(table, total);
+  for(uint8_t i = 0; i < found; i++) { sweepFirst(hits[i]); }
+}
+
 void loop()
 {
   //get button values
-  //buttons take so long to analogRead(), no need to debounce
-  int currentBank = readButton(INPUT_BANK);
-  int currentUp = readButton(INPUT_UP);
-  int currentDown = readButton(INPUT_DOWN);
+  updateButtons(millis());
+  bool currentUp = isButtonDown(BUTTON_UP);
+  bool currentDown = isButtonDown(BUTTON_DOWN);
+  //take the events every pass, so an old one can't go off later
+  uint8_t upEvent = getButtonEvent(BUTTON_UP);
+  uint8_t downEvent = getButtonEvent(BUTTON_DOWN);
+  bool bankPressed = (getButtonEvent(BUTTON_BANK) == BUTTON_PRESS);
+  
+  //listening for a code, the bank blinks until one comes in (the bank button gives up)
+  if(learning >= 0)
+  {
+    bool captured = (getLearnStatus() == LEARN_CAPTURED);
+    if(captured || bankPressed || (millis() - learnStarted > BANK_LEARN_WAIT))
+    {
+      if(captured) { storeLearned(learning); }
+      stopLearning();
+      learning = -1;
+      setDisplay(bankNum);
+    }
+    else
+    {
+      setDisplay(((millis() / 250) % 2) ? bankNum : -1);
+    }
+    return;
+  }
+  
+  //serial commands come first, the buttons only send while there are none
+  updateCommands();
+  bool commands = !commandsIdle();
   
   //switch bank when button is DOWN
-  if(currentBank && (!lastBank))
+  if(bankPressed)
   {
     bankNum++;
-    bankNum = bankNum % 10; //wrap
+    bankNum = bankNum % NUM_BANKS; //wrap
     setDisplay(bankNum);
   }
-  lastBank = currentBank;
   
-  //perform action based on button press states
-  if(currentUp && !currentDown)
+  //learned banks send once a press, and start learning on a hold
+  const Bank* bank = banks + bankNum;
+  if(!commands && (pgm_read_byte(&bank->mode) == BANK_LEARNED))
   {
-    switch(bankNum)
+    bool up = (upEvent != BUTTON_NONE);
+    uint8_t event = up ? upEvent : downEvent;
+    uint8_t slot = pgm_read_byte(up ? &bank->upTotal : &bank->downTotal);
+    
+    if(event == BUTTON_PRESS)
     {
-      case 0: //TV power on
-        currentCode = currentCode % POWER_ON_TOTAL;
-        sendCode(POWER_ON + currentCode);
-        break;
-      case 1: //TV volume up
-        currentCode = currentCode % VOLUME_UP_TOTAL;
-        sendCode(VOLUME_UP + currentCode);
-        break;
-      case 2: //TV channel up
-        currentCode = currentCode % CHANNEL_UP_TOTAL;
-        sendCode(CHANNEL_UP + currentCode);
-        break;
-      case 3:
-        break;
-      case 4:
-        break;
-      case 5:
-        break;
-      case 6:
-        break;
-      case 7:
-        break;
-      case 8: //Sharp projector power on
-        currentCode = currentCode % PROJ_POWER_ON_TOTAL;
-        sendCode(PROJ_POWER_ON + currentCode);
-        break;
-      case 9: //Sharp projector volume up
-        currentCode = currentCode % PROJ_VOLUME_UP_TOTAL;
-        sendCode(PROJ_VOLUME_UP + currentCode);
-        break;
+      const IRCode* code = loadLearned(slot);
+      if(code) { sendCode(code, SEND_GAP, CODE_RAM); }
     }
-  }
-  else if(currentDown && !currentUp)
-  {
-    switch(bankNum)
+    else if((event == BUTTON_HOLD) && !isSending())
     {
-      case 0: //TV power off
-        currentCode = currentCode % POWER_OFF_TOTAL;
-        sendCode(POWER_OFF + currentCode);
-        break;
-      case 1: //TV volume down
-        currentCode = currentCode % VOLUME_DOWN_TOTAL;
-        sendCode(VOLUME_DOWN + currentCode);
-        break;
-      case 2: //TV channel down
-        currentCode = currentCode % CHANNEL_DOWN_TOTAL;
-        sendCode(CHANNEL_DOWN + currentCode);
-        break;
-      case 3:
-        break;
-      case 4:
-        break;
-      case 5:
-        break;
-      case 6:
-        break;
-      case 7:
-        break;
-      case 8: //Sharp projector off/standby
-        currentCode = currentCode % PROJ_POWER_OFF_TOTAL;
-        sendCode(PROJ_POWER_OFF + currentCode);
-        break;
-      case 9: //Sharp projector volume down
-        currentCode = currentCode % PROJ_VOLUME_DOWN_TOTAL;
-        sendCode(PROJ_VOLUME_DOWN + currentCode);
-        break;
+      learning = slot;
+      learnStarted = millis();
+      beginLearning();
     }
   }
+  
+  //perform action based on button press states
+  //a held button sweeps its table, codes go out back to back in the background
+  const IRCode* table = NULL;
+  uint8_t total = 0;
+  if((currentUp != currentDown) && !commands)
+  {
+    table = (const IRCode*)pgm_read_ptr(currentUp ? &bank->up : &bank->down);
+    total = pgm_read_byte(currentUp ? &bank->upTotal : &bank->downTotal);
+  }
   else
   {
     currentCode = 0;
     setDisplay(bankNum);
   }
   
-  if(currentDown != currentUp) //XOR (one of the buttons is pressed)
+  //letting go of a sweep, the code the equipment reacted to gets sent first next time
+  updateHits(millis());
+  if(sweeping && (table != sweeping) && !commands) { sweepReleased(millis()); }
+  
+  //a fresh press starts the sweep from the top
+  if(table && (table != sweeping))
   {
-    setDisplay(currentCode % 10);
-    currentCode++;
-    delay(CODE_DELAY);
+    startSweep(table, total);
+    watchSweep(table);
+    swept = false;
   }
+  sweeping = table;
+  
+  if(table && !swept)
+  {
+    const IRCode* sent;
+    int ticket = sweep(&sent);
+    if(ticket == SWEEP_DONE)
+    {
+      //still held, go around again (unless the bank only wants one sweep a press)
+      if(pgm_read_byte(&banks[bankNum].mode) == BANK_TAP) { swept = true; }
+      else { startSweep(table, total); }
+    }
+    else if(ticket != SEND_FULL)
+    {
+      currentCode = sent - table;
+      watchCode(currentCode, ticket);
+      setDisplay(currentCode % 10);
+    }
+  }
+  
+  //nothing left to do until a button changes
+  if(!table && !isSending() && buttonsIdle() && !commands) { buttonPortSleep(); }
   
   //sendCode(POWER_ON + 3);
 }
@@ -143,8 +212,11 @@ void loop()
 
 void setDisplay(int n) //0-9
 {
+  //the transmit interrupt writes PORTB too, don't let it land mid read-modify-write
+  noInterrupts();
   PORTD &= B00000011; //LOW
   PORTB &= B11110000; //LOW
+  interrupts();
   
   //turn on the corresponding pin, if its in the correct range
   if((n >= 0) && (n <= 9))
@@ -152,43 +224,3 @@ void setDisplay(int n) //0-9
     digitalWrite(OUTPUT_DISPLAY + n, HIGH);
   }
 }
-
-int readButton(int pin)
-{
-  int val = analogRead(pin);
-  if(val >= 512) { return 1; }
-  return 0;
-}
-
-
-//function for sending an IR code. Provide pointer to code.
-void sendCode(const IRCode* code)
-{
-  BurstPair* pairs = getCode(code);
-  int length = getLength(code);
-  int carrier = getCarrier(code);
-  
-  for(int i = 0; i < length; i++)
-  {
-    sendBurst(pairs[i], carrier);
-  }
-  
-  delete[] pairs;
-}
-
-void sendBurst(BurstPair pair, uint8_t carrier)
-{
-  //ON portion
-  for(int i = 0; i < pair.on; i++)
-  {
-    PORTB |= B00110000; //HIGH
-    delayMicroseconds(carrier);
-    PORTB &= B11001111; //LOW
-    delayMicroseconds(carrier);
-  }
-  
-  //OFF portion
-  PORTB &= B11001111; //LOW
-  delayMicroseconds(carrier * 2 * pair.off);
-}
-
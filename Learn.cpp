@@ -0,0 +1,278 @@
+/*
+ * Written by Brendan Whitfield
+ *
+ * Learning mode. The port timestamps every edge from the IR receiver, and learnEdge() sorts
+ * them into marks and spaces. A receiver that passes the carrier through gives a run of
+ * pulses per mark, which measures the carrier. A demodulating one gives a single pulse,
+ * and the carrier is taken to be LEARN_CARRIER.
+ * A captured frame is clustered and packed the same way tools/gencodes.py builds the
+ * tables, into a LearnedCode that's kept in EEPROM and loaded into RAM to be sent.
+ * Uses a fixed sizeof(LearnedCode) bytes of RAM, and nothing on the heap. The capture is
+ * kept in the stream ring's RAM (see StreamRam in Pronto.h), there are never both at once.
+ */
+
+
+
+#include "Learn.h"
+#include "Pronto.h"
+#include "Transmit.h"
+
+
+#define MARK_GAP_TICKS ((uint16_t)((uint32_t)LEARN_MARK_GAP * CARRIER_SCALE / LEARN_TICK))
+
+
+
+//capture (written by the port's interrupts while listening)
+static BurstPair* const capture = streamRam.capture; //durations in LEARN_TICKs, then in carrier cycles
+static volatile uint8_t status = LEARN_IDLE;
+static uint8_t count = 0;        //bursts captured
+static bool overflow = false;    //the frame had more than LEARN_BURSTS bursts
+static bool started = false;     //the first mark has been seen
+static uint16_t markStart = 0;
+static uint16_t lastRise = 0;
+static uint16_t lastFall = 0;
+static uint32_t periodSum = 0;   //carrier periods seen inside marks, in LEARN_TICKs
+static uint16_t periods = 0;
+
+//slot being packed, or loaded to be sent
+static LearnedCode learned;
+static IRCode learnedCode = {learned.dict, learned.code, 0, 0, FORMAT_NIBBLES};
+
+
+
+void beginLearning()
+{
+  count = 0;
+  overflow = false;
+  started = false;
+  periodSum = 0;
+  periods = 0;
+  status = LEARN_LISTENING;
+  learnPortBegin();
+}
+
+void stopLearning()
+{
+  learnPortStop();
+  status = LEARN_IDLE;
+}
+
+uint8_t getLearnStatus()
+{
+  return status;
+}
+
+//the mark that started at markStart is over, and the next one starts at `next`
+static void endBurst(uint16_t next)
+{
+  if(count == LEARN_BURSTS)
+  {
+    overflow = true;
+    status = LEARN_CAPTURED;
+    return;
+  }
+
+  capture[count].on = lastFall - markStart;
+  capture[count].off = next - lastFall;
+  count++;
+}
+
+void learnEdge(uint16_t time, uint8_t carrier)
+{
+  if(status != LEARN_LISTENING) { return; }
+
+  if(!carrier)
+  {
+    lastFall = time;
+    return;
+  }
+
+  if(started && ((uint16_t)(time - lastFall) < MARK_GAP_TICKS))
+  {
+    //another pulse of the same mark, the receiver passes the carrier through
+    periodSum += (uint16_t)(time - lastRise);
+    periods++;
+  }
+  else
+  {
+    if(started) { endBurst(time); }
+    markStart = time;
+    started = true;
+  }
+  lastRise = time;
+}
+
+void learnTimeout()
+{
+  if((status != LEARN_LISTENING) || !started) { return; }
+
+  //the last mark has no space after it, sending leaves the code's gap there instead
+  endBurst(lastFall);
+  if(status == LEARN_LISTENING) { status = LEARN_CAPTURED; }
+}
+
+
+
+//capture[] from LEARN_TICKs to cycles of `carrier`
+static void toCycles(uint16_t carrier)
+{
+  uint16_t shortest = 0xFFFF;
+
+  for(uint8_t i = 0; i < count; i++)
+  {
+    uint32_t on = (uint32_t)capture[i].on * LEARN_TICK;
+    uint32_t total = ((uint32_t)capture[i].on + capture[i].off) * LEARN_TICK;
+
+    //with the carrier showing, a mark runs from the first pulse to partway through the last, so count pulses
+    //otherwise take back what the receiver stretched it by
+    uint16_t onCycles = (on / carrier) + 1;
+    if(!periods)
+    {
+      onCycles = (on + (carrier / 2)) / carrier;
+      onCycles = (onCycles > LEARN_STRETCH) ? onCycles - LEARN_STRETCH : 1;
+    }
+    uint16_t cycles = (total + (carrier / 2)) / carrier;
+
+    capture[i].on = onCycles;
+    capture[i].off = (cycles > onCycles) ? cycles - onCycles : 1;
+    if((i < count - 1) && (capture[i].off < shortest)) { shortest = capture[i].off; }
+  }
+
+  //the shortest space stands in for the last one, so it doesn't cost a dictionary entry of its own
+  if(count > 1) { capture[count - 1].off = shortest; }
+}
+
+bool storeLearned(uint8_t slot)
+{
+  if((status != LEARN_CAPTURED) || overflow || (count < 2) || (slot >= LEARN_SLOTS)) { return false; }
+
+  uint16_t carrier = LEARN_CARRIER;
+  if(periods) { carrier = ((periodSum * LEARN_TICK) + (periods / 2)) / periods; }
+
+  toCycles(carrier);
+  uint8_t length = count;
+  count = 0; //capture[] is in cycles now, it can't be stored again
+  if(!packLearned(&learned, capture, length, carrier)) { return false; }
+
+  learnPortWrite(slot, &learned);
+  return true;
+}
+
+const IRCode* loadLearned(uint8_t slot)
+{
+  //the slot is loaded over the one that may still be going out
+  if((slot >= LEARN_SLOTS) || isSending() || (status != LEARN_IDLE)) { return NULL; }
+
+  learnPortRead(slot, &learned);
+
+  //erased EEPROM reads 0xFF
+  if(!learned.length || (learned.length > LEARN_BURSTS) || (learned.dictSize > LEARN_DICT) || !learned.carrier) { return NULL; }
+
+  learnedCode.carrier = learned.carrier;
+  learnedCode.codeLength = learned.length;
+  return &learnedCode;
+}
+
+
+
+/*
+ * Quantizer and packer. Works in place, on durations in carrier cycles.
+ */
+
+static uint16_t* duration(BurstPair* burst, bool off)
+{
+  return off ? &burst->off : &burst->on;
+}
+
+//replaces every on (or off) duration with the count weighted mean of its cluster
+//a cluster spans the durations within `tolerance` percent of its shortest (never less than a cycle), as in tools/gencodes.py
+static void cluster(BurstPair* bursts, uint8_t length, bool off, uint8_t tolerance)
+{
+  uint16_t done = 0; //durations up to here are clustered
+  bool first = true;
+
+  while(true)
+  {
+    //the shortest that isn't
+    uint16_t shortest = 0;
+    bool found = false;
+    for(uint8_t i = 0; i < length; i++)
+    {
+      uint16_t d = *duration(bursts + i, off);
+      if((first || (d > done)) && (!found || (d < shortest)))
+      {
+        shortest = d;
+        found = true;
+      }
+    }
+    if(!found) { return; }
+
+    uint32_t top = shortest + ((uint32_t)shortest * tolerance / 100);
+    if(top == shortest) { top++; }
+    if(top > 0xFFFF) { top = 0xFFFF; }
+
+    uint32_t sum = 0;
+    uint8_t members = 0;
+    for(uint8_t i = 0; i < length; i++)
+    {
+      uint16_t d = *duration(bursts + i, off);
+      if((d >= shortest) && (d <= top)) { sum += d; members++; }
+    }
+
+    uint16_t mean = (sum + (members / 2)) / members;
+    for(uint8_t i = 0; i < length; i++)
+    {
+      uint16_t* d = duration(bursts + i, off);
+      if((*d >= shortest) && (*d <= top)) { *d = mean; }
+    }
+
+    done = top;
+    first = false;
+  }
+}
+
+//fills in the dictionary and the nibbles. False if there are more than LEARN_DICT distinct pairs
+static bool buildCode(LearnedCode* learned, const BurstPair* bursts, uint8_t length)
+{
+  learned->dictSize = 0;
+
+  for(uint8_t i = 0; i < length; i++)
+  {
+    uint8_t index = 0;
+    while((index < learned->dictSize)
+          && ((learned->dict[index].on != bursts[i].on) || (learned->dict[index].off != bursts[i].off))) { index++; }
+
+    if(index == learned->dictSize)
+    {
+      if(index == LEARN_DICT) { return false; }
+      learned->dict[learned->dictSize++] = bursts[i];
+    }
+
+    if(i % 2) { learned->code[i / 2].lo = index; }
+    else
+    {
+      learned->code[i / 2].hi = index;
+      learned->code[i / 2].lo = 0;
+    }
+  }
+  return true;
+}
+
+bool packLearned(LearnedCode* learned, BurstPair* bursts, uint8_t length, uint16_t carrier)
+{
+  if(!length || (length > LEARN_BURSTS)) { return false; }
+
+  //widen the clusters until the dictionary fits
+  for(uint8_t tolerance = LEARN_TOLERANCE; tolerance <= 50; tolerance *= 2)
+  {
+    cluster(bursts, length, false, tolerance);
+    cluster(bursts, length, true, tolerance);
+    if(buildCode(learned, bursts, length))
+    {
+      learned->carrier = carrier;
+      learned->length = length;
+      return true;
+    }
+  }
+  return false;
+}
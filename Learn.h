@@ -0,0 +1,70 @@
+/*
+ * Written by Brendan Whitfield
+ *
+ */
+
+
+#ifndef LEARN_H
+#define LEARN_H
+
+#include "Codes.h"
+
+
+#define LEARN_BURSTS    100   //longest code that can be learned (4 bytes of RAM each, shared with the stream ring)
+#define LEARN_DICT      16    //most distinct burst pairs (indices are nibbles)
+#define LEARN_SLOTS     4     //learned codes kept in EEPROM
+#define LEARN_EEPROM    0     //EEPROM address of the first slot
+#define LEARN_TOLERANCE 3     //percent spread of a duration cluster (widened until the dictionary fits)
+#define LEARN_TIMEOUT   30000 //microseconds of silence that end a frame
+#define LEARN_MARK_GAP  100   //microseconds without a carrier pulse that end a mark
+#define LEARN_CARRIER   421   //carrier assumed when the receiver demodulates (38kHz, in 1/CARRIER_SCALE microseconds)
+#define LEARN_STRETCH   1     //carrier cycles a demodulating receiver adds to each mark (see its datasheet)
+#define LEARN_TICK      8     //capture timestamps, in 1/CARRIER_SCALE microseconds
+
+//states reported by getLearnStatus()
+#define LEARN_IDLE      0
+#define LEARN_LISTENING 1
+#define LEARN_CAPTURED  2 //a frame is waiting for storeLearned()
+
+//a learned code, as it's kept in EEPROM (and in RAM, while it's sent)
+struct LearnedCode
+{
+  uint16_t  carrier;  //1/CARRIER_SCALE microseconds
+  uint8_t   length;   //bursts, 0 (or 0xFF, erased) if the slot is empty
+  uint8_t   dictSize;
+  BurstPair dict[LEARN_DICT];
+  Nibbles   code[LEARN_BURSTS / 2];
+};
+
+
+/*
+ * Learning. Listens on the receiver for one frame, measuring the carrier if the receiver
+ * passes it through, then clusters the durations into a dictionary and packs the indices
+ * into nibbles, just like the tables in Codes.cpp (see tools/gencodes.py).
+ * Takes over the transmit timer while listening, so nothing can be sending.
+ */
+
+void beginLearning();
+void stopLearning(); //gives the timer back to the transmit engine
+uint8_t getLearnStatus();
+bool storeLearned(uint8_t slot); //packs the captured frame into an EEPROM slot. False if it doesn't fit
+const IRCode* loadLearned(uint8_t slot); //send with sendCode(code, gap, CODE_RAM). NULL if the slot is empty, or a learned code is still sending
+
+//the capture, fed by the port's interrupts (`time` in LEARN_TICKs, wrapping)
+void learnEdge(uint16_t time, uint8_t carrier); //receiver changed. `carrier` is 1 if it started seeing carrier
+void learnTimeout(); //no edges for LEARN_TIMEOUT
+
+//durations in carrier cycles to dictionary and nibbles. Rewrites bursts[] with the cluster centres
+bool packLearned(LearnedCode* learned, BurstPair* bursts, uint8_t length, uint16_t carrier);
+
+
+/*
+ * Port backend. Timestamps the receiver's edges, and stores the slots.
+ */
+
+void learnPortBegin(); //call learnEdge() for every edge, and learnTimeout() after LEARN_TIMEOUT of silence
+void learnPortStop();
+void learnPortRead(uint8_t slot, LearnedCode* learned);
+void learnPortWrite(uint8_t slot, const LearnedCode* learned);
+
+#endif
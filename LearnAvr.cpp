@@ -0,0 +1,103 @@
+/*
+ * Written by Brendan Whitfield
+ *
+ * ATmega328 port backend for learning.
+ * The receiver's output goes to A3, which pulls LOW while it sees IR. The input capture pin
+ * (pin 8) is taken by the display, so A3 reaches Timer1's input capture through the analog
+ * comparator instead, compared against the 1.1V bandgap. The comparator borrows the ADC's
+ * input mux, so the ADC is off while listening.
+ * Timer1 runs at clk/8 (a LEARN_TICK is 0.5us), and catches both edges by flipping the edge
+ * it waits for after each one. Its compare units belong to the emitter channels, so Timer2
+ * (restarted by every edge) times the silence at the end of a frame.
+ * The slots live in the EEPROM.
+ */
+
+
+
+#ifdef __AVR__
+
+#include <Arduino.h>
+#include <avr/eeprom.h>
+#include "Learn.h"
+#include "Transmit.h"
+
+
+//Timer2 counts 64us at clk/1024, and the timeout takes a few rounds of up to 256 counts
+#define TIMER2_US      (1024 / (F_CPU / 1000000))
+#define TIMEOUT_ROUNDS ((LEARN_TIMEOUT + (256 * TIMER2_US) - 1) / (256 * TIMER2_US))
+#define TIMEOUT_COUNTS (LEARN_TIMEOUT / (TIMEOUT_ROUNDS * TIMER2_US))
+
+static_assert(LEARN_EEPROM + (LEARN_SLOTS * sizeof(LearnedCode)) <= E2END + 1, "the learned slots don't fit in the EEPROM");
+
+static volatile uint8_t rounds = 0; //of Timer2, since the last edge
+
+
+
+void learnPortBegin()
+{
+  //A3 to the comparator's inverting input, bandgap to the other (output HIGH while the receiver is LOW)
+  ADCSRA &= ~_BV(ADEN);
+  ADCSRB |= _BV(ACME);
+  ADMUX = (ADMUX & 0xF0) | 3;
+  ACSR = _BV(ACBG) | _BV(ACIC);
+
+  TCCR1A = 0;
+  TCCR1B = _BV(ICES1) | _BV(CS11); //rising comparator output (IR starting), clk/8
+  TIFR1 = _BV(ICF1);
+  TIMSK1 = _BV(ICIE1);
+
+  //CTC, started by the first edge
+  TCCR2A = _BV(WGM21);
+  TCCR2B = 0;
+  OCR2A = TIMEOUT_COUNTS - 1;
+  TIMSK2 = _BV(OCIE2A);
+}
+
+void learnPortStop()
+{
+  TIMSK1 = 0;
+  TCCR2B = 0;
+  TIMSK2 = 0;
+  ACSR = 0;
+  ADCSRB &= ~_BV(ACME);
+  ADCSRA |= _BV(ADEN);
+  portBegin(); //the transmit engine gets its timer back
+}
+
+void learnPortRead(uint8_t slot, LearnedCode* learned)
+{
+  eeprom_read_block(learned, (const void*)(LEARN_EEPROM + (slot * sizeof(LearnedCode))), sizeof(LearnedCode));
+}
+
+void learnPortWrite(uint8_t slot, const LearnedCode* learned)
+{
+  //only the bytes that changed are written, it saves wear on the cells
+  eeprom_update_block(learned, (void*)(LEARN_EEPROM + (slot * sizeof(LearnedCode))), sizeof(LearnedCode));
+}
+
+ISR(TIMER1_CAPT_vect)
+{
+  uint16_t time = ICR1;
+  uint8_t rising = TCCR1B & _BV(ICES1);
+
+  //wait for the other edge (changing edges can raise a false capture)
+  TCCR1B ^= _BV(ICES1);
+  TIFR1 = _BV(ICF1);
+
+  //restart the end of frame timeout
+  TCNT2 = 0;
+  rounds = 0;
+  TIFR2 = _BV(OCF2A);
+  TCCR2B = _BV(CS22) | _BV(CS21) | _BV(CS20); //clk/1024
+
+  learnEdge(time, rising);
+}
+
+ISR(TIMER2_COMPA_vect)
+{
+  if(++rounds < TIMEOUT_ROUNDS) { return; }
+  TCCR2B = 0;
+  learnTimeout();
+}
+
+#endif
@@ -0,0 +1,262 @@
+/*
+ * Written by Brendan Whitfield
+ *
+ * Streamed codes. The bytes of a code are parsed as they come in over the serial port,
+ * Pronto hex or compact binary, into burst pairs. The pairs go into a ring of two halves:
+ * the timer plays one half while the serial port fills the other, so a code can be any
+ * length, and only STREAM_PAIRS of it are in RAM at once. Playing only starts once a half
+ * is in. If the ring runs dry anyway, the emitter is held off a carrier cycle at a time
+ * until the next pair comes in, and the stall is counted.
+ */
+
+
+
+#include "Pronto.h"
+
+
+
+//what a byte did to the parser
+#define PARSE_BAD  -1
+#define PARSE_MORE 0
+#define PARSE_PAIR 1 //finished a burst pair
+
+struct Parser
+{
+  uint8_t   format;
+  uint16_t  value;   //value being read
+  uint8_t   digits;  //hex digits of it read (STREAM_PRONTO), or 1 once the first of its two bytes is in (STREAM_BINARY)
+  uint8_t   words;   //Pronto header words read
+  bool      half;    //pair.on is in, pair.off is next
+  BurstPair pair;
+  uint16_t  carrier;
+};
+
+
+
+static Parser parser;
+static IRCode code; //only its carrier is used (see beginCode())
+static bool opened = false;
+static uint32_t pairs = 0;
+static uint32_t bytes = 0;
+
+//the ring (written by loop(), played by the timer). head and tail run freely
+StreamRam streamRam;
+static volatile uint32_t* const ring = streamRam.ring; //BurstUnions, so each pair is written before head moves past it
+static volatile uint8_t head = 0;
+static volatile uint8_t tail = 0;
+static volatile bool ended = false;
+
+//stalls (only touched by the timer while playing)
+static volatile uint16_t underruns = 0;
+static volatile uint16_t starved = 0;
+static bool starving = false;
+
+
+
+//takes a whole value (a header word or half a burst pair)
+static int8_t takeValue(Parser* p, uint16_t value)
+{
+  if((p->format == STREAM_PRONTO) && (p->words < PRONTO_HEADER))
+  {
+    if((p->words == 0) && value) { return PARSE_BAD; } //only learned codes say when the carrier is on
+    if(p->words == 1)
+    {
+      uint32_t carrier = ((uint32_t)value * PRONTO_SCALE + 500) / 1000;
+      if(!value || (carrier > 0xFFFF)) { return PARSE_BAD; }
+      p->carrier = carrier;
+    }
+    p->words++;
+    return PARSE_MORE;
+  }
+
+  if(value > STREAM_LONGEST) { return PARSE_BAD; }
+
+  if(!p->half)
+  {
+    p->pair.on = value;
+    p->half = true;
+    return PARSE_MORE;
+  }
+  if(!p->pair.on && !value) { return PARSE_BAD; } //an empty pair has nothing for the engine to count down
+  p->pair.off = value;
+  p->half = false;
+  return PARSE_PAIR;
+}
+
+static int8_t endWord(Parser* p)
+{
+  uint16_t value = p->value;
+  p->value = 0;
+  p->digits = 0;
+  return takeValue(p, value);
+}
+
+static int8_t parseByte(Parser* p, uint8_t data)
+{
+  if(p->format == STREAM_BINARY)
+  {
+    if(p->digits)
+    {
+      p->digits = 0;
+      return takeValue(p, p->value | data);
+    }
+    if(data & 0x80)
+    {
+      p->value = (uint16_t)(data & 0x7F) << 8;
+      p->digits = 1;
+      return PARSE_MORE;
+    }
+    return takeValue(p, data);
+  }
+
+  //Pronto hex
+  uint8_t digit;
+  uint8_t lower = data | 0x20;
+  if((data >= '0') && (data <= '9'))        { digit = data - '0'; }
+  else if((lower >= 'a') && (lower <= 'f')) { digit = lower - 'a' + 10; }
+  else if((data == ' ') || (data == '\t') || (data == '\r') || (data == '\n')) { return p->digits ? endWord(p) : PARSE_MORE; }
+  else { return PARSE_BAD; }
+
+  if(p->digits == 4) { return PARSE_BAD; }
+  p->value = (p->value << 4) | digit;
+  p->digits++;
+  return PARSE_MORE;
+}
+
+//the end of the stream, which ends the last Pronto word
+static int8_t finish(Parser* p)
+{
+  int8_t got = ((p->format == STREAM_PRONTO) && p->digits) ? endWord(p) : PARSE_MORE;
+  if((got == PARSE_BAD) || p->digits || p->half) { return PARSE_BAD; }
+  if((p->format == STREAM_PRONTO) && (p->words < PRONTO_HEADER)) { return PARSE_BAD; }
+  return got;
+}
+
+//runs bytes through the parser, putting the pairs in the ring if `store`. The number of pairs, -1 if they're malformed
+static int parse(Parser* p, const uint8_t* data, uint8_t length, bool last, bool store)
+{
+  int found = 0;
+  for(uint8_t i = 0; (i < length) || ((i == length) && last); i++)
+  {
+    int8_t got = (i < length) ? parseByte(p, data[i]) : finish(p);
+    if(got == PARSE_BAD) { return -1; }
+    if(got != PARSE_PAIR) { continue; }
+
+    found++;
+    if(store)
+    {
+      BurstUnion b;
+      b.b = p->pair;
+      ring[head % STREAM_PAIRS] = b.i;
+      head = head + 1;
+    }
+  }
+  return found;
+}
+
+
+
+void openStream(uint8_t format, uint16_t carrier)
+{
+  parser.format = format;
+  parser.value = 0;
+  parser.digits = 0;
+  parser.words = 0;
+  parser.half = false;
+  parser.carrier = carrier;
+
+  head = 0;
+  tail = 0;
+  ended = false;
+  pairs = 0;
+  bytes = 0;
+  underruns = 0;
+  starved = 0;
+  starving = false;
+  opened = true;
+}
+
+int checkStream(const uint8_t* data, uint8_t length, bool last)
+{
+  Parser copy = parser;
+  return parse(&copy, data, length, last, false);
+}
+
+uint8_t streamRoom()
+{
+  return STREAM_PAIRS - (uint8_t)(head - tail);
+}
+
+void writeStream(const uint8_t* data, uint8_t length, bool last)
+{
+  pairs += parse(&parser, data, length, last, true);
+  bytes += length;
+  if(last) { ended = true; }
+}
+
+void endStream()
+{
+  ended = true;
+}
+
+bool streamOpen()
+{
+  return opened;
+}
+
+bool streamEnded()
+{
+  return ended;
+}
+
+bool streamReady()
+{
+  return ended || ((uint8_t)(head - tail) >= STREAM_HALF);
+}
+
+const IRCode* streamCode()
+{
+  if(!parser.carrier) { return NULL; }
+  code.carrier = parser.carrier;
+  return &code;
+}
+
+uint8_t streamPlayed()
+{
+  return tail;
+}
+
+void getStreamStats(StreamStats* stats)
+{
+  stats->pairs = pairs;
+  stats->bytes = bytes;
+  stats->underruns = underruns;
+  stats->starved = starved;
+}
+
+void closeStream()
+{
+  opened = false;
+}
+
+bool nextStreamBurst(BurstPair* pair)
+{
+  if(tail != head)
+  {
+    BurstUnion b;
+    b.i = ring[tail % STREAM_PAIRS];
+    *pair = b.b;
+    tail = tail + 1;
+    starving = false;
+    return true;
+  }
+  if(ended) { return false; }
+
+  //ran dry, stay off for a cycle and look again
+  if(!starving) { underruns++; }
+  if(starved != 0xFFFF) { starved++; }
+  starving = true;
+  pair->on = 0;
+  pair->off = 1;
+  return true;
+}
@@ -0,0 +1,67 @@
+/*
+ * Written by Brendan Whitfield
+ *
+ */
+
+
+#ifndef PRONTO_H
+#define PRONTO_H
+
+#include "Codes.h"
+#include "Learn.h"
+
+
+#define STREAM_PAIRS   64    //burst pairs the ring holds, in two halves (4 bytes of RAM each, power of 2)
+#define STREAM_HALF    (STREAM_PAIRS / 2)
+#define STREAM_TIMEOUT 500   //milliseconds a playing stream waits for more before it's ended
+#define STREAM_LONGEST 0x7FFF //longest ON or OFF, in carrier cycles (the engine counts two ticks a cycle in 16 bits)
+
+#define PRONTO_HEADER 4    //words before the first burst pair: 0000, frequency, once pairs, repeat pairs
+#define PRONTO_SCALE  3860 //1000ths of a 1/CARRIER_SCALE microsecond per Pronto frequency unit (0.241246us)
+
+//stream formats
+#define STREAM_PRONTO 0 //Pronto hex, words split by whitespace ("0000 006d 0022 0002 0156 00ad ..."), learned (0000) codes only
+#define STREAM_BINARY 1 //ON, OFF, ON... in carrier cycles. A byte each under 0x80, otherwise two (high byte first, with its top bit set)
+
+//how a stream went, once it's done
+struct StreamStats
+{
+  uint32_t pairs;     //burst pairs played
+  uint32_t bytes;     //bytes of it that came in
+  uint16_t underruns; //times the ring ran dry before the end
+  uint16_t starved;   //carrier cycles the emitter was held off waiting, all told
+};
+
+//RAM the stream ring shares with Learn.cpp's capture. The sketch only starts learning with
+//no commands running, and reads no commands until it's done, so no stream is open meanwhile
+union StreamRam
+{
+  volatile uint32_t ring[STREAM_PAIRS]; //BurstUnions (see Pronto.cpp)
+  BurstPair capture[LEARN_BURSTS];
+};
+
+extern StreamRam streamRam;
+
+
+/*
+ * Streamed codes. A code too long for RAM, or one that's not in the tables, played as it
+ * comes in (see COMMAND_STREAM in Command.h). One stream is open at a time.
+ * Only the parsing is done in loop(), the timer plays the pairs through nextBurst().
+ */
+
+void openStream(uint8_t format, uint16_t carrier); //`carrier` in 1/CARRIER_SCALE microseconds (STREAM_BINARY, a Pronto header has its own)
+int checkStream(const uint8_t* data, uint8_t length, bool last); //burst pairs the bytes complete, -1 if they're malformed (changes nothing)
+uint8_t streamRoom(); //burst pairs there's room for
+void writeStream(const uint8_t* data, uint8_t length, bool last); //the next bytes (check them first). `last` ends the stream
+void endStream();     //ends it early (a pair cut short is dropped)
+bool streamOpen();
+bool streamEnded();
+bool streamReady();   //a half is in, or all of it, and it can start playing
+const IRCode* streamCode(); //the stream, to send as a CODE_STREAM code. NULL if it has no carrier (a Pronto stream that ended before its header was in)
+uint8_t streamPlayed(); //burst pairs played so far (wraps)
+void getStreamStats(StreamStats* stats);
+void closeStream();
+
+bool nextStreamBurst(BurstPair* pair); //nextBurst() of a CODE_STREAM code
+
+#endif
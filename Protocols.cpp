@@ -0,0 +1,135 @@
+/*
+ * Written by Brendan Whitfield
+ *
+ * Protocol encoders. Standard protocols are stored as their payload bits,
+ * and turned back into bursts one at a time as the code is sent.
+ * The per-brand dictionary supplies the exact timing of each symbol,
+ * so a protocol code sends the same bursts as the raw capture it came from.
+ */
+
+
+
+#include "Protocols.h"
+
+
+
+
+static uint8_t getFlags(uint8_t format)
+{
+  return pgm_read_byte(&protocols[format - 1].flags);
+}
+
+static uint8_t getFrame(uint8_t format)
+{
+  return pgm_read_byte(&protocols[format - 1].frame);
+}
+
+static uint8_t payloadBit(const CodeCursor* cursor, uint8_t bit)
+{
+  return (pgm_read_byte((const uint8_t*)cursor->code + (bit >> 3)) >> (bit & 7)) & 1;
+}
+
+
+
+/*
+ * Manchester (bi-phase) protocols. The code is a string of half bits,
+ * and each burst is one run of carrier followed by one run of silence.
+ */
+
+static uint8_t halfBits(uint8_t flags, uint8_t bits)
+{
+  //RC6 adds the leader (8 half bits) and the double width trailer bit (2 more)
+  if(flags & PROTOCOL_RC6_FRAME) { return (bits * 2) + 10; }
+  return bits * 2;
+}
+
+//1 if the carrier is on during half bit `half`
+static uint8_t halfBitLevel(const CodeCursor* cursor, uint8_t flags, uint8_t half)
+{
+  if(flags & PROTOCOL_RC6_FRAME)
+  {
+    //6 half bits of leader, 2 of space, then bits sent as mark-space for "1"
+    if(half < 6) { return 1; }
+    if(half < 8) { return 0; }
+    half -= 8;
+    if(half < 8)  { return payloadBit(cursor, half >> 1) ^ (half & 1); }       //start and mode bits
+    if(half < 12) { return payloadBit(cursor, 4) ^ ((half - 8) >> 1); }        //trailer, twice as wide
+    half -= 12;
+    return payloadBit(cursor, 5 + (half >> 1)) ^ (half & 1);
+  }
+  
+  //RC5 sends "1" as space-mark
+  return payloadBit(cursor, half >> 1) ^ !(half & 1);
+}
+
+static void nextManchesterBurst(CodeCursor* cursor, uint8_t flags, BurstPair* pair)
+{
+  uint8_t total = halfBits(flags, getFrame(cursor->format));
+  uint16_t unit = pgm_read_word(&cursor->dict->on);
+  uint8_t on = 0;
+  uint8_t off = 0;
+  
+  while(cursor->bit < total && halfBitLevel(cursor, flags, cursor->bit))  { on++;  cursor->bit++; }
+  while(cursor->bit < total && !halfBitLevel(cursor, flags, cursor->bit)) { off++; cursor->bit++; }
+  if(!off) { off = 1; } //ended on a mark, leave half a bit of space after it
+                        //(a capture's final space is the gap to its next frame, getProtocolGap() is sent in its place)
+  
+  pair->on = on * unit;
+  pair->off = off * unit;
+}
+
+
+
+uint16_t getProtocolGap(uint8_t format)
+{
+  return pgm_read_word(&protocols[format - 1].gap);
+}
+
+void beginProtocol(CodeCursor* cursor)
+{
+  uint8_t flags = getFlags(cursor->format);
+  uint8_t frame = getFrame(cursor->format);
+  cursor->bit = 0;
+  
+  if(flags & PROTOCOL_MANCHESTER)
+  {
+    //skip the silence before the first mark (RC5's leading start bit)
+    uint8_t total = halfBits(flags, frame);
+    while(cursor->bit < total && !halfBitLevel(cursor, flags, cursor->bit)) { cursor->bit++; }
+    return;
+  }
+  
+  if(!frame) { frame = cursor->length - ((flags & PROTOCOL_LEADER) ? 1 : 0); }
+  cursor->frame = frame;
+}
+
+void nextProtocolBurst(CodeCursor* cursor, BurstPair* pair)
+{
+  uint8_t flags = getFlags(cursor->format);
+  uint8_t symbol;
+  
+  if(flags & PROTOCOL_MANCHESTER)
+  {
+    nextManchesterBurst(cursor, flags, pair);
+    return;
+  }
+  
+  if((flags & PROTOCOL_LEADER) && (cursor->index == 0))
+  {
+    symbol = SYMBOL_EXTRA;
+  }
+  else if((flags & PROTOCOL_STOP) && (--cursor->frame == 0))
+  {
+    //the final stop is a plain zero, any earlier ones carry the gap to the next frame
+    symbol = (cursor->index == cursor->length - 1) ? SYMBOL_ZERO : SYMBOL_EXTRA;
+    cursor->frame = getFrame(cursor->format);
+  }
+  else
+  {
+    symbol = payloadBit(cursor, cursor->bit++);
+  }
+  
+  BurstUnion b;
+  b.i = pgm_read_dword(cursor->dict + symbol);
+  *pair = b.b;
+}
@@ -0,0 +1,71 @@
+/*
+ * Written by Brendan Whitfield
+ *
+ */
+
+
+#ifndef PROTOCOLS_H
+#define PROTOCOLS_H
+
+#include "Codes.h"
+
+
+/*
+ * Protocol IDs, stored in the format field of an IRCode.
+ * The code[] of a protocol code is its payload: the data bits in the order they're sent,
+ * packed LSB first. The dictionary only holds the timing of the protocol's symbols.
+ */
+
+#define PROTOCOL_NEC        1 //leader, 32 bits, stop
+#define PROTOCOL_SIRC       2 //leader, 12/15/20 bits
+#define PROTOCOL_KASEIKYO   3 //leader, 48 bits, stop
+#define PROTOCOL_JVC        4 //leader, 16 bits, stop
+#define PROTOCOL_SHARP      5 //15 bits and a stop per frame, frames separated by a long stop
+#define PROTOCOL_MITSUBISHI 6 //16 bits, stop
+#define PROTOCOL_RC5        7 //manchester, 14 bits
+#define PROTOCOL_RC6        8 //leader, manchester, 21 bits (mode 0: start, mode, trailer, address, command)
+
+//dictionary layout of pulse protocols
+#define SYMBOL_ZERO  0
+#define SYMBOL_ONE   1
+#define SYMBOL_EXTRA 2 //leader, or the stop that ends a frame when more follow
+//manchester protocols only use dict[0].on, the length of half a bit
+
+
+/*
+ * Protocol descriptions. Read from flash by the encoders, and at compile time
+ * by the checks in CodeCheck.h.
+ */
+
+#define PROTOCOL_LEADER     0x01 //first burst is SYMBOL_EXTRA
+#define PROTOCOL_STOP       0x02 //last burst of each frame is a stop bit
+#define PROTOCOL_MANCHESTER 0x04 //bursts are built from half bits
+#define PROTOCOL_RC6_FRAME  0x08 //RC6 leader, phase and trailer bit (manchester only)
+
+struct Protocol
+{
+  uint8_t  flags;
+  uint8_t  frame; //bursts per frame (not counting the leader), 0 for the whole code. Bits per frame if manchester
+  uint16_t gap;   //microseconds of silence a receiver needs to see the code has ended
+};
+
+//indexed by protocol ID - 1
+//gaps are about 10 units of the protocol, comfortably longer than any space inside a frame
+constexpr Protocol protocols[] PROGMEM = {
+  {PROTOCOL_LEADER | PROTOCOL_STOP, 0, 5600}, //NEC
+  {PROTOCOL_LEADER, 0, 6000},                 //SIRC
+  {PROTOCOL_LEADER | PROTOCOL_STOP, 0, 4400}, //Kaseikyo
+  {PROTOCOL_LEADER | PROTOCOL_STOP, 0, 5300}, //JVC
+  {PROTOCOL_STOP, 16, 5000},                  //Sharp
+  {PROTOCOL_STOP, 0, 4200},                   //Mitsubishi
+  {PROTOCOL_MANCHESTER, 14, 5400},            //RC5
+  {PROTOCOL_MANCHESTER | PROTOCOL_RC6_FRAME, 21, 2700} //RC6
+};
+
+
+uint16_t getProtocolGap(uint8_t format); //microseconds of silence needed after a code
+
+void beginProtocol(CodeCursor* cursor);
+void nextProtocolBurst(CodeCursor* cursor, BurstPair* pair);
+
+#endif
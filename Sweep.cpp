@@ -0,0 +1,143 @@
+/*
+ * Written by Brendan Whitfield
+ *
+ * Sweep scheduler. Sends every code of one or more tables back to back.
+ * Codes are grouped by carrier, so the timer is only set up once per group, and each one
+ * is followed by just the gap its protocol needs (SEND_GAP for raw codes).
+ * The codes are dealt out to the emitter channels in turn, so with two channels two codes
+ * go out at once, and a sweep takes about half as long.
+ * Call sweep() from loop(). It tops up the send queues, so the emitters never sit idle
+ * as long as loop() comes around at least once per code.
+ * Codes put first with sweepFirst() go out ahead of the groups, in the order they were
+ * given, whatever their carrier.
+ */
+
+
+
+#include "Sweep.h"
+#include "Protocols.h"
+
+
+
+static const IRCode* tables[SWEEP_TABLES];
+static uint8_t totals[SWEEP_TABLES];
+static uint8_t count = 0; //tables in the sweep
+static uint8_t size = 0;  //codes in the sweep, over all of its tables
+static uint8_t first = 0; //position of the first code of the carrier group being sent
+static uint8_t next = 0;  //position to look for the group's next code from
+static uint8_t channels = 1; //emitters the sweep is shared out over
+static uint8_t turn = 0;     //channel that gets the next code, if it has room
+static uint8_t firsts[SWEEP_FIRST]; //positions of the codes that go ahead of the rest
+static uint8_t firstCount = 0;
+static uint8_t firstSent = 0;
+
+
+
+//code number `position` of the sweep, counting through the tables in order
+static const IRCode* codeAt(uint8_t position)
+{
+  uint8_t t = 0;
+  while(position >= totals[t]) { position -= totals[t++]; }
+  return tables[t] + position;
+}
+
+//true if no earlier code uses the same carrier (the code starts a group)
+static bool startsGroup(uint8_t position)
+{
+  int carrier = getCarrier(codeAt(position));
+  for(uint8_t i = 0; i < position; i++)
+  {
+    if(getCarrier(codeAt(i)) == carrier) { return false; }
+  }
+  return true;
+}
+
+//true if the code at `position` goes ahead of the rest
+static bool isFirst(uint8_t position)
+{
+  for(uint8_t i = 0; i < firstCount; i++)
+  {
+    if(firsts[i] == position) { return true; }
+  }
+  return false;
+}
+
+void beginSweep(const IRCode* table, uint8_t total, uint8_t channelCount)
+{
+  channels = (channelCount && (channelCount <= SEND_CHANNELS)) ? channelCount : SEND_CHANNELS;
+  turn = 0;
+  count = 0;
+  size = 0;
+  first = 0;
+  next = 0;
+  firstCount = 0;
+  firstSent = 0;
+  addToSweep(table, total);
+}
+
+bool addToSweep(const IRCode* table, uint8_t total)
+{
+  if((count >= SWEEP_TABLES) || (size + total > SWEEP_CODES)) { return false; } //(size would wrap)
+
+  tables[count] = table;
+  totals[count] = total;
+  count++;
+  size += total;
+  return true;
+}
+
+bool sweepFirst(uint8_t position)
+{
+  if((firstCount >= SWEEP_FIRST) || (position >= size) || isFirst(position)) { return false; }
+
+  firsts[firstCount++] = position;
+  return true;
+}
+
+//queues the sweep's next code, see sweep()
+static int sweepOne(const IRCode** sent)
+{
+  if(first >= size) { return SWEEP_DONE; }
+
+  //the codes put first, then the next code of the current group, or else the next group
+  bool early = (firstSent < firstCount);
+  if(!early)
+  {
+    int carrier = getCarrier(codeAt(first));
+    for(;;)
+    {
+      while(next < size && (getCarrier(codeAt(next)) != carrier || isFirst(next))) { next++; }
+      if(next < size) { break; }
+      do { first++; } while(first < size && !startsGroup(first));
+      if(first >= size) { return SWEEP_DONE; }
+      carrier = getCarrier(codeAt(first));
+      next = first;
+    }
+  }
+
+  const IRCode* code = codeAt(early ? firsts[firstSent] : next);
+  uint8_t format = getFormat(code);
+  uint16_t gap = IS_PROTOCOL(format) ? getProtocolGap(format) : SEND_GAP;
+
+  //whichever channel's turn it is, or the next one along with room
+  int ticket = SEND_FULL;
+  for(uint8_t tries = 0; (tries < channels) && (ticket == SEND_FULL); tries++)
+  {
+    ticket = sendCode(code, gap, CODE_FLASH, turn);
+    turn = (turn + 1) % channels;
+  }
+  if(ticket == SEND_FULL) { return SEND_FULL; }
+
+  if(early) { firstSent++; }
+  else { next++; }
+  if(sent) { *sent = code; }
+  return ticket;
+}
+
+int sweep(const IRCode** sent)
+{
+  //a code with no carrier is passed over, it's never going to go
+  int ticket;
+  do { ticket = sweepOne(sent); } while(ticket == SEND_BAD);
+  return ticket;
+}
@@ -0,0 +1,25 @@
+/*
+ * Written by Brendan Whitfield
+ *
+ */
+
+
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include "Transmit.h"
+
+
+#define SWEEP_TABLES 4 //most tables one sweep can cover
+#define SWEEP_CODES  255 //most codes one sweep can cover, over all of its tables (positions are a byte)
+#define SWEEP_FIRST  4 //most codes sweepFirst() can put ahead of the rest
+#define SWEEP_DONE  -2 //returned by sweep() once every code has been queued (unlike any sendCode() return value)
+
+
+//sweep scheduler (sends whole tables back to back, see Sweep.cpp)
+void beginSweep(const IRCode* table, uint8_t total, uint8_t channels = SEND_CHANNELS); //codes are shared out over the first `channels` emitters
+bool addToSweep(const IRCode* table, uint8_t total); //more tables for the same sweep. False if there's no room (SWEEP_TABLES, or SWEEP_CODES)
+bool sweepFirst(uint8_t position); //sends code number `position` of the sweep (counting through its tables) ahead of the rest, and not again. False if there's no room
+int sweep(const IRCode** sent); //queues the next code if there's room. Returns its ticket, SEND_FULL or SWEEP_DONE (codes sendCode() turns away are skipped)
+
+#endif
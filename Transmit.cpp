@@ -0,0 +1,166 @@
+/*
+ * Written by Brendan Whitfield
+ *
+ * Background transmit engine.
+ * sendCode() only queues a code. The port's timer calls transmitTick() at the start of
+ * the HIGH and the LOW part of each carrier cycle, and each tick toggles the emitters or
+ * counts down an OFF period. Bursts are decoded from flash one at a time as they're needed.
+ * Each tick hands the port the level for the next one to put out, so every edge comes the
+ * same few cycles after its interrupt, however long the decoding takes.
+ * Every channel is a copy of all of this, ticked by a timer of its own, so each emitter
+ * can be sending a different code on a different carrier.
+ */
+
+
+
+#include "Transmit.h"
+
+
+
+//one emitter's queue, and the code it's sending
+struct Channel
+{
+  //queue of codes to send (written by sendCode(), read by the timer)
+  //head and tail run freely and double as ticket numbers
+  //(sendCode() does the divides a code needs, so the timer only copies them)
+  const IRCode* volatile queue[SEND_QUEUE_SIZE];
+  volatile uint16_t gaps[SEND_QUEUE_SIZE];  //ticks of silence after each queued code
+  volatile uint8_t spaces[SEND_QUEUE_SIZE]; //where each queued code lives (CODE_FLASH or CODE_RAM)
+  volatile uint16_t highs[SEND_QUEUE_SIZE]; //timer counts of each queued code's carrier (see CarrierParts)
+  volatile uint16_t lows[SEND_QUEUE_SIZE];
+  volatile uint8_t head;    //tickets handed out
+  volatile uint8_t tail;    //tickets finished
+  volatile bool running;
+
+  //state of the code currently going out (only touched by the timer once running)
+  CodeCursor cursor;
+  bool active;       //cursor holds a code (false during the trailing gap)
+  uint16_t carrier;  //carrier the timer is running at (0 if stopped)
+  uint16_t gap;      //ticks
+  uint16_t onTicks;  //ticks left in the ON portion
+  uint16_t offTicks; //ticks left in the OFF portion
+};
+
+static Channel channels[SEND_CHANNELS];
+
+
+
+void beginTransmit()
+{
+  portBegin();
+  for(uint8_t i = 0; i < SEND_CHANNELS; i++) { portEmit(i, 0); }
+}
+
+//queues a code for transmission. Provide pointer to code, the silence to leave after it, where it lives, and the emitter.
+//a CODE_RAM or CODE_STREAM code has to stay put until it's sent
+int sendCode(const IRCode* code, uint16_t gap, uint8_t space, uint8_t channel)
+{
+  Channel* c = channels + channel;
+  uint16_t carrier = (space == CODE_FLASH) ? getCarrier(code) : code->carrier;
+  if(!carrier) { return SEND_BAD; } //(no cycles to count its bursts in, and the timer would never get past one)
+  if((uint8_t)(c->head - c->tail) >= SEND_QUEUE_SIZE) { return SEND_FULL; }
+
+  CarrierParts parts = portCarrier(carrier);
+
+  uint8_t ticket = c->head;
+  c->queue[ticket % SEND_QUEUE_SIZE] = code;
+  c->gaps[ticket % SEND_QUEUE_SIZE] = ((uint32_t)gap * CARRIER_SCALE / carrier) * 2;
+  c->spaces[ticket % SEND_QUEUE_SIZE] = space;
+  c->highs[ticket % SEND_QUEUE_SIZE] = parts.high;
+  c->lows[ticket % SEND_QUEUE_SIZE] = parts.low;
+  c->head = ticket + 1;
+
+  //the timer stops itself when it runs dry, kick it back into action
+  if(!c->running)
+  {
+    c->running = true;
+    portStart(channel, parts);
+  }
+
+  return ((int)channel << 8) | ticket;
+}
+
+uint8_t getSendStatus(int ticket)
+{
+  const Channel* c = channels + SEND_CHANNEL(ticket);
+  uint8_t ahead = (uint8_t)ticket - c->tail; //codes to finish before this one does
+  if(ahead >= SEND_QUEUE_SIZE) { return SEND_DONE; } //ticket is behind the tail
+  if(ahead == 0 && c->active)  { return SEND_ACTIVE; }
+  return SEND_QUEUED;
+}
+
+bool isSending()
+{
+  for(uint8_t i = 0; i < SEND_CHANNELS; i++)
+  {
+    if(channels[i].running) { return true; }
+  }
+  return false;
+}
+
+
+
+//sets up onTicks/offTicks for the channel's next slice of output. Returns false once there's nothing left
+static bool loadNext(uint8_t channel)
+{
+  Channel* c = channels + channel;
+  BurstPair pair;
+
+  if(c->active)
+  {
+    while(nextBurst(&c->cursor, &pair))
+    {
+      //an empty pair (a bad dictionary entry) is skipped, counting it down would wrap offTicks
+      if(!pair.on && !pair.off) { continue; }
+      c->onTicks = pair.on * 2;
+      c->offTicks = pair.off * 2;
+      return true;
+    }
+
+    //code finished, trail it with a gap so the receiver sees separate frames
+    c->active = false;
+    c->tail = c->tail + 1;
+    c->offTicks = c->gap;
+    if(c->offTicks) { return true; }
+  }
+
+  if(c->head == c->tail)
+  {
+    portStop(channel);
+    c->carrier = 0;
+    c->running = false;
+    return false;
+  }
+
+  //start on the next queued code
+  beginCode(&c->cursor, c->queue[c->tail % SEND_QUEUE_SIZE], c->spaces[c->tail % SEND_QUEUE_SIZE]);
+  c->gap = c->gaps[c->tail % SEND_QUEUE_SIZE];
+
+  //a code on the carrier that's already running just carries on
+  //(every code and gap is a whole number of cycles, so the timer is still in step)
+  if(c->cursor.carrier != c->carrier)
+  {
+    CarrierParts parts = {c->highs[c->tail % SEND_QUEUE_SIZE], c->lows[c->tail % SEND_QUEUE_SIZE]};
+    c->carrier = c->cursor.carrier;
+    portStart(channel, parts);
+  }
+  c->active = true;
+  return loadNext(channel);
+}
+
+int8_t transmitTick(uint8_t channel)
+{
+  Channel* c = channels + channel;
+  if(!c->onTicks && !c->offTicks && !loadNext(channel)) { return -1; }
+
+  if(c->onTicks)
+  {
+    //starts HIGH, ends LOW
+    int8_t level = !(c->onTicks & 1);
+    c->onTicks--;
+    return level;
+  }
+
+  c->offTicks--;
+  return -1;
+}
@@ -0,0 +1,65 @@
+/*
+ * Written by Brendan Whitfield
+ *
+ */
+
+
+#ifndef TRANSMIT_H
+#define TRANSMIT_H
+
+#include "Codes.h"
+
+
+#define SEND_CHANNELS 2    //emitters, each sending codes of its own (channel 0 on pin 12, 1 on pin 13)
+#define SEND_QUEUE_SIZE 2  //codes waiting to go out on each channel (power of 2)
+#define SEND_GAP 8000      //microseconds of silence after each code
+#define SEND_DUTY 50       //percent of each carrier cycle the emitters are lit (33 for a 1/3 duty cycle)
+
+//return values of sendCode() when the queue has no room, and when the code has no carrier (it's not queued)
+#define SEND_FULL -1
+#define SEND_BAD  -3 //(-2 is SWEEP_DONE, see Sweep.h)
+
+//channel a ticket was sent on
+#define SEND_CHANNEL(ticket) ((uint8_t)((ticket) >> 8))
+
+//states reported by getSendStatus()
+#define SEND_QUEUED 0
+#define SEND_ACTIVE 1
+#define SEND_DONE   2
+
+
+//transmit engine (codes are sent in the background, by the port's timer)
+//every channel has its own queue and carrier, so two codes can go out at once
+void beginTransmit();
+int sendCode(const IRCode* code, uint16_t gap = SEND_GAP, uint8_t space = CODE_FLASH, uint8_t channel = 0); //returns a ticket for getSendStatus(), SEND_FULL or SEND_BAD. `gap` in microseconds
+uint8_t getSendStatus(int ticket);
+bool isSending(); //true while any channel is
+int8_t transmitTick(uint8_t channel); //called by the port at the start of the HIGH and the LOW part of each of the channel's carrier cycles
+                                      //returns the level to put out first thing at the next one (-1 leaves the emitter alone)
+
+
+/*
+ * Port backend. Generates the timing and drives the emitters.
+ * The engine only ever talks to the hardware through these, so it can be linked against
+ * something other than the real timer: TransmitAvr.cpp is Timer1 on the board,
+ * host/TransmitSim.cpp a simulated timer for the host tools.
+ * Each channel keeps time on its own, and puts out its level before the other one's
+ * interrupt can hold it up.
+ * A carrier's timer counts are worked out by portCarrier() when its code is queued, as
+ * portStart() can be called from the timer's interrupt, which has no time for the divides.
+ */
+
+//timer counts of the HIGH and the LOW part of a carrier cycle
+struct CarrierParts
+{
+  uint16_t high;
+  uint16_t low;
+};
+
+void portBegin();                                     //configure pins and timer (left stopped)
+CarrierParts portCarrier(uint16_t carrier);           //split a carrier period (see IRCode) by SEND_DUTY
+void portStart(uint8_t channel, CarrierParts parts);  //call transmitTick(channel) at the start of each part
+void portStop(uint8_t channel);                       //stop calling transmitTick(channel)
+void portEmit(uint8_t channel, uint8_t on);           //drive the channel's emitter LED
+
+#endif
@@ -0,0 +1,134 @@
+/*
+ * Written by Brendan Whitfield
+ *
+ * ATmega328 port backend for the transmit engine.
+ * Timer1 free runs straight off the cpu clock, and each channel has a compare unit of its
+ * own (A for channel 0, B for channel 1), so a carrier period is timed to the cycle
+ * (0.06us at 16MHz) on both. Each interrupt moves its compare value on by the length of
+ * the part that just started, alternating between the HIGH and the LOW part of a cycle,
+ * which is what sets the duty cycle (SEND_DUTY). Being counted from the last match rather
+ * than from when the interrupt ran, a channel held up by the other one's interrupt is
+ * late for one edge, but never drifts. And it's only held up for the few cycles it takes
+ * the other to put out its level, as the rest of each interrupt (the decoding) lets the
+ * other channel's in. A channel's own interrupt stays masked until it's done, so one that
+ * runs past its part is late for the next edge, rather than nesting.
+ * The emitters sit on pins 12 and 13, which have no PWM output, so the interrupts
+ * toggle them by hand. Timer1 is the Servo library's timer, and PWM on pins 9 and 10 is lost.
+ */
+
+
+
+#ifdef __AVR__
+
+#include <Arduino.h>
+#include <util/atomic.h>
+#include "Transmit.h"
+
+
+
+static uint16_t part[SEND_CHANNELS][2];       //timer counts of the HIGH and the LOW part of a cycle
+static volatile uint8_t phase[SEND_CHANNELS]; //part that starts at the next interrupt
+static int8_t level[SEND_CHANNELS];           //what the next interrupt puts out (from transmitTick())
+static volatile uint8_t armed;                //compare interrupts of the running channels (OCIE1A, OCIE1B)
+static volatile uint8_t ticking;              //of them, the ones inside transmitTick() (masked till they're out)
+
+
+
+void portBegin()
+{
+  TCCR1A = 0;
+  TCCR1B = 0;          //stopped
+  TIMSK1 = 0;
+  armed = 0;
+  ticking = 0;
+}
+
+CarrierParts portCarrier(uint16_t carrier)
+{
+  uint16_t cycles = ((uint32_t)carrier * (F_CPU / 1000000)) / CARRIER_SCALE;
+  uint16_t high = ((uint32_t)cycles * SEND_DUTY + 50) / 100;
+  CarrierParts parts = {high, (uint16_t)(cycles - high)};
+  return parts;
+}
+
+void portStart(uint8_t channel, CarrierParts parts)
+{
+  uint8_t enable = channel ? _BV(OCIE1B) : _BV(OCIE1A);
+
+  //called from either channel's interrupt as well as from loop()
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    part[channel][0] = parts.high;
+    part[channel][1] = parts.low;
+    phase[channel] = 0;
+    level[channel] = -1;
+
+    if(!TCCR1B)
+    {
+      TCNT1 = 0;
+      TCCR1B = _BV(CS10); //normal mode, clk/1
+    }
+
+    //the wait for the first interrupt counts as a LOW part
+    uint16_t first = TCNT1 + part[channel][1];
+    if(channel) { OCR1B = first; TIFR1 = _BV(OCF1B); } //drop any stale match
+    else        { OCR1A = first; TIFR1 = _BV(OCF1A); }
+    armed |= enable;
+    TIMSK1 = armed & ~ticking;
+  }
+}
+
+void portStop(uint8_t channel)
+{
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    armed &= channel ? ~_BV(OCIE1B) : ~_BV(OCIE1A);
+    TIMSK1 = armed & ~ticking;
+    if(!armed) { TCCR1B = 0; } //last one out stops the timer
+    portEmit(channel, 0);
+  }
+}
+
+void portEmit(uint8_t channel, uint8_t on)
+{
+  uint8_t pin = channel ? B00100000 : B00010000;
+  if(on) { PORTB |= pin; }  //HIGH
+  else   { PORTB &= ~pin; } //LOW
+}
+
+//runs transmitTick() with interrupts back on, so the other channel can cut in. The channel's
+//own interrupt is masked till it's done: a decode (or the other channel) can take longer than
+//a part, and its next match would have it nesting. That match is kept (OCF1x), and runs late
+static inline void tickOpen(uint8_t channel, uint8_t enable)
+{
+  ticking |= enable;
+  TIMSK1 = armed & ~ticking;
+  sei();
+  int8_t next = transmitTick(channel);
+  cli();
+  level[channel] = next;
+  ticking &= ~enable;
+  TIMSK1 = armed & ~ticking; //(not if transmitTick() stopped the channel)
+}
+
+ISR(TIMER1_COMPA_vect)
+{
+  //the next match and the level go before anything else
+  //(the counter keeps running, so the shortest part must outlast this much of the interrupt)
+  OCR1A += part[0][phase[0]];
+  phase[0] ^= 1;
+  if(level[0] >= 0) { portEmit(0, level[0]); }
+
+  tickOpen(0, _BV(OCIE1A));
+}
+
+ISR(TIMER1_COMPB_vect)
+{
+  OCR1B += part[1][phase[1]];
+  phase[1] ^= 1;
+  if(level[1] >= 0) { portEmit(1, level[1]); }
+
+  tickOpen(1, _BV(OCIE1B));
+}
+
+#endif
@@ -0,0 +1,70 @@
+/*
+ * Written by Brendan Whitfield
+ *
+ * Stand-in for the parts of the Arduino core the sketch uses, so IR_Transmit.ino builds on a PC.
+ * Every call moves the TransmitSim.cpp clock on by about what it costs on a 16MHz ATmega328,
+ * so loop() takes roughly as long as it would on the board.
+ */
+
+
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <avr/pgmspace.h>
+#include "TransmitSim.h"
+#include "ButtonsSim.h"
+
+
+#define HIGH   1
+#define LOW    0
+#define INPUT  0
+#define OUTPUT 1
+
+#define A0 14
+#define A1 15
+#define A2 16
+
+#define B00000011 0x03
+#define B11110000 0xF0
+
+//cpu cycles taken by each call
+#define SIM_DIGITAL_WRITE 70   //pin lookup tables in flash, then a read-modify-write
+#define SIM_ANALOG_READ   1720 //13 ADC clocks at clk/128, plus the call
+#define SIM_MILLIS        30
+
+//display pins, written straight to the ports (defined in ButtonsSim.cpp, which every sketch build links)
+extern uint8_t PORTB;
+extern uint8_t PORTD;
+
+inline void noInterrupts() {}
+inline void interrupts() {}
+
+inline void pinMode(uint8_t, uint8_t) {}
+
+inline void digitalWrite(uint8_t, uint8_t)
+{
+  simRun(simNow() + SIM_DIGITAL_WRITE);
+}
+
+//the buttons, read the slow way (pins A0-A2, in BUTTON_* order)
+inline int analogRead(uint8_t pin)
+{
+  int value = (simButtonPins() & (1 << (pin - A0))) ? 1023 : 0;
+  simRun(simNow() + SIM_ANALOG_READ);
+  return value;
+}
+
+inline unsigned long millis()
+{
+  simRun(simNow() + SIM_MILLIS);
+  return simNow() / (SIM_F_CPU / 1000);
+}
+
+inline void delay(unsigned long ms)
+{
+  simRun(simNow() + (ms * (SIM_F_CPU / 1000)));
+}
+
+#endif
@@ -0,0 +1,97 @@
+/*
+ * Written by Brendan Whitfield
+ *
+ * Simulated port backend for the buttons.
+ * Stands in for ButtonsAvr.cpp on a PC. The pins are scripted with simSetButtons(), and
+ * buttonPortSleep() skips the clock ahead to the change that would wake the real cpu,
+ * or the start of a byte on the serial port (see CommandSim.h).
+ * simAnalogButtons() puts back the old way of reading them, for comparison: an analogRead()
+ * of each pin every pass of loop(), and no sleep.
+ */
+
+
+
+#include <map>
+#include "Arduino.h"
+#include "ButtonsSim.h"
+#include "TransmitSim.h"
+#include "CommandSim.h"
+
+
+
+uint8_t PORTB = 0; //(see Arduino.h)
+uint8_t PORTD = 0;
+
+static std::map<uint64_t, uint8_t> script; //pin changes, by time
+static uint32_t sleeps = 0;
+static uint64_t slept = 0;
+static bool analog = false;
+
+
+
+void simSetButtons(uint64_t at, uint8_t pins)
+{
+  script[at] = pins;
+}
+
+uint8_t simButtonPins()
+{
+  std::map<uint64_t, uint8_t>::iterator change = script.upper_bound(simNow());
+  if(change == script.begin()) { return 0; }
+  return (--change)->second;
+}
+
+uint32_t simSleeps()
+{
+  return sleeps;
+}
+
+uint64_t simSlept()
+{
+  return slept;
+}
+
+void simAnalogButtons(bool on)
+{
+  analog = on;
+}
+
+
+
+void buttonPortBegin()
+{
+}
+
+uint8_t buttonPortRead()
+{
+  if(analog)
+  {
+    //bank, up, down, each pressed from half way up the ADC's range
+    uint8_t pins = 0;
+    for(int8_t i = BUTTON_COUNT - 1; i >= 0; i--)
+    {
+      if(analogRead(A0 + i) >= 512) { pins |= 1 << i; }
+    }
+    return pins;
+  }
+
+  simRun(simNow() + 1); //a single `in` instruction
+  return simButtonPins();
+}
+
+void buttonPortSleep()
+{
+  if(analog || simButtonPins()) { return; }
+
+  //nothing scripted would ever wake it, carry on rather than sleep forever
+  std::map<uint64_t, uint8_t>::iterator change = script.upper_bound(simNow());
+  uint64_t wake = (change == script.end()) ? UINT64_MAX : change->first;
+  if(simSerialNext() < wake) { wake = simSerialNext(); }
+  if(wake == UINT64_MAX) { return; }
+  if(wake < simNow()) { wake = simNow(); }
+
+  //the timers stop in standby, the caller made sure nothing is sending
+  sleeps++;
+  slept += wake - simNow();
+  simRun(wake + SIM_WAKE_CYCLES);
+}
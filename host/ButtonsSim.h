@@ -0,0 +1,28 @@
+/*
+ * Written by Brendan Whitfield
+ *
+ */
+
+
+#ifndef BUTTONS_SIM_H
+#define BUTTONS_SIM_H
+
+#include <stdint.h>
+#include "Buttons.h"
+
+
+#define SIM_WAKE_CYCLES 6 //cpu cycles to wake from standby (the oscillator keeps running)
+
+
+/*
+ * Simulated port backend for the buttons. The pins follow a script of changes,
+ * timed on the TransmitSim.cpp clock, and sleeping jumps the clock to the next change.
+ */
+
+void simSetButtons(uint64_t at, uint8_t pins); //from cpu cycle `at` on, the pins read `pins` (bit per BUTTON_*)
+uint8_t simButtonPins(); //what the pins read now
+uint32_t simSleeps();    //times the cpu went to sleep
+uint64_t simSlept();     //cpu cycles spent asleep
+void simAnalogButtons(bool analog); //read the pins with analogRead(), the way the sketch did before Buttons.cpp, and never sleep
+
+#endif
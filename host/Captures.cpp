@@ -0,0 +1,106 @@
+/*
+ * Written by Brendan Whitfield
+ *
+ * Capture reader and error handling shared by the host tools. Every capture a tool reads
+ * goes through the same checks, as tools/gencodes.py does them: a learned code (0000), a
+ * carrier, and as many burst pairs as its header says.
+ */
+
+
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "Captures.h"
+
+
+
+static int failed = 0;
+
+
+
+void fail(const char* format, ...)
+{
+  va_list args;
+  va_start(args, format);
+  fprintf(stderr, "%s: ", toolName);
+  vfprintf(stderr, format, args);
+  fprintf(stderr, "\n");
+  va_end(args);
+  exit(2);
+}
+
+void check(bool ok, const char* what)
+{
+  if(!ok)
+  {
+    printf("  FAILED: %s\n", what);
+    failed++;
+  }
+}
+
+int failures()
+{
+  return failed;
+}
+
+//the words of a "key=..." line's code, checked
+static std::vector<uint16_t> parsePronto(const char* text, const std::string& where, double* period)
+{
+  std::vector<uint16_t> words;
+  const char* at = text;
+  char* end;
+  for(long word = strtol(at, &end, 16); end != at; word = strtol(at, &end, 16))
+  {
+    words.push_back((uint16_t)word);
+    at = end;
+  }
+
+  if((words.size() < 4) || (words[0] != 0x0000)) { fail("%s: only learned (0000) pronto codes are supported", where.c_str()); }
+  if(words[1] == 0)                               { fail("%s: carrier frequency is zero", where.c_str()); }
+  if(words.size() != 4 + 2 * (size_t)(words[2] + words[3])) { fail("%s: wrong number of burst pairs", where.c_str()); }
+
+  *period = words[1] * PRONTO_UNIT;
+  return words;
+}
+
+std::vector<Capture> readCaptures(const std::string& path)
+{
+  FILE* f = fopen(path.c_str(), "r");
+  if(!f) { fail("can't open %s", path.c_str()); }
+
+  std::vector<Capture> captures;
+  std::string line;
+  for(int c = fgetc(f); ; c = fgetc(f))
+  {
+    if((c != '\n') && (c != EOF))
+    {
+      line += (char)c;
+      continue;
+    }
+
+    size_t equals = line.find('=');
+    if(!line.empty() && (line[0] != '#') && (equals != std::string::npos))
+    {
+      Capture capture;
+      capture.key = line.substr(0, equals);
+      capture.key.erase(capture.key.find_last_not_of(" \t\r") + 1);
+      capture.words = parsePronto(line.c_str() + equals + 1, path + ":" + capture.key, &capture.period);
+      captures.push_back(capture);
+    }
+    line.clear();
+    if(c == EOF) { break; }
+  }
+
+  fclose(f);
+  return captures;
+}
+
+const Capture& findCapture(const std::vector<Capture>& captures, const std::string& key, const std::string& path)
+{
+  for(size_t i = 0; i < captures.size(); i++)
+  {
+    if(captures[i].key == key) { return captures[i]; }
+  }
+  fail("no code named %s in %s", key.c_str(), path.c_str());
+}
@@ -0,0 +1,41 @@
+/*
+ * Written by Brendan Whitfield
+ *
+ */
+
+
+#ifndef CAPTURES_H
+#define CAPTURES_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+
+#define PRONTO_UNIT 0.241246 //microseconds per Pronto frequency unit
+
+//a learned (0000) Pronto code from a capture file
+struct Capture
+{
+  std::string key;
+  double period;               //microseconds per carrier cycle
+  std::vector<uint16_t> words; //the whole code, header and all
+};
+
+
+/*
+ * Pronto captures (the .txt files in codes/: "key=0000 006d 0022 ..." lines, # comments), and the
+ * error handling every host tool does the same way. Each tool names itself for the
+ * messages by defining toolName.
+ */
+
+extern const char* toolName;
+
+[[noreturn]] void fail(const char* format, ...); //prints "<toolName>: <message>" and exits with 2
+void check(bool ok, const char* what); //prints "  FAILED: <what>" if it isn't ok, and counts it
+int failures(); //checks that have failed
+
+std::vector<Capture> readCaptures(const std::string& path); //every code in the file, in order. Fails on one that isn't learned, or is cut short
+const Capture& findCapture(const std::vector<Capture>& captures, const std::string& key, const std::string& path); //fails if there's none
+
+#endif
@@ -0,0 +1,103 @@
+/*
+ * Written by Brendan Whitfield
+ *
+ * Simulated port backend for the serial commands.
+ * Stands in for CommandAvr.cpp on a PC. Bytes arrive on the TransmitSim.cpp clock, a byte
+ * time apart, into a receive buffer as small as the real one, and waking from sleep on the
+ * start bit is left to ButtonsSim.cpp (see simSerialNext()).
+ */
+
+
+
+#include <deque>
+#include "TransmitSim.h"
+#include "CommandSim.h"
+
+
+
+static std::deque<SimSerialByte> line;     //on the way to the board
+static std::deque<uint8_t> buffer;         //arrived, not yet read
+static std::vector<SimSerialByte> written;
+static uint64_t lineFree = 0;              //when the line is free for the next byte sent
+static bool heard = false;                 //a byte has arrived since commandPortHeard() was last called
+static uint32_t lost = 0;
+
+
+
+//moves everything that has arrived by now into the receive buffer
+static void arrive()
+{
+  while(!line.empty() && (line.front().time <= simNow()))
+  {
+    if(buffer.size() < SIM_SERIAL_BUFFER) { buffer.push_back(line.front().data); }
+    else                                  { lost++; }
+    heard = true;
+    line.pop_front();
+  }
+}
+
+void simSerialSend(uint64_t at, const uint8_t* data, size_t length)
+{
+  if(at < lineFree) { at = lineFree; }
+  for(size_t i = 0; i < length; i++)
+  {
+    SimSerialByte b = {at + ((i + 1) * SIM_SERIAL_BYTE), data[i]};
+    line.push_back(b);
+  }
+  lineFree = at + (length * SIM_SERIAL_BYTE);
+}
+
+uint64_t simSerialNext()
+{
+  //the start bit is what wakes the board, a byte time before the byte is in
+  return line.empty() ? UINT64_MAX : line.front().time - SIM_SERIAL_BYTE;
+}
+
+const std::vector<SimSerialByte>& simSerialWritten()
+{
+  return written;
+}
+
+uint32_t simSerialLost()
+{
+  return lost;
+}
+
+
+
+void commandPortBegin()
+{
+}
+
+int commandPortRead()
+{
+  arrive();
+  if(buffer.empty()) { return -1; }
+
+  int data = buffer.front();
+  buffer.pop_front();
+  return data;
+}
+
+void commandPortWrite(const uint8_t* data, uint8_t length)
+{
+  for(uint8_t i = 0; i < length; i++)
+  {
+    SimSerialByte b = {simNow(), data[i]};
+    written.push_back(b);
+  }
+}
+
+bool commandPortHeard()
+{
+  //a byte that's still coming in counts too, its start bit would have raised the pin change
+  arrive();
+  bool was = heard || (simSerialNext() <= simNow());
+  heard = false;
+  return was;
+}
+
+uint32_t commandPortMicros()
+{
+  return (uint32_t)(simNow() / (SIM_F_CPU / 1000000));
+}
@@ -0,0 +1,37 @@
+/*
+ * Written by Brendan Whitfield
+ *
+ */
+
+
+#ifndef COMMAND_SIM_H
+#define COMMAND_SIM_H
+
+#include <stdint.h>
+#include <vector>
+#include "Command.h"
+
+
+#define SIM_SERIAL_BUFFER 64 //bytes the Arduino core's receive buffer holds (more are lost)
+#define SIM_SERIAL_BYTE   ((uint64_t)SIM_F_CPU * 10 / COMMAND_BAUD) //cpu cycles a byte takes on the line (start, 8 data, stop)
+
+//a byte the board wrote, and when
+struct SimSerialByte
+{
+  uint64_t time; //cpu cycles since simReset()
+  uint8_t  data;
+};
+
+
+/*
+ * Simulated port backend for the serial commands. A loopback stand-in for the serial port,
+ * timed on the TransmitSim.cpp clock: bytes sent to the board arrive a byte time apart,
+ * and bytes it writes are logged.
+ */
+
+void simSerialSend(uint64_t at, const uint8_t* data, size_t length); //bytes on their way to the board, the first arriving at cpu cycle `at` (or after the ones before)
+uint64_t simSerialNext(); //cpu cycle the next byte arrives at, UINT64_MAX if there's none on the way
+const std::vector<SimSerialByte>& simSerialWritten();
+uint32_t simSerialLost(); //bytes that arrived to a full receive buffer
+
+#endif
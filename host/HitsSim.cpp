@@ -0,0 +1,61 @@
+/*
+ * Written by Brendan Whitfield
+ *
+ * Simulated port backend for the hit cache.
+ * Stands in for HitsAvr.cpp on a PC, with the log in an array.
+ */
+
+
+
+#include <string.h>
+#include "HitsSim.h"
+
+
+
+static uint8_t eeprom[HITS_SLOTS * sizeof(HitRecord)];
+static uint32_t writes[HITS_SLOTS * sizeof(HitRecord)];
+static uint32_t records = 0;
+static bool erased = false;
+
+
+
+static uint8_t* slotAt(uint8_t slot)
+{
+  if(!erased) { simEraseHits(); }
+  return eeprom + (slot * sizeof(HitRecord));
+}
+
+void simEraseHits()
+{
+  memset(eeprom, 0xFF, sizeof(eeprom));
+  memset(writes, 0, sizeof(writes));
+  records = 0;
+  erased = true;
+}
+
+uint32_t simHitWrites(uint16_t byte)
+{
+  return writes[byte];
+}
+
+uint32_t simHitRecords()
+{
+  return records;
+}
+
+void hitsPortRead(uint8_t slot, HitRecord* record)
+{
+  memcpy(record, slotAt(slot), sizeof(HitRecord));
+}
+
+void hitsPortWrite(uint8_t slot, const HitRecord* record)
+{
+  uint8_t* at = slotAt(slot);
+  const uint8_t* bytes = (const uint8_t*)record;
+  for(uint16_t i = 0; i < sizeof(HitRecord); i++)
+  {
+    if(at[i] != bytes[i]) { writes[(at - eeprom) + i]++; }
+    at[i] = bytes[i];
+  }
+  records++;
+}
@@ -0,0 +1,24 @@
+/*
+ * Written by Brendan Whitfield
+ *
+ */
+
+
+#ifndef HITS_SIM_H
+#define HITS_SIM_H
+
+#include <stdint.h>
+#include "Hits.h"
+
+
+/*
+ * Simulated port backend for the hit cache. The EEPROM is an array, erased to start with,
+ * that counts the writes to each of its bytes (a byte written with what it already held
+ * isn't one, as with eeprom_update_block()).
+ */
+
+void simEraseHits();   //a new EEPROM, erased, with no writes yet (call beginHits() again after)
+uint32_t simHitWrites(uint16_t byte); //writes byte `byte` of the log has taken
+uint32_t simHitRecords(); //records written, all told
+
+#endif
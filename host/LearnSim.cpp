@@ -0,0 +1,47 @@
+/*
+ * Written by Brendan Whitfield
+ *
+ * Simulated port backend for learning.
+ * Stands in for LearnAvr.cpp on a PC. There's no receiver, whoever drives the simulation
+ * calls learnEdge() and learnTimeout() itself. The EEPROM is an array, erased to start with.
+ */
+
+
+
+#include <string.h>
+#include "Learn.h"
+
+
+
+static uint8_t eeprom[LEARN_EEPROM + (LEARN_SLOTS * sizeof(LearnedCode))]; //sized for the slots (Nibbles take more room on a PC)
+static bool erased = false;
+
+
+
+static uint8_t* slotAt(uint8_t slot)
+{
+  if(!erased)
+  {
+    memset(eeprom, 0xFF, sizeof(eeprom));
+    erased = true;
+  }
+  return eeprom + LEARN_EEPROM + (slot * sizeof(LearnedCode));
+}
+
+void learnPortBegin()
+{
+}
+
+void learnPortStop()
+{
+}
+
+void learnPortRead(uint8_t slot, LearnedCode* learned)
+{
+  memcpy(learned, slotAt(slot), sizeof(LearnedCode));
+}
+
+void learnPortWrite(uint8_t slot, const LearnedCode* learned)
+{
+  memcpy(slotAt(slot), learned, sizeof(LearnedCode));
+}
@@ -0,0 +1,129 @@
+/*
+ * Written by Brendan Whitfield
+ *
+ * Simulated port backend for the transmit engine.
+ * Mirrors the Timer1 setup of TransmitAvr.cpp (a compare unit per channel, each alternating
+ * between the HIGH and the LOW part of a cycle), but the clock only moves when simStep() is
+ * called. An interrupt that comes due while the other channel's is putting out its level
+ * waits for it (SIM_EMIT_CYCLES), and channel 0 goes first when both are due at once.
+ */
+
+
+
+#include "TransmitSim.h"
+
+
+
+static uint64_t now = 0;
+static uint64_t busy = 0;                  //until then, the interrupt that ran last holds off the other's
+static uint64_t nextTick[SEND_CHANNELS];   //when each channel's next match comes
+static uint32_t part[SEND_CHANNELS][2];    //cpu cycles in the HIGH and the LOW part of a cycle
+static uint8_t phase[SEND_CHANNELS];       //part that starts at the next interrupt
+static int8_t level[SEND_CHANNELS];        //what each channel's next interrupt puts out
+static bool ticking[SEND_CHANNELS];
+static uint32_t starts = 0;
+static std::vector<SimTick> ticks[SEND_CHANNELS];
+
+
+
+void simReset()
+{
+  now = 0;
+  busy = 0;
+  starts = 0;
+  for(uint8_t i = 0; i < SEND_CHANNELS; i++) { ticks[i].clear(); }
+}
+
+void simForget()
+{
+  for(uint8_t i = 0; i < SEND_CHANNELS; i++) { ticks[i].clear(); }
+}
+
+//channel whose interrupt runs next, or -1 if the timer is stopped
+static int nextChannel()
+{
+  int next = -1;
+  for(uint8_t i = 0; i < SEND_CHANNELS; i++)
+  {
+    if(ticking[i] && ((next < 0) || (nextTick[i] < nextTick[next]))) { next = i; }
+  }
+  return next;
+}
+
+bool simStep()
+{
+  int channel = nextChannel();
+  if(channel < 0) { return false; }
+
+  //the match is where the next one is counted from, even if the interrupt runs late
+  now = (nextTick[channel] > busy) ? nextTick[channel] : busy;
+  busy = now + SIM_EMIT_CYCLES;
+  nextTick[channel] += part[channel][phase[channel]];
+  phase[channel] ^= 1;
+
+  SimTick tick = {now, SIM_IDLE};
+  ticks[channel].push_back(tick);
+  if(level[channel] >= 0) { portEmit(channel, level[channel]); }
+  level[channel] = transmitTick(channel);
+  return true;
+}
+
+void simRun(uint64_t until)
+{
+  for(int channel = nextChannel(); (channel >= 0) && (nextTick[channel] <= until); channel = nextChannel()) { simStep(); }
+  if(until > now) { now = until; }
+}
+
+uint64_t simNow()
+{
+  return now;
+}
+
+uint32_t simStarts()
+{
+  return starts;
+}
+
+const std::vector<SimTick>& simTicks(uint8_t channel)
+{
+  return ticks[channel];
+}
+
+
+
+void portBegin()
+{
+  for(uint8_t i = 0; i < SEND_CHANNELS; i++) { ticking[i] = false; }
+}
+
+CarrierParts portCarrier(uint16_t carrier)
+{
+  //same split as the real port
+  uint32_t cycles = ((uint32_t)carrier * (SIM_F_CPU / 1000000)) / CARRIER_SCALE;
+  uint16_t high = (cycles * SEND_DUTY + 50) / 100;
+  CarrierParts parts = {high, (uint16_t)(cycles - high)};
+  return parts;
+}
+
+void portStart(uint8_t channel, CarrierParts parts)
+{
+  part[channel][0] = parts.high;
+  part[channel][1] = parts.low;
+
+  //the wait for the first interrupt counts as a LOW part
+  nextTick[channel] = now + part[channel][1];
+  phase[channel] = 0;
+  level[channel] = -1;
+  ticking[channel] = true;
+  starts++;
+}
+
+void portStop(uint8_t channel)
+{
+  ticking[channel] = false;
+}
+
+void portEmit(uint8_t channel, uint8_t on)
+{
+  if(!ticks[channel].empty()) { ticks[channel].back().level = on ? 1 : 0; }
+}
@@ -0,0 +1,41 @@
+/*
+ * Written by Brendan Whitfield
+ *
+ */
+
+
+#ifndef TRANSMIT_SIM_H
+#define TRANSMIT_SIM_H
+
+#include <stdint.h>
+#include <vector>
+#include "Transmit.h"
+
+
+#define SIM_F_CPU 16000000UL //cycles per second of the simulated ATmega328
+#define SIM_IDLE  -1         //level of a tick that didn't drive the emitters
+#define SIM_EMIT_CYCLES 60   //cpu cycles an interrupt keeps the other channel's waiting (until it's put out its level)
+
+//one timer interrupt: when it fired, and what it left the emitters at
+struct SimTick
+{
+  uint64_t time;  //cpu cycles since simReset()
+  int8_t   level; //0, 1, or SIM_IDLE
+};
+
+
+/*
+ * Simulated port backend. Stands in for TransmitAvr.cpp on a PC, running the timer
+ * against a virtual clock counted in CPU cycles, and logging every interrupt.
+ * Each channel's interrupts go in a log of their own, so each pin can be checked on its own.
+ */
+
+void simReset();   //clock back to zero, forget the log
+void simForget();  //forget the log, leaving the clock be (for long runs)
+bool simStep();    //jump to the timer's next interrupt (on either channel) and run it. False if the timer is stopped
+void simRun(uint64_t until); //move the clock on to `until`, running every interrupt due before then
+uint64_t simNow(); //cpu cycles since simReset()
+uint32_t simStarts(); //times a channel was set up (portStart()) since simReset()
+const std::vector<SimTick>& simTicks(uint8_t channel = 0);
+
+#endif
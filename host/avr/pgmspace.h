@@ -0,0 +1,47 @@
+/*
+ * Written by Brendan Whitfield
+ *
+ * Stand-in for avr-libc's <avr/pgmspace.h>, so the code tables and decoders build on a PC.
+ * There's only one address space off the AVR, so flash reads are plain memory reads.
+ */
+
+
+#ifndef PGMSPACE_H
+#define PGMSPACE_H
+
+#include <stdint.h>
+#include <string.h>
+
+
+#define PROGMEM
+
+typedef const char* PGM_P;
+
+
+static inline uint8_t pgm_read_byte(const void* addr)
+{
+  return *(const uint8_t*)addr;
+}
+
+static inline uint16_t pgm_read_word(const void* addr)
+{
+  uint16_t value;
+  memcpy(&value, addr, sizeof(value));
+  return value;
+}
+
+static inline uint32_t pgm_read_dword(const void* addr)
+{
+  uint32_t value;
+  memcpy(&value, addr, sizeof(value));
+  return value;
+}
+
+static inline const void* pgm_read_ptr(const void* addr)
+{
+  const void* value;
+  memcpy(&value, addr, sizeof(value));
+  return value;
+}
+
+#endif
@@ -0,0 +1,216 @@
+/*
+ * Written by Brendan Whitfield
+ *
+ * Debounce check.
+ * Drives Buttons.cpp through the simulated pins with bouncing contacts and slow edges, and
+ * checks the events it reports. A contact that bounces gives one press and one release, a
+ * press that's let go early doesn't hold, and a pin only counts as pressed once it crosses the
+ * ATmega328's input threshold (its inputs are Schmitt triggers: HIGH above 0.6 Vcc, LOW again
+ * below 0.3 Vcc). Exits with 1 if any case reports the wrong events, or at the wrong time.
+ *
+ *   g++ -O2 -I host -I . host/debounce.cpp host/ButtonsSim.cpp host/CommandSim.cpp host/TransmitSim.cpp Buttons.cpp Transmit.cpp Codes.cpp Protocols.cpp Pronto.cpp -o debounce
+ *   ./debounce
+ */
+
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#include "ButtonsSim.h"
+#include "TransmitSim.h"
+
+
+
+#define CYCLES_US   (SIM_F_CPU / 1000000)
+#define CYCLES_MS   (SIM_F_CPU / 1000)
+#define PASS_US     20   //time between calls to updateButtons(), a pass of loop() when it's awake
+#define SAMPLE_US   10   //step the voltage of a slow edge is worked out at
+#define INPUT_HIGH  0.6  //of Vcc, a LOW pin reads HIGH above this
+#define INPUT_LOW   0.3  //and a HIGH one LOW again below this
+#define CASE_MS     1000 //each case starts this long after the last, with every button up and settled
+
+//an event, and when updateButtons() reported it
+struct Event
+{
+  uint8_t event;
+  double ms; //since the start of the case
+};
+
+//the events a case should report, each within `slack` ms after `ms`
+struct Expected
+{
+  uint8_t event;
+  double ms;
+  double slack;
+};
+
+
+
+static const char* eventNames[] = {"none", "press", "hold", "release"};
+static uint32_t noise = 1;
+static uint64_t start = 0; //cpu cycle the case started at
+
+
+
+static uint64_t at(double ms)
+{
+  return start + (uint64_t)(ms * CYCLES_MS);
+}
+
+//somewhere in [lo, hi)
+static double random(double lo, double hi)
+{
+  noise = (noise * 1103515245) + 12345;
+  return lo + ((noise >> 16) & 0x7FFF) * (hi - lo) / 0x8000;
+}
+
+//the contacts of UP close (or open) at `ms`, chattering between the rails for `bounce` ms before they settle
+static void bounce(double ms, double bounce, bool closed)
+{
+  bool level = closed;
+  for(double t = ms; t < ms + bounce; t += random(0.05, 0.4))
+  {
+    simSetButtons(at(t), level ? (1 << BUTTON_UP) : 0);
+    level = !level;
+  }
+  simSetButtons(at(ms + bounce), closed ? (1 << BUTTON_UP) : 0);
+}
+
+//UP's pin rises to `peak` (of Vcc) over `rise` ms from `ms`, with `ripple` on it, stays there
+//for `hold` ms and falls back over `rise`. The pin changes where a Schmitt trigger input would
+static void slowEdge(double ms, double rise, double peak, double ripple, double hold)
+{
+  bool high = false;
+  double end = ms + rise + hold + rise;
+  for(double t = ms; t <= end; t += SAMPLE_US / 1000.0)
+  {
+    double v = peak;
+    if(t < ms + rise) { v = peak * (t - ms) / rise; }
+    if(t > end - rise) { v = peak * (end - t) / rise; }
+    v += random(-ripple, ripple);
+
+    if(!high && (v > INPUT_HIGH))
+    {
+      high = true;
+      simSetButtons(at(t), 1 << BUTTON_UP);
+    }
+    else if(high && (v < INPUT_LOW))
+    {
+      high = false;
+      simSetButtons(at(t), 0);
+    }
+  }
+  if(high) { simSetButtons(at(end), 0); }
+}
+
+//the case's first crossing of INPUT_HIGH, as slowEdge() would put it (without the ripple)
+static double crossing(double ms, double rise, double peak)
+{
+  return ms + (rise * INPUT_HIGH / peak);
+}
+
+//runs the buttons through the case, then checks its events
+static bool check(const char* name, const std::vector<Expected>& expected)
+{
+  std::vector<Event> events;
+  uint64_t end = at(CASE_MS);
+  while(simNow() < end)
+  {
+    simRun(simNow() + (PASS_US * CYCLES_US));
+    updateButtons((uint16_t)(simNow() / CYCLES_MS));
+    uint8_t event = getButtonEvent(BUTTON_UP);
+    if(event != BUTTON_NONE)
+    {
+      Event e = {event, (simNow() - start) / (double)CYCLES_MS};
+      events.push_back(e);
+    }
+  }
+
+  bool ok = (events.size() == expected.size());
+  for(size_t i = 0; ok && (i < events.size()); i++)
+  {
+    ok = (events[i].event == expected[i].event) &&
+         (events[i].ms >= expected[i].ms) && (events[i].ms <= expected[i].ms + expected[i].slack);
+  }
+
+  printf("%-26s %s:", name, ok ? "ok  " : "FAIL");
+  for(size_t i = 0; i < events.size(); i++) { printf(" %s at %.2fms", eventNames[events[i].event], events[i].ms); }
+  if(events.empty()) { printf(" nothing"); }
+  printf("\n");
+
+  start = end;
+  return ok;
+}
+
+static Expected expect(uint8_t event, double ms, double slack)
+{
+  Expected e = {event, ms, slack};
+  return e;
+}
+
+
+
+int main()
+{
+  int failed = 0;
+  double tick = 1.0 + (PASS_US / 1000.0); //millis() only moves on once a ms, and the pass after
+  std::vector<Expected> e;
+
+  simReset();
+  beginButtons();
+  start = simNow();
+
+  //contacts that chatter for 3ms as they close and 2ms as they open
+  bounce(10, 3, true);
+  bounce(200, 2, false);
+  e.clear();
+  e.push_back(expect(BUTTON_PRESS, 10, tick));
+  e.push_back(expect(BUTTON_RELEASE, 200, tick));
+  failed += !check("bouncy press", e);
+
+  //held down past BUTTON_HOLD_TIME
+  bounce(10, 3, true);
+  bounce(10 + BUTTON_HOLD_TIME + 200, 3, false);
+  e.clear();
+  e.push_back(expect(BUTTON_PRESS, 10, tick));
+  e.push_back(expect(BUTTON_HOLD, 10 + BUTTON_HOLD_TIME, tick));
+  e.push_back(expect(BUTTON_RELEASE, 10 + BUTTON_HOLD_TIME + 200, tick));
+  failed += !check("bouncy hold", e);
+
+  //let go before the debounce is up, the release is seen as soon as it's over
+  bounce(10, 2, true);
+  bounce(15, 1, false);
+  e.clear();
+  e.push_back(expect(BUTTON_PRESS, 10, tick));
+  e.push_back(expect(BUTTON_RELEASE, 10 + BUTTON_DEBOUNCE, tick));
+  failed += !check("5ms tap", e);
+
+  //contacts that open again after the debounce are a release, and closing again while that
+  //one's debounce is running is a press as soon as it's over (two presses, not a burst of them)
+  bounce(10, 2, true);
+  bounce(10 + BUTTON_DEBOUNCE + 5, 0.3, false);
+  bounce(10 + BUTTON_DEBOUNCE + 10, 2, true);
+  bounce(300, 2, false);
+  e.clear();
+  e.push_back(expect(BUTTON_PRESS, 10, tick));
+  e.push_back(expect(BUTTON_RELEASE, 10 + BUTTON_DEBOUNCE + 5, tick));
+  e.push_back(expect(BUTTON_PRESS, 10 + BUTTON_DEBOUNCE + 10, BUTTON_DEBOUNCE + tick));
+  e.push_back(expect(BUTTON_RELEASE, 300, tick));
+  failed += !check("two presses", e);
+
+  //a slow, noisy edge that makes it past the threshold is one press, from where it crosses
+  slowEdge(10, 2, 1.0, 0.15, 100);
+  e.clear();
+  e.push_back(expect(BUTTON_PRESS, crossing(10, 2, 1.0) - 0.3, tick + 0.3));
+  e.push_back(expect(BUTTON_RELEASE, 10 + 2 + 100, 2 + tick));
+  failed += !check("slow edge over threshold", e);
+
+  //one that tops out between the thresholds never reads HIGH, however long it's held
+  slowEdge(10, 2, 0.55, 0.04, 600);
+  e.clear();
+  failed += !check("under threshold", e);
+
+  printf("\n%d cases failed\n", failed);
+  return failed ? 1 : 0;
+}
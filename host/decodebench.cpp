@@ -0,0 +1,452 @@
+/*
+ * Written by Brendan Whitfield
+ *
+ * Decoder and footprint benchmark.
+ * Decodes every table entry with the CodeCursor functions and with getCode(), and reports
+ * for each table:
+ *
+ *   flash    bytes the table takes on the ATmega328: its IRCode entries, their code strings,
+ *            and the dictionaries it's the first to use (same sums as tools/gencodes.py)
+ *   ram      bytes getCode() allocates for the table's longest code, against the cursor's
+ *            (both on the ATmega328)
+ *   decode   bursts per second through nextBurst() and through getCode(), on this machine
+ *   worst    slowest single nextBurst() of the table (the fastest of every run of it, so a
+ *            stray interrupt doesn't count), as a share of the code's carrier period. The
+ *            engine decodes a burst while the last one goes out, so this has to stay well
+ *            under one period on the board. Measured on this machine, it's for comparing
+ *            one catalog or decoder change against another, not a figure for the board
+ *
+ * and every dictionary, with the codes that use it, then the sketch's fixed RAM buffers on the
+ * ATmega328 (the ones its #defines size) against its 2048 bytes. Each code is also checked to decode to
+ * the same bursts both ways, as many as its codeLength. Exits with 1 if one doesn't. (getCode()
+ * is built on the cursor, so that's only a sanity check, host/golden.cpp checks the bursts.)
+ *
+ * The decode rates come from decoding the table for --ms milliseconds each way, the worst
+ * bursts from --reps runs of each code.
+ * --json writes it all to a file ("-" for stdout) to keep, and to compare against later runs.
+ *
+ *   g++ -O2 -I host -I . host/decodebench.cpp host/Captures.cpp Codes.cpp Protocols.cpp Pronto.cpp -o decodebench
+ *   ./decodebench [--manifest codes/manifest.txt] [--reps 200] [--ms 100] [--json decode.json]
+ */
+
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "Captures.h"
+#include "Codes.h"
+#include "CodeCheck.h"
+#include "Command.h"
+#include "Hits.h"
+#include "Pronto.h"
+#include "Transmit.h"
+
+
+
+#define AVR_IRCODE 8 //sizeof(IRCode) on the ATmega328, where pointers are 2 bytes (SIZE_IRCODE in tools/gencodes.py)
+#define AVR_BURST  4 //sizeof(BurstPair)
+#define AVR_CURSOR 17 //sizeof(CodeCursor): 3 pointers, the carrier and 9 bytes (avr-gcc doesn't pad)
+
+//the same members laid out on a 64 bit PC, to catch a change to CodeCursor that AVR_CURSOR misses
+static_assert((sizeof(void*) != 8) || (sizeof(CodeCursor) == 40), "CodeCursor has changed, update AVR_CURSOR");
+
+//structs private to their .cpp, on the ATmega328
+#define AVR_RAM     2048 //bytes of SRAM
+#define AVR_COMMAND 8    //Command (Command.cpp): 6 bytes and the gap
+#define AVR_CHANNEL (SEND_QUEUE_SIZE * 9 + 3 + AVR_CURSOR + 1 + 8) //Channel (Transmit.cpp): 9 bytes a queued code, head, tail, running, the cursor, active, 4 counts
+#define AVR_WATCHED 8    //Watched (Hits.cpp): ticket, at (4), index, done
+#define AVR_LEARNED (4 + (LEARN_DICT * AVR_BURST) + (LEARN_BURSTS / 2)) //LearnedCode: a Nibbles is a byte on the board (4 here)
+
+//to catch a member AVR_LEARNED misses
+static_assert(sizeof(LearnedCode) == 4 + (LEARN_DICT * sizeof(BurstPair)) + (LEARN_BURSTS / 2) * sizeof(Nibbles), "LearnedCode has changed, update AVR_LEARNED");
+//no pointers or bit fields in this one, it's the same on the board
+static_assert(sizeof(StreamRam) == ((STREAM_PAIRS * 4 > LEARN_BURSTS * AVR_BURST) ? STREAM_PAIRS * 4 : LEARN_BURSTS * AVR_BURST), "StreamRam isn't laid out as on the board");
+
+//a fixed RAM buffer of the sketch
+struct Buffer
+{
+  const char* name;
+  int bytes;
+};
+
+static const Buffer buffers[] = {
+  {"stream ring/capture", (int)sizeof(StreamRam)},
+  {"learned code", AVR_LEARNED},
+  {"command ring", (COMMAND_RING + 1) * AVR_COMMAND},
+  {"command frame", COMMAND_FRAME},
+  {"send channels", SEND_CHANNELS * AVR_CHANNEL},
+  {"sweep hits", HITS_WATCH * AVR_WATCHED + NUM_TABLES},
+};
+
+//every table in Codes.h, by TABLE_ number
+static const char* names[] = {
+  "POWER_ON", "POWER_OFF", "MUTE", "VOLUME_UP", "VOLUME_DOWN", "CHANNEL_UP", "CHANNEL_DOWN",
+  "PROJ_POWER_ON", "PROJ_POWER_OFF", "PROJ_VOLUME_UP", "PROJ_VOLUME_DOWN"
+};
+
+static_assert(NUM_ELEM(names) == NUM_TABLES, "every table in codeTables needs a name here");
+
+//a dictionary, found through the codes that use it
+struct Dict
+{
+  const BurstPair* pairs;
+  int entries;     //as many as its codes index
+  int firstTable;  //charged to the first table that uses it
+  int users;
+  std::string brand; //of the first code that uses it
+};
+
+struct CodeStats
+{
+  int bursts;
+  int bytes;        //of its code string
+  double worstNs;   //slowest nextBurst()
+  double periodNs;  //of its carrier
+};
+
+struct TableStats
+{
+  int entries;
+  int ircode;
+  int codes;
+  int dicts;
+  int longest;      //bursts of its longest code
+  int bursts;       //of all its codes
+  double cursorRate; //bursts per second
+  double getCodeRate;
+  double worstRatio; //worst nextBurst() over the carrier period
+  int worstCode;
+};
+
+typedef std::chrono::steady_clock Clock;
+
+
+
+static volatile uint32_t sink; //decoded bursts go here, so none of the decoding is optimised out
+
+
+
+const char* toolName = "decodebench";
+
+static double nanoseconds(Clock::time_point from, Clock::time_point to)
+{
+  return std::chrono::duration<double, std::nano>(to - from).count();
+}
+
+//brand of every entry of every table, from the manifest (in the order gencodes.py put them in)
+static std::vector<std::string> readBrands(const char* path, int table)
+{
+  FILE* file = fopen(path, "r");
+  if(!file) { fail("can't open the manifest"); }
+
+  std::vector<std::string> brands;
+  char line[256];
+  while(fgets(line, sizeof(line), file))
+  {
+    char name[64];
+    char brand[64];
+    if((line[0] == '#') || (line[0] == '@')) { continue; }
+    if(sscanf(line, "%63s %63s", name, brand) != 2) { continue; }
+    if(!strcmp(name, names[table])) { brands.push_back(brand); }
+  }
+  fclose(file);
+  return brands;
+}
+
+//bytes of the code string, as IR_CODE() works them out
+static int codeBytes(const IRCode* code)
+{
+  uint8_t format = getFormat(code);
+  uint8_t length = getLength(code);
+  const uint8_t* data = (const uint8_t*)pgm_read_ptr(&code->code);
+
+  if(IS_PROTOCOL(format)) { return packedBytes(payloadBits(format, length), 1); }
+  uint8_t width = (format & FORMAT_BITS) ? (format & FORMAT_WIDTH) : 4;
+  if(format & FORMAT_REPEAT) { return 1 + (data[0] * 2) + packedBytes(segmentIndices(data + 1, data[0]), width); }
+  return packedBytes(length, width);
+}
+
+//dictionary entries the code reads
+static int dictEntries(const IRCode* code)
+{
+  uint8_t format = getFormat(code);
+  uint8_t length = getLength(code);
+  const uint8_t* data = (const uint8_t*)pgm_read_ptr(&code->code);
+
+  if(IS_PROTOCOL(format)) { return protocolSymbols(format, length); }
+
+  int most = 0;
+  if(format & FORMAT_BITS)
+  {
+    uint8_t width = format & FORMAT_WIDTH;
+    uint16_t count = length;
+    if(format & FORMAT_REPEAT)
+    {
+      count = segmentIndices(data + 1, data[0]);
+      data += 1 + (data[0] * 2);
+    }
+    for(uint16_t i = 0; i < count; i++)
+    {
+      if(packedAt(data, i, width) + 1 > most) { most = packedAt(data, i, width) + 1; }
+    }
+    return most;
+  }
+
+  const Nibbles* nibbles = (const Nibbles*)data;
+  for(uint16_t i = 0; i < length; i++)
+  {
+    int index = (i % 2) ? nibbles[i / 2].lo : nibbles[i / 2].hi;
+    if(index + 1 > most) { most = index + 1; }
+  }
+  return most;
+}
+
+//true if the cursor and getCode() agree, burst for burst, and there are codeLength of them
+static bool decodesTheSame(const IRCode* code, int* bursts)
+{
+  CodeCursor cursor;
+  BurstPair pair;
+  BurstPair* pairs = getCode(code);
+  bool same = true;
+
+  beginCode(&cursor, code);
+  int count = 0;
+  while(nextBurst(&cursor, &pair))
+  {
+    same &= (count < getLength(code)) && (pair.on == pairs[count].on) && (pair.off == pairs[count].off);
+    count++;
+  }
+  delete[] pairs;
+
+  *bursts = count;
+  return same && (count == getLength(code));
+}
+
+//the slowest nextBurst() of a code, each burst timed on its own, the fastest of `reps` runs of it
+static double worstBurst(const IRCode* code, int bursts, int reps)
+{
+  std::vector<double> fastest(bursts, 1e18);
+  CodeCursor cursor;
+  BurstPair pair;
+
+  for(int r = 0; r < reps; r++)
+  {
+    beginCode(&cursor, code);
+    for(int i = 0; i < bursts; i++)
+    {
+      Clock::time_point from = Clock::now();
+      nextBurst(&cursor, &pair);
+      Clock::time_point to = Clock::now();
+      sink = pair.on + pair.off;
+
+      double ns = nanoseconds(from, to);
+      if(ns < fastest[i]) { fastest[i] = ns; }
+    }
+  }
+
+  //the clock's own cost, timed the same way
+  double overhead = 1e18;
+  for(int r = 0; r < reps; r++)
+  {
+    Clock::time_point from = Clock::now();
+    Clock::time_point to = Clock::now();
+    if(nanoseconds(from, to) < overhead) { overhead = nanoseconds(from, to); }
+  }
+
+  double worst = 0;
+  for(int i = 0; i < bursts; i++)
+  {
+    if(fastest[i] - overhead > worst) { worst = fastest[i] - overhead; }
+  }
+  return worst;
+}
+
+//bursts per second decoding the whole table over and over for `ms`, with the cursor or with getCode()
+static double decodeRate(const IRCode* codes, uint8_t total, int ms, bool heap)
+{
+  uint64_t bursts = 0;
+  double spent = 0;
+  Clock::time_point from = Clock::now();
+  while(spent < ms * 1e6)
+  {
+    for(uint8_t i = 0; i < total; i++)
+    {
+      if(heap)
+      {
+        BurstPair* pairs = getCode(codes + i);
+        sink = pairs[0].on;
+        delete[] pairs;
+        bursts += getLength(codes + i);
+        continue;
+      }
+
+      CodeCursor cursor;
+      BurstPair pair;
+      beginCode(&cursor, codes + i);
+      while(nextBurst(&cursor, &pair))
+      {
+        sink = pair.on + pair.off;
+        bursts++;
+      }
+    }
+    spent = nanoseconds(from, Clock::now());
+  }
+  return bursts * 1e9 / spent;
+}
+
+int main(int argc, char** argv)
+{
+  const char* manifest = "codes/manifest.txt";
+  const char* json = NULL;
+  int reps = 200;
+  int ms = 100;
+
+  for(int i = 1; i < argc; i++)
+  {
+    if(!strcmp(argv[i], "--manifest") && (i + 1 < argc)) { manifest = argv[++i]; }
+    else if(!strcmp(argv[i], "--json") && (i + 1 < argc)) { json = argv[++i]; }
+    else if(!strcmp(argv[i], "--reps") && (i + 1 < argc)) { reps = atoi(argv[++i]); }
+    else if(!strcmp(argv[i], "--ms") && (i + 1 < argc))   { ms = atoi(argv[++i]); }
+    else { fail("usage: decodebench [--manifest codes/manifest.txt] [--reps 200] [--ms 100] [--json FILE]"); }
+  }
+  if((reps < 1) || (ms < 1)) { fail("need at least one rep, and a millisecond"); }
+
+  std::vector<Dict> dicts;
+  std::vector<TableStats> tables(NUM_TABLES);
+  std::vector<std::vector<CodeStats> > codeStats(NUM_TABLES);
+  std::vector<std::vector<std::string> > brands(NUM_TABLES);
+  int mismatched = 0;
+  int flash = 0;
+  int codeCount = 0;
+
+  for(uint8_t t = 0; t < NUM_TABLES; t++)
+  {
+    const IRCode* codes = (const IRCode*)pgm_read_ptr(&codeTables[t].codes);
+    uint8_t total = pgm_read_byte(&codeTables[t].total);
+    TableStats& s = tables[t];
+    memset(&s, 0, sizeof(s));
+    brands[t] = readBrands(manifest, t);
+    if(brands[t].size() != total) { fail("the manifest doesn't match Codes.h (run tools/gencodes.py)"); }
+
+    s.entries = total;
+    s.ircode = total * AVR_IRCODE;
+    for(uint8_t i = 0; i < total; i++)
+    {
+      const IRCode* code = codes + i;
+      CodeStats c;
+      if(!decodesTheSame(code, &c.bursts))
+      {
+        fprintf(stderr, "decodebench: %s[%d] (%s) decodes differently with getCode()\n", names[t], i, brands[t][i].c_str());
+        mismatched++;
+      }
+      c.bytes = codeBytes(code);
+      c.worstNs = worstBurst(code, c.bursts, reps);
+      c.periodNs = getCarrier(code) * 1000.0 / CARRIER_SCALE;
+      codeStats[t].push_back(c);
+      codeCount++;
+
+      s.codes += c.bytes;
+      s.bursts += c.bursts;
+      if(c.bursts > s.longest) { s.longest = c.bursts; }
+      if(c.worstNs / c.periodNs > s.worstRatio)
+      {
+        s.worstRatio = c.worstNs / c.periodNs;
+        s.worstCode = i;
+      }
+
+      //its dictionary, charged to this table if no earlier one used it
+      const BurstPair* pairs = (const BurstPair*)pgm_read_ptr(&code->dict);
+      size_t d = 0;
+      while((d < dicts.size()) && (dicts[d].pairs != pairs)) { d++; }
+      if(d == dicts.size())
+      {
+        Dict dict = {pairs, 0, t, 0, brands[t][i]};
+        dicts.push_back(dict);
+      }
+      if(dictEntries(code) > dicts[d].entries) { dicts[d].entries = dictEntries(code); }
+      dicts[d].users++;
+    }
+
+    s.cursorRate = decodeRate(codes, total, ms, false);
+    s.getCodeRate = decodeRate(codes, total, ms, true);
+  }
+
+  for(size_t d = 0; d < dicts.size(); d++) { tables[dicts[d].firstTable].dicts += dicts[d].entries * AVR_BURST; }
+
+  //report
+  printf("%-17s %7s %6s %6s %6s %6s  %6s %6s  %7s %11s %11s %8s %9s\n",
+         "table", "entries", "ircode", "codes", "dicts", "flash", "ram", "cursor", "bursts", "cursor/s", "getCode/s", "worst ns", "of period");
+  for(uint8_t t = 0; t < NUM_TABLES; t++)
+  {
+    const TableStats& s = tables[t];
+    int total = s.ircode + s.codes + s.dicts;
+    flash += total;
+    printf("%-17s %7d %6d %6d %6d %6d  %6d %6d  %7d %11.0f %11.0f %8.1f %8.3f%%  (%s)\n",
+           names[t], s.entries, s.ircode, s.codes, s.dicts, total,
+           s.longest * AVR_BURST, AVR_CURSOR, s.bursts, s.cursorRate, s.getCodeRate,
+           codeStats[t][s.worstCode].worstNs, s.worstRatio * 100, brands[t][s.worstCode].c_str());
+  }
+  printf("\nflash: %d bytes over %d codes and %d dictionaries (ram is getCode()'s buffer for the longest code, and the cursor)\n\n",
+         flash, codeCount, (int)dicts.size());
+
+  printf("%-18s %7s %6s %6s  %s\n", "dictionary", "entries", "bytes", "codes", "charged to");
+  for(size_t d = 0; d < dicts.size(); d++)
+  {
+    printf("%-18s %7d %6d %6d  %s\n", dicts[d].brand.c_str(), dicts[d].entries, dicts[d].entries * AVR_BURST,
+           dicts[d].users, names[dicts[d].firstTable]);
+  }
+
+  int ram = 0;
+  printf("\n%-20s %6s\n", "ram buffer", "bytes");
+  for(size_t b = 0; b < NUM_ELEM(buffers); b++)
+  {
+    printf("%-20s %6d\n", buffers[b].name, buffers[b].bytes);
+    ram += buffers[b].bytes;
+  }
+  printf("\nram: %d bytes of the ATmega328's %d in fixed buffers (the stream ring and the learning capture share %d),\n"
+         "%d left for the rest of .bss, the Arduino core's serial buffers and the stack\n",
+         ram, AVR_RAM, (int)sizeof(StreamRam), AVR_RAM - ram);
+
+  if(json)
+  {
+    FILE* out = strcmp(json, "-") ? fopen(json, "w") : stdout;
+    if(!out) { fail("can't write the json file"); }
+
+    fprintf(out, "{\n  \"flash\": %d,\n  \"codes\": %d,\n  \"cursor_bytes\": %d,\n  \"reps\": %d,\n  \"ms\": %d,\n  \"tables\": [\n",
+            flash, codeCount, AVR_CURSOR, reps, ms);
+    for(uint8_t t = 0; t < NUM_TABLES; t++)
+    {
+      const TableStats& s = tables[t];
+      fprintf(out, "    {\"name\": \"%s\", \"entries\": %d, \"flash\": {\"ircode\": %d, \"codes\": %d, \"dicts\": %d, \"total\": %d},\n",
+              names[t], s.entries, s.ircode, s.codes, s.dicts, s.ircode + s.codes + s.dicts);
+      fprintf(out, "     \"ram\": {\"getcode\": %d}, \"bursts\": %d, \"cursor_bursts_per_s\": %.0f, \"getcode_bursts_per_s\": %.0f,\n",
+              s.longest * AVR_BURST, s.bursts, s.cursorRate, s.getCodeRate);
+      fprintf(out, "     \"worst_burst\": {\"ns\": %.1f, \"of_period\": %.6f, \"index\": %d, \"brand\": \"%s\"},\n     \"per_code\": [",
+              codeStats[t][s.worstCode].worstNs, s.worstRatio, s.worstCode, brands[t][s.worstCode].c_str());
+      for(size_t i = 0; i < codeStats[t].size(); i++)
+      {
+        const CodeStats& c = codeStats[t][i];
+        fprintf(out, "%s\n       {\"brand\": \"%s\", \"bursts\": %d, \"bytes\": %d, \"worst_ns\": %.1f, \"period_ns\": %.1f}",
+                i ? "," : "", brands[t][i].c_str(), c.bursts, c.bytes, c.worstNs, c.periodNs);
+      }
+      fprintf(out, "\n     ]}%s\n", (t + 1 < NUM_TABLES) ? "," : "");
+    }
+    fprintf(out, "  ],\n  \"dictionaries\": [\n");
+    for(size_t d = 0; d < dicts.size(); d++)
+    {
+      fprintf(out, "    {\"brand\": \"%s\", \"entries\": %d, \"bytes\": %d, \"codes\": %d, \"charged_to\": \"%s\"}%s\n",
+              dicts[d].brand.c_str(), dicts[d].entries, dicts[d].entries * AVR_BURST, dicts[d].users,
+              names[dicts[d].firstTable], (d + 1 < dicts.size()) ? "," : "");
+    }
+    fprintf(out, "  ],\n  \"ram_buffers\": {");
+    for(size_t b = 0; b < NUM_ELEM(buffers); b++) { fprintf(out, "%s\"%s\": %d", b ? ", " : "", buffers[b].name, buffers[b].bytes); }
+    fprintf(out, "},\n  \"ram_total\": %d,\n  \"mismatched\": %d\n}\n", ram, mismatched);
+    if(out != stdout) { fclose(out); }
+  }
+
+  return mismatched ? 1 : 0;
+}
@@ -0,0 +1,194 @@
+/*
+ * Written by Brendan Whitfield
+ *
+ * Golden decode check.
+ * Decodes every table entry with the CodeCursor the engine sends from, and with getCode(),
+ * and compares each burst with host/golden.txt, the bursts of the hand-written tables from
+ * before the decoder and the table formats changed. The two have to agree exactly, as must
+ * the carrier (to the whole microsecond of a half period the old tables were in).
+ * UNLISTED, the codes in no table, is checked the same way. It's where the repeat segments
+ * are (FORMAT_REPEAT).
+ * Exits with 1 if any entry differs, or a table has gained or lost entries.
+ *
+ *   g++ -O2 -I host -I . host/golden.cpp host/Captures.cpp Codes.cpp Protocols.cpp Pronto.cpp -o golden
+ *   ./golden [host/golden.txt]
+ */
+
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "Captures.h"
+#include "Codes.h"
+
+
+
+//every table in Codes.h, by TABLE_ number
+static const char* names[] = {
+  "POWER_ON", "POWER_OFF", "MUTE", "VOLUME_UP", "VOLUME_DOWN", "CHANNEL_UP", "CHANNEL_DOWN",
+  "PROJ_POWER_ON", "PROJ_POWER_OFF", "PROJ_VOLUME_UP", "PROJ_VOLUME_DOWN"
+};
+
+static_assert(NUM_ELEM(names) == NUM_TABLES, "every table in codeTables needs a name here");
+
+#define UNLISTED_TABLE NUM_TABLES //(UNLISTED isn't in codeTables, it goes after them here)
+
+//an entry of the old tables
+struct Golden
+{
+  int table;
+  int index;
+  std::string brand;
+  int carrier; //microseconds of a half period
+  std::vector<BurstPair> bursts;
+};
+
+
+
+const char* toolName = "golden";
+
+static std::vector<Golden> readGolden(const char* path)
+{
+  FILE* file = fopen(path, "r");
+  if(!file) { fail("can't open the golden bursts"); }
+
+  std::vector<Golden> entries;
+  static char line[8192];
+  for(int n = 1; fgets(line, sizeof(line), file); n++)
+  {
+    if(!strchr(line, '\n') && !feof(file)) { fail("line too long (line %d)", n); }
+    if((line[0] == '#') || (line[0] == '\n')) { continue; }
+
+    char table[64];
+    char brand[64];
+    int used;
+    Golden g;
+    if(sscanf(line, "%63s %d %63s %d%n", table, &g.index, brand, &g.carrier, &used) != 4) { fail("expected <table> <index> <brand> <carrier> (line %d)", n); }
+    g.brand = brand;
+    g.table = -1;
+    for(int t = 0; t < NUM_TABLES; t++)
+    {
+      if(!strcmp(table, names[t])) { g.table = t; }
+    }
+    if(!strcmp(table, "UNLISTED")) { g.table = UNLISTED_TABLE; }
+    if(g.table < 0) { fail("no such table (line %d)", n); }
+
+    const char* at = line + used;
+    unsigned on, off;
+    while(sscanf(at, " %u,%u%n", &on, &off, &used) == 2)
+    {
+      BurstPair pair = {(uint16_t)on, (uint16_t)off};
+      g.bursts.push_back(pair);
+      at += used;
+    }
+    if(strspn(at, " \r\n") != strlen(at)) { fail("expected <on>,<off> (line %d)", n); }
+    entries.push_back(g);
+  }
+  fclose(file);
+  return entries;
+}
+
+static const char* nameOf(int table)
+{
+  return (table == UNLISTED_TABLE) ? "UNLISTED" : names[table];
+}
+
+static const IRCode* codesOf(int table)
+{
+  return (table == UNLISTED_TABLE) ? UNLISTED : (const IRCode*)pgm_read_ptr(&codeTables[table].codes);
+}
+
+static uint8_t totalOf(int table)
+{
+  return (table == UNLISTED_TABLE) ? UNLISTED_TOTAL : pgm_read_byte(&codeTables[table].total);
+}
+
+//the entry's bursts, from the cursor or from getCode()
+static std::vector<BurstPair> decode(const IRCode* code, bool heap)
+{
+  std::vector<BurstPair> bursts;
+  if(heap)
+  {
+    BurstPair* pairs = getCode(code);
+    bursts.assign(pairs, pairs + getLength(code));
+    delete[] pairs;
+    return bursts;
+  }
+
+  CodeCursor cursor;
+  BurstPair pair;
+  beginCode(&cursor, code);
+  while(nextBurst(&cursor, &pair)) { bursts.push_back(pair); }
+  return bursts;
+}
+
+//the first burst where the entry differs from its golden one, -1 if none does
+static int firstDifference(const IRCode* code, const Golden& g, bool heap)
+{
+  std::vector<BurstPair> bursts = decode(code, heap);
+  for(size_t i = 0; i < bursts.size(); i++)
+  {
+    if((i == g.bursts.size()) || (bursts[i].on != g.bursts[i].on) || (bursts[i].off != g.bursts[i].off)) { return (int)i; }
+  }
+  return (bursts.size() == g.bursts.size()) ? -1 : (int)bursts.size();
+}
+
+
+
+int main(int argc, char** argv)
+{
+  const char* path = (argc > 1) ? argv[1] : "host/golden.txt";
+  std::vector<Golden> entries = readGolden(path);
+
+  int bad = 0;
+  int checked[NUM_TABLES + 1] = {0};
+  for(size_t i = 0; i < entries.size(); i++)
+  {
+    const Golden& g = entries[i];
+    const IRCode* codes = codesOf(g.table);
+    uint8_t total = totalOf(g.table);
+    if(g.index >= total)
+    {
+      printf("%-17s %2d %-17s missing (the table has %d entries)\n", nameOf(g.table), g.index, g.brand.c_str(), total);
+      bad++;
+      continue;
+    }
+    checked[g.table]++;
+
+    const IRCode* code = codes + g.index;
+    int halfPeriod = (getCarrier(code) + CARRIER_SCALE) / (2 * CARRIER_SCALE); //(rounded)
+    int cursorAt = firstDifference(code, g, false);
+    int heapAt = firstDifference(code, g, true);
+    if(halfPeriod != g.carrier)
+    {
+      printf("%-17s %2d %-17s carrier %dus, expected %dus\n", nameOf(g.table), g.index, g.brand.c_str(), halfPeriod, g.carrier);
+      bad++;
+    }
+    if(cursorAt >= 0)
+    {
+      printf("%-17s %2d %-17s cursor differs from burst %d\n", nameOf(g.table), g.index, g.brand.c_str(), cursorAt);
+      bad++;
+    }
+    if(heapAt >= 0)
+    {
+      printf("%-17s %2d %-17s getCode() differs from burst %d\n", nameOf(g.table), g.index, g.brand.c_str(), heapAt);
+      bad++;
+    }
+  }
+
+  for(int t = 0; t <= UNLISTED_TABLE; t++)
+  {
+    uint8_t total = totalOf(t);
+    if(checked[t] != total)
+    {
+      printf("%-17s has %d entries, %d of them golden\n", nameOf(t), total, checked[t]);
+      bad++;
+    }
+  }
+
+  printf("%d entries checked, %d problems\n", (int)entries.size(), bad);
+  return bad ? 1 : 0;
+}
@@ -0,0 +1,392 @@
+/*
+ * Written by Brendan Whitfield
+ *
+ * Hit cache benchmark.
+ * Builds the sketch itself (IR_Transmit.ino) like latency.cpp does, and puts it in a room of
+ * TVs that are all one of the last brands in the tables (RCA, or else JVC). Each press picks
+ * a TV and one of the TV power, volume or channel buttons, and holds it until that TV sees
+ * its code go by, then lets go after a human reaction time. The TVs watch the emitters,
+ * recognising a code once every burst of it has come out of one of them.
+ *
+ * It's done twice over the same presses, with the cache cleared before every press (the
+ * tables in their fixed order, as before), and with it left to learn. For each, the mean of
+ *
+ *   codes   codes the room saw go by, up to and including the one the TV took
+ *   time    from the press to the TV taking its code
+ *
+ * Then the EEPROM wear: records written, the writes to the busiest byte of the log, and what
+ * the busiest byte would have taken with a record of its own for each table. Also checks
+ * the hits come back the same after the log is read in again, as after a power cut.
+ * Last, that a code that finished a minute and more before the release (past a 16 bit wrap of
+ * millis()) isn't scored. Exits with 1 if a TV never saw its code, or either check fails.
+ *
+ *   g++ -O2 -I host -I . host/hitbench.cpp host/Captures.cpp host/TransmitSim.cpp host/ButtonsSim.cpp host/LearnSim.cpp host/CommandSim.cpp host/HitsSim.cpp Buttons.cpp Learn.cpp Command.cpp Hits.cpp Transmit.cpp Sweep.cpp Codes.cpp Protocols.cpp Pronto.cpp -o hitbench
+ *   ./hitbench [--presses 300] [--rca 70] [--seed 1]
+ */
+
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "Arduino.h"
+#include "Captures.h"
+#include "HitsSim.h"
+
+//the Arduino IDE generates these for the sketch
+void setDisplay(int n);
+
+#include "IR_Transmit.ino"
+
+
+
+#define LOOP_CYCLES  150                     //the sketch's own work in each pass of loop(), besides the calls it makes
+#define CYCLES_MS    (SIM_F_CPU / 1000)
+#define SETTLE       ((BUTTON_DEBOUNCE + 5) * CYCLES_MS) //time left after a release before the next press
+#define REACT_SOONEST 150                    //milliseconds from the TV reacting to the button being let go
+#define REACT_LATEST  450
+#define GIVE_UP      20000                   //milliseconds to hold a button before deciding the TV never saw its code
+#define ENDURANCE    100000                  //writes an ATmega328 EEPROM cell is good for
+
+//where each brand sits in the TV tables (codes/manifest.txt)
+#define RCA_FROM_END 1
+#define JVC_FROM_END 2
+
+//the buttons pressed: the banks of IR_Transmit.ino with a TV table on each button
+struct Button
+{
+  uint8_t       bank;
+  uint8_t       button; //BUTTON_UP or BUTTON_DOWN
+  const IRCode* table;
+  uint8_t       total;
+};
+
+static const Button buttons[] = {
+  {0, BUTTON_UP, POWER_ON, POWER_ON_TOTAL},
+  {0, BUTTON_DOWN, POWER_OFF, POWER_OFF_TOTAL},
+  {1, BUTTON_UP, VOLUME_UP, VOLUME_UP_TOTAL},
+  {1, BUTTON_DOWN, VOLUME_DOWN, VOLUME_DOWN_TOTAL},
+  {2, BUTTON_UP, CHANNEL_UP, CHANNEL_UP_TOTAL},
+  {2, BUTTON_DOWN, CHANNEL_DOWN, CHANNEL_DOWN_TOTAL}
+};
+
+#define NUM_BUTTONS NUM_ELEM(buttons)
+
+//a press, decided up front so both runs make the same ones
+struct Press
+{
+  uint8_t  button; //into buttons[]
+  uint8_t  index;  //of the TV's code in the table
+  uint32_t react;  //milliseconds to let go after the TV takes its code
+};
+
+//ON, OFF, ON... of a code in carrier cycles, as the emitters put it out (the last OFF is left off)
+typedef std::vector<uint32_t> Signature;
+
+//a channel's emitter, as a TV sees it
+struct Watcher
+{
+  size_t seen;                  //ticks looked at
+  uint32_t on;                  //cycles of the mark so far
+  uint32_t idle;                //ticks since it ended
+  std::vector<uint32_t> bursts; //ON, OFF, ON... so far
+};
+
+struct Result
+{
+  double codes;
+  double ms;
+  uint32_t recorded[NUM_BUTTONS]; //releases that wrote a record for each button's table
+};
+
+
+
+static Watcher watchers[SEND_CHANNELS];
+static std::vector<Signature> signatures[NUM_BUTTONS]; //of every code of each button's table
+
+
+
+const char* toolName = "hitbench";
+
+static void pass()
+{
+  loop();
+  simRun(simNow() + LOOP_CYCLES);
+}
+
+//runs the sketch until `at` (cpu cycles)
+static void runUntil(uint64_t at)
+{
+  while(simNow() < at) { pass(); }
+}
+
+static void tap(uint8_t button)
+{
+  uint64_t at = simNow() + CYCLES_MS;
+  simSetButtons(at, 1 << button);
+  simSetButtons(at + 50 * CYCLES_MS, 0);
+  runUntil(at + 50 * CYCLES_MS + SETTLE);
+}
+
+//what one channel put out, from tick `from` on
+static std::vector<uint32_t> emitted(uint8_t channel, size_t from)
+{
+  const std::vector<SimTick>& ticks = simTicks(channel);
+  std::vector<uint32_t> found;
+  uint32_t on = 0;
+  uint32_t idle = 0;
+
+  for(size_t i = from; i < ticks.size(); i++)
+  {
+    if(ticks[i].level == 1)
+    {
+      if(on && idle)
+      {
+        found.push_back(on);
+        found.push_back(idle / 2);
+        on = 0;
+        idle = 0;
+      }
+      on++;
+    }
+    else if((ticks[i].level == SIM_IDLE) && on) { idle++; }
+  }
+  found.push_back(on);
+  return found;
+}
+
+//sends every code of the tables on its own, to see what the emitter makes of it
+static void learnSignatures()
+{
+  beginTransmit();
+  for(uint8_t b = 0; b < NUM_BUTTONS; b++)
+  {
+    for(uint8_t i = 0; i < buttons[b].total; i++)
+    {
+      simReset();
+      sendCode(buttons[b].table + i);
+      while(simStep()) {}
+      signatures[b].push_back(emitted(0, 0));
+    }
+  }
+}
+
+static bool near(uint32_t a, uint32_t b)
+{
+  return (a + 1 >= b) && (b + 1 >= a);
+}
+
+//true if the channel's latest bursts are the code
+static bool matches(const Watcher& w, const Signature& s)
+{
+  if(!near(w.on, s.back()) || (w.bursts.size() + 1 < s.size())) { return false; }
+
+  size_t from = w.bursts.size() + 1 - s.size();
+  for(size_t i = 0; i + 1 < s.size(); i++)
+  {
+    if(!near(w.bursts[from + i], s[i])) { return false; }
+  }
+  return true;
+}
+
+//codes of the table that have come out since the last look, in the order they finished.
+//Returns the time the TV's code did, or 0 if it hasn't yet
+static uint64_t watch(uint8_t button, uint8_t index, uint32_t* codes)
+{
+  uint64_t took = 0;
+  for(;;)
+  {
+    //the next tick, on whichever channel it came first
+    int channel = -1;
+    for(uint8_t c = 0; c < SEND_CHANNELS; c++)
+    {
+      const std::vector<SimTick>& ticks = simTicks(c);
+      if(watchers[c].seen >= ticks.size()) { continue; }
+      if((channel < 0) || (ticks[watchers[c].seen].time < simTicks(channel)[watchers[channel].seen].time)) { channel = c; }
+    }
+    if(channel < 0) { return took; }
+
+    Watcher& w = watchers[channel];
+    const SimTick& tick = simTicks(channel)[w.seen++];
+    if(tick.level == 1)
+    {
+      if(w.on && w.idle)
+      {
+        w.bursts.push_back(w.on);
+        w.bursts.push_back(w.idle / 2);
+        w.on = 0;
+        w.idle = 0;
+      }
+      w.on++;
+    }
+    else if((tick.level == SIM_IDLE) && w.on)
+    {
+      //the first tick after a mark, see if it finished a code
+      if(w.idle++ == 0)
+      {
+        for(size_t i = 0; i < signatures[button].size(); i++)
+        {
+          if(!matches(w, signatures[button][i])) { continue; }
+          (*codes)++;
+          if((i == index) && !took) { took = tick.time; }
+          break;
+        }
+      }
+    }
+  }
+}
+
+static void forget()
+{
+  simForget();
+  for(uint8_t c = 0; c < SEND_CHANNELS; c++)
+  {
+    watchers[c].seen = 0;
+    watchers[c].on = 0;
+    watchers[c].idle = 0;
+    watchers[c].bursts.clear();
+  }
+}
+
+static Result run(const std::vector<Press>& presses, bool cache)
+{
+  Result result;
+  memset(&result, 0, sizeof(result));
+  uint64_t codes = 0;
+  uint64_t cycles = 0;
+
+  for(size_t p = 0; p < presses.size(); p++)
+  {
+    const Press& press = presses[p];
+    const Button& button = buttons[press.button];
+    if(!cache)
+    {
+      simEraseHits();
+      beginHits();
+    }
+
+    while(bankNum != button.bank) { tap(BUTTON_BANK); }
+    forget();
+
+    //hold it until the TV takes its code
+    uint64_t down = simNow() + CYCLES_MS;
+    simSetButtons(down, 1 << button.button);
+    uint32_t seen = 0;
+    uint64_t took = 0;
+    while(!took)
+    {
+      pass();
+      took = watch(press.button, press.index, &seen);
+      if(simNow() - down > (uint64_t)GIVE_UP * CYCLES_MS) { fail("a TV never saw its code"); }
+    }
+    codes += seen;
+    cycles += took - down;
+
+    //then let go, and wait for the send and the debounce to finish
+    uint32_t records = simHitRecords();
+    uint64_t release = took + press.react * CYCLES_MS;
+    simSetButtons(release, 0);
+    while((simNow() < release + SETTLE) || isSending()) { pass(); }
+    if(simHitRecords() != records) { result.recorded[press.button]++; }
+  }
+
+  result.codes = (double)codes / presses.size();
+  result.ms = (double)cycles / presses.size() / CYCLES_MS;
+  return result;
+}
+
+//sends a code of the first button's table as a sweep would, and lets go `after` ms once it's out. Returns if it was scored
+static bool scoredAfter(unsigned long after)
+{
+  simEraseHits();
+  beginHits();
+  const IRCode* table = buttons[0].table;
+  watchSweep(table);
+  int ticket = sendCode(table);
+  if(ticket < 0) { fail("can't queue a code"); }
+  watchCode(0, ticket);
+  while(getSendStatus(ticket) != SEND_DONE) { pass(); }
+  updateHits(millis());
+  sweepReleased(millis() + after);
+
+  uint8_t hits[HITS_DEPTH];
+  return getHits(table, hits) != 0;
+}
+
+int main(int argc, char** argv)
+{
+  int count = 300;
+  int rca = 70;
+  int seed = 1;
+  for(int i = 1; i < argc; i++)
+  {
+    if(!strcmp(argv[i], "--presses") && (i + 1 < argc))  { count = atoi(argv[++i]); }
+    else if(!strcmp(argv[i], "--rca") && (i + 1 < argc))  { rca = atoi(argv[++i]); }
+    else if(!strcmp(argv[i], "--seed") && (i + 1 < argc)) { seed = atoi(argv[++i]); }
+    else { fail("usage: hitbench [--presses 300] [--rca 70] [--seed 1]"); }
+  }
+  if((count < 1) || (rca < 0) || (rca > 100)) { fail("bad --presses or --rca"); }
+
+  srand(seed);
+  std::vector<Press> presses;
+  for(int p = 0; p < count; p++)
+  {
+    Press press;
+    press.button = rand() % NUM_BUTTONS;
+    press.index = buttons[press.button].total - (((rand() % 100) < rca) ? RCA_FROM_END : JVC_FROM_END);
+    press.react = REACT_SOONEST + rand() % (REACT_LATEST - REACT_SOONEST + 1);
+    presses.push_back(press);
+  }
+
+  learnSignatures();
+  simReset();
+  setup();
+
+  printf("%d presses, TVs %d%% RCA and %d%% JVC, let go %d-%d ms after the TV reacts\n\n",
+         count, rca, 100 - rca, REACT_SOONEST, REACT_LATEST);
+
+  Result before = run(presses, false);
+  printf("tables in their fixed order: %.2f codes, %.0f ms to the TV's code\n", before.codes, before.ms);
+
+  simEraseHits();
+  beginHits();
+  Result after = run(presses, true);
+  printf("with the hit cache:          %.2f codes, %.0f ms to the TV's code\n\n", after.codes, after.ms);
+
+  //wear
+  uint32_t busiest = 0;
+  for(uint16_t i = 0; i < HITS_SLOTS * sizeof(HitRecord); i++)
+  {
+    if(simHitWrites(i) > busiest) { busiest = simHitWrites(i); }
+  }
+  uint32_t recorded = 0;
+  uint32_t own = 0; //busiest byte with a record of its own per table
+  for(uint8_t b = 0; b < NUM_BUTTONS; b++)
+  {
+    recorded += after.recorded[b];
+    if(after.recorded[b] > own) { own = after.recorded[b]; }
+  }
+  printf("EEPROM: %u of %d releases recorded, %u records written (%u slots of %u bytes)\n",
+         recorded, count, simHitRecords(), HITS_SLOTS, (unsigned)sizeof(HitRecord));
+  printf("  busiest byte written %u times (%u with a record of its own per table)\n", busiest, own);
+  if(busiest) { printf("  good for about %.0f releases like these\n", (double)ENDURANCE * recorded / busiest); }
+
+  //the hits once the log's read in again
+  uint8_t hits[NUM_BUTTONS][HITS_DEPTH];
+  uint8_t found[NUM_BUTTONS];
+  for(uint8_t b = 0; b < NUM_BUTTONS; b++) { found[b] = getHits(buttons[b].table, hits[b]); }
+  beginHits();
+  bool same = true;
+  for(uint8_t b = 0; b < NUM_BUTTONS; b++)
+  {
+    uint8_t again[HITS_DEPTH];
+    same &= (getHits(buttons[b].table, again) == found[b]) && !memcmp(again, hits[b], found[b]);
+  }
+  printf("  hits after reading the log in again: %s\n", same ? "the same" : "DIFFERENT");
+
+  //a button held for as long as 16 bits of millis() go round finished nothing HITS_REACTION before its release
+  bool wraps = scoredAfter(HITS_REACTION) && !scoredAfter(0x10000UL + HITS_REACTION);
+  printf("  code that finished a 16 bit wrap of millis() before the release: %s\n", wraps ? "not scored" : "SCORED");
+  return (same && wraps) ? 0 : 1;
+}
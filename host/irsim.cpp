@@ -0,0 +1,553 @@
+/*
+ * Written by Brendan Whitfield
+ *
+ * Waveform simulator and timing benchmark.
+ * Sends every table entry through the real transmit engine (sendCode() and the timer
+ * interrupt) into the simulated port of TransmitSim.cpp, and compares what comes out
+ * with the Pronto capture the entry was generated from (see codes/manifest.txt).
+ *
+ * For each entry:
+ *   carrier  frequency of the emitted carrier, against the capture's (percent error)
+ *   duty     share of the frame spent sending carrier, against the capture's (percentage points)
+ *   frame    first mark to the end of the last space, against the capture's (percent error)
+ *   high     share of each carrier cycle the emitters are lit, against SEND_DUTY (percentage points)
+ *
+ * Exits with 1 if any entry is further off than the tolerance.
+ *
+ * --sweep TABLE[,TABLE...] times a sweep of the tables (Sweep.cpp) code by code, against
+ * sending them in table order with SEND_GAP after each, as a held button used to, and
+ * against the same sweep on a single emitter. Every code of the sweep is then checked as
+ * above, on its own pin, so two channels at once mustn't throw either of them off.
+ *
+ *   g++ -O2 -I host -I . host/irsim.cpp host/Captures.cpp host/TransmitSim.cpp Transmit.cpp Sweep.cpp Codes.cpp Protocols.cpp Pronto.cpp -o irsim
+ *   ./irsim [--manifest codes/manifest.txt] [--tolerance 0.5] [--timeline TABLE INDEX] [--scale 100]
+ *   ./irsim --sweep POWER_OFF,PROJ_POWER_OFF
+ */
+
+
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <map>
+#include <string>
+#include <vector>
+#include "Captures.h"
+#include "TransmitSim.h"
+#include "Sweep.h"
+
+
+
+#define STRIP_WIDTH 100 //characters per line of a rendered timeline
+
+const char* toolName = "irsim";
+
+struct Table
+{
+  const char*    name;
+  const IRCode*  codes;
+  uint8_t        total;
+};
+
+#define TABLE(t) {#t, t, t##_TOTAL}
+
+//every table in Codes.h
+static const Table tables[] = {
+  TABLE(POWER_ON), TABLE(POWER_OFF), TABLE(MUTE), TABLE(VOLUME_UP), TABLE(VOLUME_DOWN),
+  TABLE(CHANNEL_UP), TABLE(CHANNEL_DOWN),
+  TABLE(PROJ_POWER_ON), TABLE(PROJ_POWER_OFF), TABLE(PROJ_VOLUME_UP), TABLE(PROJ_VOLUME_DOWN)
+};
+
+//a capture listed in the manifest
+struct Source
+{
+  std::string table;
+  std::string brand;
+  std::string function;
+  double period;               //microseconds per carrier cycle
+  std::vector<uint16_t> words; //on, off, on, off... in carrier cycles
+};
+
+//a code handed to the engine, and when it went out
+struct Send
+{
+  const IRCode* code;
+  int ticket;
+  size_t started;  //tick its first edge went out on (0 until then), of its channel's ticks
+  size_t finished; //tick its last part ended on
+  uint64_t start;  //cpu cycles
+  uint64_t end;
+};
+
+//timing of a code, either as captured or as simulated
+struct Timing
+{
+  double carrier; //Hz
+  double duty;    //fraction of the frame spent sending carrier
+  double frame;   //microseconds
+  double high;    //fraction of each carrier cycle spent HIGH
+};
+
+
+
+//every capture the manifest lists, in order
+static std::vector<Source> readManifest(const std::string& path)
+{
+  std::string base = path.substr(0, path.find_last_of('/') + 1);
+  std::map<std::string, std::vector<Capture> > files;
+  std::vector<Source> sources;
+
+  FILE* f = fopen(path.c_str(), "r");
+  if(!f) { fail("can't open %s", path.c_str()); }
+
+  char line[1024];
+  for(int n = 1; fgets(line, sizeof(line), f); n++)
+  {
+    char* comment = strchr(line, '#');
+    if(comment) { *comment = '\0'; }
+
+    char table[64], brand[64], function[64], file[256], key[128];
+    int fields = sscanf(line, "%63s %63s %63s %255s %127s", table, brand, function, file, key);
+    if(fields <= 0 || table[0] == '@') { continue; }
+    if(fields < 4) { fail("%s:%d: expected <table> <brand> <function> <file> [<key>]", path.c_str(), n); }
+    if(fields < 5) { snprintf(key, sizeof(key), "%s_%s", brand, function); }
+
+    std::string name = base + file;
+    if(!files.count(name)) { files[name] = readCaptures(name); }
+    const Capture& capture = findCapture(files[name], key, name);
+
+    //the once sequence, followed by one pass of the repeat sequence (same as gencodes.py)
+    Source source;
+    source.table = table;
+    source.brand = brand;
+    source.function = function;
+    source.period = capture.period;
+    source.words.assign(capture.words.begin() + 4, capture.words.end());
+    sources.push_back(source);
+  }
+
+  fclose(f);
+  return sources;
+}
+
+
+
+static Timing captured(const Source& source)
+{
+  double mark = 0;
+  double total = 0;
+  for(size_t i = 0; i < source.words.size(); i++)
+  {
+    if(i % 2 == 0) { mark += source.words[i]; }
+    total += source.words[i];
+  }
+
+  Timing t;
+  t.carrier = 1e6 / source.period;
+  t.duty = mark / total;
+  t.frame = total * source.period;
+  t.high = SEND_DUTY / 100.0;
+  return t;
+}
+
+//sends a code through the engine, and leaves its interrupts in simTicks(). Returns the time it finished
+static uint64_t run(const IRCode* code)
+{
+  simReset();
+  int ticket = sendCode(code);
+  size_t done = 0;
+
+  //the engine stops the timer once the trailing gap is over
+  while(simStep())
+  {
+    if(!done && getSendStatus(ticket) == SEND_DONE) { done = simTicks().size(); }
+  }
+
+  //the engine works a tick ahead of the emitters, so the code's last part ends at the next tick
+  return simTicks()[done].time;
+}
+
+//timing of what a channel put out from tick `from` up to `done`
+static Timing measure(const std::vector<SimTick>& ticks, size_t from, uint64_t done)
+{
+  //each interrupt sets the level until the next one
+  uint64_t start = 0;
+  uint64_t mark = 0;
+  uint64_t high = 0;
+  uint32_t cycles = 0;
+  for(size_t i = from; i + 1 < ticks.size() && ticks[i].time < done; i++)
+  {
+    if(ticks[i].level == SIM_IDLE) { continue; }
+
+    uint64_t length = ticks[i + 1].time - ticks[i].time;
+    if(!mark) { start = ticks[i].time; }
+    mark += length;
+    if(ticks[i].level) { high += length; cycles++; }
+  }
+
+  Timing t;
+  t.carrier = (double)cycles * SIM_F_CPU / mark;
+  t.duty = (double)mark / (done - start);
+  t.frame = (done - start) * 1e6 / SIM_F_CPU;
+  t.high = (double)high / mark;
+  return t;
+}
+
+static Timing simulated(const IRCode* code)
+{
+  uint64_t done = run(code);
+  return measure(simTicks(), 0, done);
+}
+
+//percent errors of `got` against `want` (percentage points for duty and high), the worst kept in `worst`. True if any is past the tolerance
+static bool compareTiming(const Timing& got, const Timing& want, double tolerance, double* error, double* worst)
+{
+  error[0] = (got.carrier - want.carrier) * 100 / want.carrier;
+  error[1] = (got.duty - want.duty) * 100;
+  error[2] = (got.frame - want.frame) * 100 / want.frame;
+  error[3] = (got.high - want.high) * 100;
+
+  bool bad = false;
+  for(int e = 0; e < 4; e++)
+  {
+    if(fabs(error[e]) > fabs(worst[e])) { worst[e] = error[e]; }
+    if(fabs(error[e]) > tolerance)      { bad = true; }
+  }
+  return bad;
+}
+
+
+
+//lists each burst as sent next to the capture, then draws the whole frame to scale
+static void timeline(const Table* table, int index, const Source& source, double scale)
+{
+  uint64_t done = run(table->codes + index);
+  const std::vector<SimTick>& ticks = simTicks();
+  Timing t = simulated(table->codes + index);
+
+  printf("%s[%d]: %s %s, carrier %.2f kHz (capture %.2f kHz), HIGH for %.0f%% of each cycle\n\n",
+         table->name, index, source.brand.c_str(), source.function.c_str(),
+         t.carrier / 1000, 1000 / source.period, t.high * 100);
+
+  //runs of carrier and silence, in microseconds
+  std::vector<double> runs;
+  bool carrier = false;
+  for(size_t i = 0; i + 1 < ticks.size() && ticks[i].time < done; i++)
+  {
+    bool on = ticks[i].level != SIM_IDLE;
+    if(runs.empty() && !on) { continue; }
+
+    double length = (ticks[i + 1].time - ticks[i].time) * 1e6 / SIM_F_CPU;
+    if(runs.empty() || on != carrier) { runs.push_back(0); }
+    runs.back() += length;
+    carrier = on;
+  }
+
+  printf("burst      mark us  (capture)     space us  (capture)\n");
+  for(size_t i = 0; i < runs.size() || i < source.words.size(); i++)
+  {
+    if(i % 2 == 0) { printf("%5d ", (int)(i / 2)); }
+    if(i < runs.size()) { printf("%12.1f", runs[i]); } else { printf("%12s", "-"); }
+    if(i < source.words.size()) { printf("  (%7.1f)", source.words[i] * source.period); } else { printf("  (%7s)", "-"); }
+    if(i % 2 == 1) { printf("\n"); }
+  }
+  if(runs.size() % 2) { printf("\n"); }
+
+  printf("\n%.0f us per character, # carrier, _ silence\n", scale);
+  std::string strip;
+  double at = 0;
+  for(size_t i = 0; i < runs.size(); i++)
+  {
+    double end = at + runs[i];
+    while((strip.size() + 0.5) * scale < end) { strip += (i % 2) ? '_' : '#'; }
+    at = end;
+  }
+  for(size_t i = 0; i < strip.size(); i += STRIP_WIDTH)
+  {
+    printf("%9.0f  %s\n", i * scale, strip.substr(i, STRIP_WIDTH).c_str());
+  }
+}
+
+
+
+//runs the timer to its next interrupt, noting any sends that started or finished
+static bool step(std::vector<Send>& sends)
+{
+  if(!simStep()) { return false; }
+
+  //the engine works a tick ahead of the emitters, so what it starts or finishes now shows at the next tick
+  //(of the send's own channel, the other one's ticks don't move it along)
+  for(size_t i = 0; i < sends.size(); i++)
+  {
+    if(sends[i].finished) { continue; }
+
+    size_t tick = simTicks(SEND_CHANNEL(sends[i].ticket)).size();
+    uint8_t status = getSendStatus(sends[i].ticket);
+    if(!sends[i].started && status != SEND_QUEUED) { sends[i].started = tick; }
+    if(status == SEND_DONE)                         { sends[i].finished = tick; }
+  }
+  return true;
+}
+
+static void finish(std::vector<Send>& sends)
+{
+  while(step(sends));
+
+  for(size_t i = 0; i < sends.size(); i++)
+  {
+    const std::vector<SimTick>& ticks = simTicks(SEND_CHANNEL(sends[i].ticket));
+    sends[i].start = ticks[sends[i].started].time;
+    sends[i].end = ticks[sends[i].finished].time;
+  }
+}
+
+//every code in table order, with SEND_GAP after each (a held button before sweeps)
+static std::vector<Send> sendInOrder(const std::vector<const Table*>& list)
+{
+  std::vector<Send> sends;
+  simReset();
+
+  for(size_t t = 0; t < list.size(); t++)
+  {
+    for(int i = 0; i < list[t]->total; i++)
+    {
+      Send send = {list[t]->codes + i, SEND_FULL, 0, 0, 0, 0};
+      while((send.ticket = sendCode(send.code)) == SEND_FULL) { step(sends); }
+      sends.push_back(send);
+    }
+  }
+
+  finish(sends);
+  return sends;
+}
+
+static std::vector<Send> sendSweep(const std::vector<const Table*>& list, uint8_t channels)
+{
+  std::vector<Send> sends;
+  simReset();
+
+  beginSweep(list[0]->codes, list[0]->total, channels);
+  for(size_t t = 1; t < list.size(); t++)
+  {
+    if(!addToSweep(list[t]->codes, list[t]->total)) { fail("a sweep covers at most %d tables, and %d codes", SWEEP_TABLES, SWEEP_CODES); }
+  }
+
+  for(;;)
+  {
+    Send send = {NULL, SEND_FULL, 0, 0, 0, 0};
+    send.ticket = sweep(&send.code);
+    if(send.ticket == SWEEP_DONE) { break; }
+    if(send.ticket == SEND_FULL)  { step(sends); continue; }
+    sends.push_back(send);
+  }
+
+  finish(sends);
+  return sends;
+}
+
+//the capture a send was generated from, and its name as TABLE[index]
+static const Source* sourceOf(const Send& send, const std::vector<const Table*>& list, const std::vector<Source>& sources,
+                              char* name, size_t size)
+{
+  snprintf(name, size, "?");
+  for(size_t t = 0; t < list.size(); t++)
+  {
+    int i = send.code - list[t]->codes;
+    if(i < 0 || i >= list[t]->total) { continue; }
+
+    snprintf(name, size, "%s[%d]", list[t]->name, i);
+    for(size_t s = 0; s < sources.size(); s++)
+    {
+      if(sources[s].table == list[t]->name && i-- == 0) { return &sources[s]; }
+    }
+    break;
+  }
+  return NULL;
+}
+
+//prints each send, returns the time from the first edge to the end of the last code
+static double listSends(const char* title, const std::vector<Send>& sends, const std::vector<const Table*>& list,
+                        const std::vector<Source>& sources)
+{
+  printf("%s\n", title);
+  printf("%4s  %-20s %-18s %3s %7s %9s %9s %8s\n", "#", "code", "brand", "pin", "kHz", "start ms", "length ms", "gap ms");
+
+  uint64_t first = sends[0].start;
+  uint64_t last = 0;
+  for(size_t n = 0; n < sends.size(); n++)
+  {
+    const Send& send = sends[n];
+    char name[32];
+    const Source* source = sourceOf(send, list, sources, name, sizeof(name));
+    uint8_t channel = SEND_CHANNEL(send.ticket);
+
+    printf("%4d  %-20s %-18s %3d %7.2f %9.2f %9.2f", (int)n, name, source ? source->brand.c_str() : "?", channel,
+           (double)CARRIER_SCALE * 1000 / getCarrier(send.code),
+           (send.start - first) * 1000.0 / SIM_F_CPU, (send.end - send.start) * 1000.0 / SIM_F_CPU);
+    if(send.end > last) { last = send.end; }
+
+    //gap before the next code on the same emitter
+    size_t next = n + 1;
+    while(next < sends.size() && SEND_CHANNEL(sends[next].ticket) != channel) { next++; }
+    if(next < sends.size()) { printf(" %8.2f\n", (sends[next].start - send.end) * 1000.0 / SIM_F_CPU); }
+    else                    { printf(" %8s\n", "-"); }
+  }
+
+  double total = (last - first) * 1000.0 / SIM_F_CPU;
+  printf("total %.2f ms, timer set up %u times\n\n", total, simStarts());
+  return total;
+}
+
+//checks every code of a sweep against its capture, on the pin it went out on. Returns how many drift
+static int checkSends(const std::vector<Send>& sends, const std::vector<const Table*>& list,
+                      const std::vector<Source>& sources, double tolerance)
+{
+  double worst[4] = {0, 0, 0, 0};
+  int drifted = 0;
+
+  for(size_t n = 0; n < sends.size(); n++)
+  {
+    char name[32];
+    const Source* source = sourceOf(sends[n], list, sources, name, sizeof(name));
+    if(!source) { continue; }
+
+    const std::vector<SimTick>& ticks = simTicks(SEND_CHANNEL(sends[n].ticket));
+    Timing got = measure(ticks, sends[n].started, sends[n].end);
+    double error[4];
+    if(compareTiming(got, captured(*source), tolerance, error, worst))
+    {
+      printf("%s on pin %d drifts: carrier %+.2f%%, duty %+.2f points, frame %+.2f%%, high %+.2f points\n",
+             name, SEND_CHANNEL(sends[n].ticket), error[0], error[1], error[2], error[3]);
+      drifted++;
+    }
+  }
+
+  printf("each pin on its own, worst: carrier %+.2f%%, duty %+.2f points, frame %+.2f%%, high %+.2f points\n",
+         worst[0], worst[1], worst[2], worst[3]);
+  printf("%d of %d codes drift past %.2f%%\n", drifted, (int)sends.size(), tolerance);
+  return drifted;
+}
+
+static int timeSweep(const char* names, const std::vector<Source>& sources, double tolerance)
+{
+  std::vector<const Table*> list;
+  std::string all = names;
+  size_t start = 0;
+  while(start <= all.size())
+  {
+    size_t stop = all.find(',', start);
+    if(stop == std::string::npos) { stop = all.size(); }
+    std::string name = all.substr(start, stop - start);
+
+    const Table* table = NULL;
+    for(size_t n = 0; n < sizeof(tables) / sizeof(*tables); n++)
+    {
+      if(name == tables[n].name) { table = tables + n; }
+    }
+    if(!table) { fail("no table %s", name.c_str()); }
+    list.push_back(table);
+    start = stop + 1;
+  }
+
+  std::vector<Send> before = sendInOrder(list);
+  double slow = listSends("in table order, SEND_GAP after each:", before, list, sources);
+  std::vector<Send> single = sendSweep(list, 1);
+  double one = listSends("sweep, grouped by carrier, protocol gaps:", single, list, sources);
+  std::vector<Send> after = sendSweep(list, SEND_CHANNELS);
+  double fast = listSends("sweep, shared out over every emitter:", after, list, sources);
+
+  printf("sweep takes %.2f ms instead of %.2f ms (%.0f%% less)\n", one, slow, (slow - one) * 100 / slow);
+  printf("over %d emitters, %.2f ms (%.0f%% less again)\n\n", SEND_CHANNELS, fast, (one - fast) * 100 / one);
+  return checkSends(after, list, sources, tolerance);
+}
+
+
+
+int main(int argc, char** argv)
+{
+  std::string manifest = "codes/manifest.txt";
+  double tolerance = 0.5;
+  const char* show = NULL;
+  int showIndex = 0;
+  const char* sweepTables = NULL;
+  double scale = 100;
+
+  for(int i = 1; i < argc; i++)
+  {
+    if(!strcmp(argv[i], "--manifest") && i + 1 < argc)       { manifest = argv[++i]; }
+    else if(!strcmp(argv[i], "--tolerance") && i + 1 < argc) { tolerance = atof(argv[++i]); }
+    else if(!strcmp(argv[i], "--scale") && i + 1 < argc)     { scale = atof(argv[++i]); }
+    else if(!strcmp(argv[i], "--timeline") && i + 2 < argc)  { show = argv[++i]; showIndex = atoi(argv[++i]); }
+    else if(!strcmp(argv[i], "--sweep") && i + 1 < argc)     { sweepTables = argv[++i]; }
+    else
+    {
+      fprintf(stderr, "usage: irsim [--manifest codes/manifest.txt] [--tolerance 0.5] [--timeline TABLE INDEX] [--scale 100]\n"
+                      "       irsim [--manifest codes/manifest.txt] --sweep TABLE[,TABLE...]\n");
+      return 2;
+    }
+  }
+
+  std::vector<Source> sources = readManifest(manifest);
+  beginTransmit();
+
+  bool quiet = show || sweepTables;
+  if(!quiet)
+  {
+    printf("%-17s %3s  %-18s %8s %8s %6s  %6s %6s %6s  %8s %8s %6s  %6s %6s\n",
+           "table", "#", "brand", "kHz", "capture", "err%", "duty%", "capt", "err", "frame ms", "capture", "err%", "high%", "err");
+  }
+
+  int checked = 0;
+  int drifted = 0;
+  double worst[4] = {0, 0, 0, 0};
+
+  for(size_t n = 0; n < sizeof(tables) / sizeof(*tables); n++)
+  {
+    const Table* table = tables + n;
+    std::vector<const Source*> entries;
+    for(size_t i = 0; i < sources.size(); i++)
+    {
+      if(sources[i].table == table->name) { entries.push_back(&sources[i]); }
+    }
+    if(entries.size() != table->total)
+    {
+      fail("%s has %d entries, but %d in %s (run tools/gencodes.py)", table->name, table->total, (int)entries.size(), manifest.c_str());
+    }
+
+    for(int i = 0; i < table->total; i++)
+    {
+      if(sweepTables) { continue; }
+      if(show)
+      {
+        if(!strcmp(show, table->name) && i == showIndex) { timeline(table, i, *entries[i], scale); return 0; }
+        continue;
+      }
+
+      Timing want = captured(*entries[i]);
+      Timing got = simulated(table->codes + i);
+      double error[4];
+      bool bad = compareTiming(got, want, tolerance, error, worst);
+      checked++;
+      if(bad) { drifted++; }
+
+      printf("%-17s %3d  %-18s %8.2f %8.2f %+6.2f  %6.1f %6.1f %+6.2f  %8.2f %8.2f %+6.2f  %6.1f %+6.2f%s\n",
+             table->name, i, entries[i]->brand.c_str(),
+             got.carrier / 1000, want.carrier / 1000, error[0],
+             got.duty * 100, want.duty * 100, error[1],
+             got.frame / 1000, want.frame / 1000, error[2],
+             got.high * 100, error[3],
+             bad ? "  DRIFT" : "");
+    }
+  }
+
+  if(show) { fail("no entry %s[%d]", show, showIndex); }
+  if(sweepTables)
+  {
+    return timeSweep(sweepTables, sources, tolerance) ? 1 : 0;
+  }
+
+  printf("\nworst: carrier %+.2f%%, duty %+.2f points, frame %+.2f%%, high %+.2f points\n", worst[0], worst[1], worst[2], worst[3]);
+  printf("%d of %d entries drift past %.2f%%\n", drifted, checked, tolerance);
+  return drifted ? 1 : 0;
+}
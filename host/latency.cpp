@@ -0,0 +1,124 @@
+/*
+ * Written by Brendan Whitfield
+ *
+ * Button latency benchmark.
+ * Builds the sketch itself (IR_Transmit.ino) against the stand-in Arduino core, the simulated
+ * timer and the simulated buttons, then presses UP at random moments and times each press
+ * to the first rising edge on either emitter. Also reports how much of the time between
+ * presses the cpu spent asleep.
+ * --analog reads the buttons the way the sketch did before Buttons.cpp (an analogRead() of
+ * each pin every pass, and no sleep), for the figures to compare against.
+ *
+ *   g++ -O2 -I host -I . host/latency.cpp host/Captures.cpp host/TransmitSim.cpp host/ButtonsSim.cpp host/LearnSim.cpp host/CommandSim.cpp host/HitsSim.cpp Buttons.cpp Learn.cpp Command.cpp Hits.cpp Transmit.cpp Sweep.cpp Codes.cpp Protocols.cpp Pronto.cpp -o latency
+ *   ./latency [--presses 200] [--analog]
+ */
+
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Arduino.h"
+#include "Captures.h"
+
+//the Arduino IDE generates these for the sketch
+void setDisplay(int n);
+
+#include "IR_Transmit.ino"
+
+
+
+#define LOOP_CYCLES 150                     //the sketch's own work in each pass of loop(), besides the calls it makes
+#define CYCLES_MS   (SIM_F_CPU / 1000)
+#define SETTLE      ((BUTTON_DEBOUNCE + 5) * CYCLES_MS) //time left after a release before the next press
+
+
+
+const char* toolName = "latency";
+
+static void pass()
+{
+  loop();
+  simRun(simNow() + LOOP_CYCLES);
+}
+
+//finds the first tick since `from` that lit either emitter
+static bool litSince(uint64_t from, uint64_t* edge)
+{
+  static size_t seen[SEND_CHANNELS]; //ticks already looked at
+  bool lit = false;
+
+  for(uint8_t channel = 0; channel < SEND_CHANNELS; channel++)
+  {
+    const std::vector<SimTick>& ticks = simTicks(channel);
+    for(; seen[channel] < ticks.size(); seen[channel]++)
+    {
+      const SimTick& tick = ticks[seen[channel]];
+      if((tick.time >= from) && (tick.level == 1))
+      {
+        if(!lit || (tick.time < *edge)) { *edge = tick.time; }
+        lit = true;
+        seen[channel]++;
+        break;
+      }
+    }
+  }
+  return lit;
+}
+
+int main(int argc, char** argv)
+{
+  int presses = 200;
+  for(int i = 1; i < argc; i++)
+  {
+    if(!strcmp(argv[i], "--presses") && (i + 1 < argc)) { presses = atoi(argv[++i]); }
+    else if(!strcmp(argv[i], "--analog")) { simAnalogButtons(true); }
+    else { fail("usage: latency [--presses N] [--analog]"); }
+  }
+  if(presses < 1) { fail("need at least one press"); }
+
+  srand(1);
+  simReset();
+  setup();
+
+  double total = 0;
+  double best = 1e9;
+  double worst = 0;
+  uint64_t idle = 0;
+  uint64_t asleep = 0;
+
+  for(int p = 0; p < presses; p++)
+  {
+    //idle for a while, then press UP somewhere in the middle of a pass of loop()
+    uint64_t press = simNow() + CYCLES_MS + (rand() % (10 * CYCLES_MS));
+    simSetButtons(press, 1 << BUTTON_UP);
+
+    uint64_t slept = simSlept();
+    uint64_t from = simNow();
+    uint64_t edge = 0;
+    while(simNow() < press) { pass(); }
+    idle += press - from;
+    asleep += simSlept() - slept;
+
+    while(!litSince(press, &edge))
+    {
+      pass();
+      if(simNow() - press > 100 * CYCLES_MS) { fail("no IR within 100ms of a press"); }
+    }
+
+    double us = (edge - press) * 1e6 / SIM_F_CPU;
+    total += us;
+    if(us < best)  { best = us; }
+    if(us > worst) { worst = us; }
+
+    //let go, and wait for the send and the debounce to finish
+    uint64_t release = simNow() + CYCLES_MS;
+    simSetButtons(release, 0);
+    while((simNow() < release + SETTLE) || isSending()) { pass(); }
+  }
+
+  printf("press to first IR edge, over %d presses: min %.1f us, mean %.1f us, max %.1f us\n",
+         presses, best, total / presses, worst);
+  printf("asleep %.1f%% of the time between presses (%u sleeps)\n", asleep * 100.0 / idle, simSleeps());
+  return 0;
+}
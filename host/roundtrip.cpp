@@ -0,0 +1,315 @@
+/*
+ * Written by Brendan Whitfield
+ *
+ * Learning round trip.
+ * Plays Pronto captures into learning mode (Learn.cpp) the way a receiver would, then loads
+ * the learned code back out of the (simulated) EEPROM, decodes it with the CodeCursor that
+ * sends it, and compares every burst with the capture. Each code goes through three times:
+ *
+ *   packer        the capture's own durations, straight into packLearned()
+ *   raw           a receiver that passes the carrier through (every carrier pulse is an edge)
+ *   demodulated   a receiver that only reports marks, late and a little stretched
+ *
+ * Only the first frame is learned (up to the first space longer than LEARN_TIMEOUT), and its
+ * last space is left out, as sending replaces it with the code's gap. Durations are compared
+ * in microseconds. Exits with 1 if any burst is further off than the tolerance.
+ *
+ * Codes keyed rc5_... or rc6_... (codes/rc.txt) also go through a fourth time:
+ *
+ *   protocol      stored as RC5 or RC6 payload bits, decoded by Protocols.cpp, and exact
+ *                 (bar the final space, the gap to the next frame)
+ *
+ *   g++ -O2 -I host -I . host/roundtrip.cpp host/Captures.cpp host/LearnSim.cpp host/TransmitSim.cpp Learn.cpp Transmit.cpp Codes.cpp Protocols.cpp Pronto.cpp -o roundtrip
+ *   ./roundtrip [codes/atv.txt ...] [--tolerance 5]
+ *   ./roundtrip codes/atv.txt codes/tv.txt codes/rc.txt
+ */
+
+
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "Captures.h"
+#include "Learn.h"
+#include "Protocols.h"
+#include "Transmit.h"
+
+
+
+#define TICK_US       ((double)LEARN_TICK / CARRIER_SCALE)
+#define DEMOD_DELAY   3.0      //carrier cycles a demodulating receiver takes to react to a mark
+#define DEMOD_STRETCH LEARN_STRETCH //and how much longer its marks come out (as much as Learn.cpp takes back)
+
+//a capture's first frame, in microseconds
+struct Frame
+{
+  std::string name;
+  double period;             //carrier cycle
+  std::vector<double> words; //on, off, on, off...
+};
+
+//how close a learned code came
+struct Result
+{
+  double worst;   //microseconds
+  double percent; //of the burst it was in
+  double carrier; //percent error of the carrier (raw receiver only)
+  int dict;       //dictionary entries
+  bool ok;
+};
+
+const char* toolName = "roundtrip";
+
+static double tolerance = 5; //percent, never less than a carrier cycle
+static uint32_t noise = 1;
+
+
+
+//timestamp the port would take at `us`, with 0 or 1 tick of interrupt latency (the timer wraps)
+static uint16_t stamp(double us)
+{
+  noise = (noise * 1103515245) + 12345;
+  return (uint16_t)((uint32_t)(us / TICK_US) + ((noise >> 16) & 1));
+}
+
+static std::vector<Frame> readPronto(const char* path)
+{
+  std::vector<Capture> captures = readCaptures(path);
+  std::vector<Frame> frames;
+  for(size_t c = 0; c < captures.size(); c++)
+  {
+    const std::vector<uint16_t>& words = captures[c].words;
+    Frame frame;
+    frame.name = captures[c].key;
+    frame.period = captures[c].period;
+    for(size_t i = 4; i + 1 < words.size(); i += 2)
+    {
+      frame.words.push_back(words[i] * frame.period);
+      frame.words.push_back(words[i + 1] * frame.period);
+      if(frame.words.back() > LEARN_TIMEOUT) { break; }
+    }
+    frames.push_back(frame);
+  }
+  return frames;
+}
+
+//decodes learned slot 0, and compares it with the frame
+static Result compare(const Frame& frame)
+{
+  Result r = {0, 0, 0, 0, false};
+  const IRCode* code = loadLearned(0);
+  if(!code) { return r; }
+
+  CodeCursor cursor;
+  BurstPair pair;
+  std::vector<double> words;
+  double period = (double)code->carrier / CARRIER_SCALE;
+  beginCode(&cursor, code, CODE_RAM);
+  while(nextBurst(&cursor, &pair))
+  {
+    words.push_back(pair.on * period);
+    words.push_back(pair.off * period);
+  }
+  if(words.size() != frame.words.size()) { return r; }
+
+  r.ok = true;
+  for(size_t i = 0; i + 1 < words.size(); i++)
+  {
+    double error = fabs(words[i] - frame.words[i]);
+    double allowed = frame.words[i] * tolerance / 100;
+    if(allowed < frame.period) { allowed = frame.period; }
+    if(error > allowed) { r.ok = false; }
+    if(error > r.worst)
+    {
+      r.worst = error;
+      r.percent = error * 100 / frame.words[i];
+    }
+  }
+  r.carrier = (code->carrier / (double)CARRIER_SCALE - frame.period) * 100 / frame.period;
+  return r;
+}
+
+static Result viaPacker(const Frame& frame)
+{
+  //the capture's durations in cycles, as a perfect receiver would measure them
+  BurstPair bursts[LEARN_BURSTS];
+  uint8_t length = frame.words.size() / 2;
+  if(length > LEARN_BURSTS) { fail("frame too long to learn: %s", frame.name.c_str()); }
+  for(uint8_t i = 0; i < length; i++)
+  {
+    bursts[i].on = (uint16_t)lround(frame.words[2 * i] / frame.period);
+    bursts[i].off = (uint16_t)lround(frame.words[(2 * i) + 1] / frame.period);
+  }
+
+  LearnedCode learned;
+  uint16_t carrier = (uint16_t)lround(frame.period * CARRIER_SCALE);
+  Result r = {0, 0, 0, 0, false};
+  if(!packLearned(&learned, bursts, length, carrier)) { return r; }
+  learnPortWrite(0, &learned);
+
+  r = compare(frame);
+  r.dict = learned.dictSize;
+  return r;
+}
+
+static Result viaReceiver(const Frame& frame, bool raw)
+{
+  beginLearning();
+
+  double t = 1000; //microseconds
+  for(size_t i = 0; i < frame.words.size(); i += 2)
+  {
+    double on = frame.words[i];
+    if(raw)
+    {
+      //a pulse per carrier cycle, lit for half of it
+      for(double pulse = 0; pulse < on - (frame.period / 4); pulse += frame.period)
+      {
+        learnEdge(stamp(t + pulse), 1);
+        learnEdge(stamp(t + pulse + (frame.period / 2)), 0);
+      }
+    }
+    else
+    {
+      double late = DEMOD_DELAY * frame.period;
+      learnEdge(stamp(t + late), 1);
+      learnEdge(stamp(t + late + on + (DEMOD_STRETCH * frame.period)), 0);
+    }
+    t += on + frame.words[i + 1];
+  }
+  learnTimeout();
+
+  Result r = {0, 0, 0, 0, false};
+  bool stored = (getLearnStatus() == LEARN_CAPTURED) && storeLearned(0);
+  stopLearning();
+  if(stored) { r = compare(frame); }
+  return r;
+}
+
+//a Philips frame stored as a protocol payload, the bits read off its half bits the way
+//tools/gencodes.py does, then decoded by Protocols.cpp. Every burst has to come back exactly,
+//bar the final space, the gap to the next frame (the protocol's gap is sent in its place)
+static Result viaProtocol(const Frame& frame, uint8_t format)
+{
+  Result r = {0, 0, 0, 0, false};
+  size_t count = frame.words.size();
+  std::vector<uint16_t> cycles;
+  for(size_t i = 0; i < count; i++) { cycles.push_back((uint16_t)lround(frame.words[i] / frame.period)); }
+
+  uint16_t unit = 0xFFFF;
+  for(size_t i = 0; i + 1 < count; i++)
+  {
+    if(cycles[i] < unit) { unit = cycles[i]; }
+  }
+
+  //half bits from the start of the frame (RC5's first bit starts with half a bit of space)
+  std::vector<uint8_t> levels((format == PROTOCOL_RC5) ? 1 : 0, 0);
+  for(size_t i = 0; i + 1 < count; i++)
+  {
+    if(cycles[i] % unit) { return r; }
+    levels.insert(levels.end(), cycles[i] / unit, (i % 2) ? 0 : 1);
+  }
+
+  uint8_t payload[4] = {0, 0, 0, 0};
+  uint8_t bits = pgm_read_byte(&protocols[format - 1].frame);
+  for(uint8_t b = 0; b < bits; b++)
+  {
+    //RC5 sends "1" as space-mark, RC6 as mark-space after its leader (the trailer bit is twice as wide)
+    size_t at = (format == PROTOCOL_RC5) ? (2 * b) + 1 : 8 + (2 * b) + ((b > 4) ? 2 : 0);
+    if((at < levels.size()) && levels[at]) { payload[b >> 3] |= 1 << (b & 7); }
+  }
+
+  BurstPair dict = {unit, unit};
+  IRCode code = {&dict, payload, (uint16_t)lround(frame.period * CARRIER_SCALE), (uint8_t)(count / 2), format};
+  CodeCursor cursor;
+  BurstPair pair;
+  std::vector<uint16_t> decoded;
+  beginCode(&cursor, &code);
+  while(nextBurst(&cursor, &pair))
+  {
+    decoded.push_back(pair.on);
+    decoded.push_back(pair.off);
+  }
+  if(decoded.size() != count) { return r; }
+
+  r.ok = (decoded[count - 1] <= cycles[count - 1]);
+  for(size_t i = 0; i + 1 < count; i++)
+  {
+    double error = fabs(decoded[i] - (double)cycles[i]) * frame.period;
+    if(error > 0) { r.ok = false; }
+    if(error > r.worst)
+    {
+      r.worst = error;
+      r.percent = error * 100 / frame.words[i];
+    }
+  }
+  return r;
+}
+
+static void report(const char* how, const std::vector<Result>& results, int* failed)
+{
+  double worst = 0;
+  double percent = 0;
+  double carrier = 0;
+  int bad = 0;
+  for(size_t i = 0; i < results.size(); i++)
+  {
+    if(!results[i].ok) { bad++; }
+    if(results[i].worst > worst) { worst = results[i].worst; percent = results[i].percent; }
+    if(fabs(results[i].carrier) > fabs(carrier)) { carrier = results[i].carrier; }
+  }
+
+  printf("  %-12s worst burst off by %6.1f us (%4.1f%%), carrier %+.2f%%, %d out of tolerance\n",
+         how, worst, percent, carrier, bad);
+  *failed += bad;
+}
+
+int main(int argc, char** argv)
+{
+  std::vector<const char*> files;
+  for(int i = 1; i < argc; i++)
+  {
+    if(!strcmp(argv[i], "--tolerance") && (i + 1 < argc)) { tolerance = atof(argv[++i]); }
+    else if(argv[i][0] == '-') { fail("usage: roundtrip [file ...] [--tolerance percent]"); }
+    else { files.push_back(argv[i]); }
+  }
+  if(files.empty()) { files.push_back("codes/atv.txt"); }
+
+  int failed = 0;
+  for(size_t f = 0; f < files.size(); f++)
+  {
+    std::vector<Frame> frames = readPronto(files[f]);
+    std::vector<Result> packer, raw, demodulated, protocol;
+    int smallest = LEARN_DICT;
+    int largest = 0;
+    size_t longest = 0;
+
+    for(size_t i = 0; i < frames.size(); i++)
+    {
+      packer.push_back(viaPacker(frames[i]));
+      raw.push_back(viaReceiver(frames[i], true));
+      demodulated.push_back(viaReceiver(frames[i], false));
+      if(!frames[i].name.compare(0, 4, "rc5_")) { protocol.push_back(viaProtocol(frames[i], PROTOCOL_RC5)); }
+      if(!frames[i].name.compare(0, 4, "rc6_")) { protocol.push_back(viaProtocol(frames[i], PROTOCOL_RC6)); }
+      packer.back().carrier = 0;
+      demodulated.back().carrier = 0; //assumed, not measured
+
+      if(packer.back().dict < smallest) { smallest = packer.back().dict; }
+      if(packer.back().dict > largest)  { largest = packer.back().dict; }
+      if(frames[i].words.size() / 2 > longest) { longest = frames[i].words.size() / 2; }
+    }
+
+    printf("%s: %d codes, up to %d bursts, dictionaries of %d-%d pairs\n",
+           files[f], (int)frames.size(), (int)longest, smallest, largest);
+    report("packer", packer, &failed);
+    report("raw", raw, &failed);
+    report("demodulated", demodulated, &failed);
+    if(!protocol.empty()) { report("protocol", protocol, &failed); }
+  }
+
+  printf("\n%d codes out of tolerance (%.1f%%, or a carrier cycle)\n", failed, tolerance);
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,340 @@
+/*
+ * Written by Brendan Whitfield
+ *
+ * Serial command test.
+ * Builds the sketch itself (IR_Transmit.ino) against the stand-in Arduino core, the simulated
+ * timer and the loopback serial port of CommandSim.cpp, then sends it a script of frames
+ * (see Command.h): a batch of repeated sends on both emitters with a status query, a sweep
+ * that arrives while the batch is still going out, a damaged frame, a bad command, a
+ * frame that stops halfway, a stream that's fed a few pairs, a malformed byte, then nothing,
+ * and a Pronto stream that times out before its frequency word (host/streamsim.cpp tests
+ * streams properly). Every reply is printed, and checked:
+ *
+ *   each frame gets the REPLY_FRAME status it should
+ *   every command taken gets a REPLY_DONE, in order, after its last mark
+ *   the stream with no carrier is dropped, its REPLY_DONE says so and nothing goes out
+ *   the time each REPLY_DONE reports runs from the command's first mark (on either pin) to
+ *   the reply, to within --tolerance microseconds (the reply goes out as its last code
+ *   ends, once its last space is over)
+ *
+ * Exits with 1 if anything is off.
+ *
+ * --pty opens a pseudo terminal instead, and runs the sketch against it in real time, so
+ * a PC side tool (tools/ircmd.py) can talk to it as if it were the board.
+ *
+ *   g++ -O2 -I host -I . host/serialsim.cpp host/Captures.cpp host/TransmitSim.cpp host/ButtonsSim.cpp host/LearnSim.cpp host/CommandSim.cpp host/HitsSim.cpp Buttons.cpp Learn.cpp Command.cpp Hits.cpp Transmit.cpp Sweep.cpp Codes.cpp Protocols.cpp Pronto.cpp -o serialsim
+ *   ./serialsim [--tolerance 100]
+ *   ./serialsim --pty
+ */
+
+
+
+#define _XOPEN_SOURCE 600
+#include <fcntl.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+#include "Arduino.h"
+#include "Captures.h"
+#include "CommandSim.h"
+#include "Pronto.h"
+
+//the Arduino IDE generates these for the sketch
+void setDisplay(int n);
+
+#include "IR_Transmit.ino"
+
+
+
+#define LOOP_CYCLES 150 //the sketch's own work in each pass of loop(), besides the calls it makes
+#define CYCLES_MS   (SIM_F_CPU / 1000)
+#define CYCLES_US   (SIM_F_CPU / 1000000)
+
+//a reply, as it came back
+struct Reply
+{
+  uint64_t time;
+  std::vector<uint8_t> payload;
+};
+
+const char* toolName = "serialsim";
+
+
+
+static void pass()
+{
+  loop();
+  simRun(simNow() + LOOP_CYCLES);
+}
+
+static uint8_t crc8(uint8_t crc, uint8_t data)
+{
+  crc ^= data;
+  for(int i = 0; i < 8; i++) { crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : (crc << 1); }
+  return crc;
+}
+
+//a frame around `payload`
+static std::vector<uint8_t> frame(const std::vector<uint8_t>& payload)
+{
+  std::vector<uint8_t> bytes;
+  bytes.push_back(COMMAND_SYNC);
+  bytes.push_back(payload.size());
+  uint8_t crc = crc8(0, payload.size());
+  for(size_t i = 0; i < payload.size(); i++)
+  {
+    bytes.push_back(payload[i]);
+    crc = crc8(crc, payload[i]);
+  }
+  bytes.push_back(crc);
+  return bytes;
+}
+
+static void send(uint64_t at, const std::vector<uint8_t>& bytes)
+{
+  simSerialSend(at, bytes.data(), bytes.size());
+}
+
+static uint32_t get32(const std::vector<uint8_t>& p, size_t at)
+{
+  return p[at] | (p[at + 1] << 8) | (p[at + 2] << 16) | ((uint32_t)p[at + 3] << 24);
+}
+
+//splits what the board wrote into replies, checking their framing
+static std::vector<Reply> replies()
+{
+  const std::vector<SimSerialByte>& bytes = simSerialWritten();
+  std::vector<Reply> found;
+
+  for(size_t i = 0; i < bytes.size();)
+  {
+    if((bytes[i].data != COMMAND_SYNC) || (i + 2 >= bytes.size())) { check(false, "reply framing"); break; }
+    uint8_t length = bytes[i + 1].data;
+    if(i + 2 + length >= bytes.size()) { check(false, "reply cut short"); break; }
+
+    Reply r;
+    r.time = bytes[i].time;
+    uint8_t crc = crc8(0, length);
+    for(uint8_t n = 0; n < length; n++)
+    {
+      r.payload.push_back(bytes[i + 2 + n].data);
+      crc = crc8(crc, bytes[i + 2 + n].data);
+    }
+    check(crc == bytes[i + 2 + length].data, "reply crc");
+    found.push_back(r);
+    i += 3 + length;
+  }
+  return found;
+}
+
+//first and last marks of either emitter between `from` and `to`, false if there are none
+static bool marks(uint64_t from, uint64_t to, uint64_t* first, uint64_t* last)
+{
+  bool rose = false;
+  bool fell = false;
+  for(uint8_t channel = 0; channel < SEND_CHANNELS; channel++)
+  {
+    const std::vector<SimTick>& ticks = simTicks(channel);
+    for(size_t i = 0; i < ticks.size(); i++)
+    {
+      if((ticks[i].time <= from) || (ticks[i].time > to)) { continue; }
+      if((ticks[i].level == 1) && (!rose || (ticks[i].time < *first))) { *first = ticks[i].time; rose = true; }
+      if((ticks[i].level == 0) && (!fell || (ticks[i].time > *last)))  { *last = ticks[i].time; fell = true; }
+    }
+  }
+  return rose && fell;
+}
+
+
+
+static int script(double tolerance)
+{
+  simReset();
+  setup();
+  uint64_t t = simNow() + CYCLES_MS;
+
+  //1: POWER_ON[0] three times on pin 12, PROJ_POWER_ON[0] on pin 13, and how things stand
+  std::vector<uint8_t> batch = {
+    COMMAND_REPEAT, 3, 0x20, 0x4E, //20000us
+    COMMAND_SEND, TABLE_POWER_ON, 0, 0,
+    COMMAND_SEND, TABLE_PROJ_POWER_ON, 0, 1,
+    COMMAND_STATUS
+  };
+  send(t, frame(batch));
+
+  //2: a sweep, arriving while that's still going out
+  send(t + 40 * CYCLES_MS, frame({COMMAND_SWEEP, TABLE_MUTE}));
+
+  //3: damaged on the way
+  std::vector<uint8_t> damaged = frame({COMMAND_SWEEP, TABLE_POWER_OFF});
+  damaged[3] ^= 0x10;
+  send(t + 60 * CYCLES_MS, damaged);
+
+  //4: no such table
+  send(t + 80 * CYCLES_MS, frame({COMMAND_SWEEP, 200}));
+
+  //5: cut off halfway, then a good one once it's been given up on
+  std::vector<uint8_t> cut = frame({COMMAND_SEND, TABLE_VOLUME_UP, 1, 0});
+  cut.resize(3);
+  send(t + 100 * CYCLES_MS, cut);
+  send(t + 300 * CYCLES_MS, frame({COMMAND_SEND, TABLE_VOLUME_UP, 1, 1}));
+
+  //6: stream bytes with no stream open
+  send(t + 400 * CYCLES_MS, frame({COMMAND_DATA, 1, 22, 22}));
+
+  //7: a binary stream on pin 13, three pairs of it, a value cut short, then nothing until it times out
+  send(t + 420 * CYCLES_MS, frame({COMMAND_STREAM, 1, STREAM_BINARY, 0xA5, 0x01})); //421, 38kHz
+  send(t + 440 * CYCLES_MS, frame({COMMAND_DATA, 0, 22, 22, 22, 65, 22, 22}));
+  send(t + 460 * CYCLES_MS, frame({COMMAND_DATA, 1, 0x81}));
+
+  //8: a Pronto stream on pin 12 that stops after the first header word, so it times out without a carrier
+  send(t + 1500 * CYCLES_MS, frame({COMMAND_STREAM, 0, STREAM_PRONTO, 0, 0}));
+  send(t + 1520 * CYCLES_MS, frame({COMMAND_DATA, 0, '0', '0', '0', '0', ' '}));
+
+  while((simSerialNext() != UINT64_MAX) || !commandsIdle() || isSending())
+  {
+    pass();
+    if(simNow() > 5000 * CYCLES_MS) { fail("the commands never finished"); }
+  }
+
+  //what came back
+  std::vector<Reply> got = replies();
+  std::vector<uint8_t> frameStatus;
+  std::vector<uint8_t> doneIds;
+  uint64_t after = 0; //end of the last command's marks
+  double worst = 0;
+  const uint32_t wantPairs[] = {3, 0}; //of each stream
+  const uint32_t wantBytes[] = {6, 5};
+  size_t streams = 0;
+
+  printf("%10s  reply\n", "ms");
+  for(size_t i = 0; i < got.size(); i++)
+  {
+    const std::vector<uint8_t>& p = got[i].payload;
+    printf("%10.2f  ", (double)got[i].time / CYCLES_MS);
+
+    if(p[0] == REPLY_FRAME && p.size() == 5)
+    {
+      static const char* names[] = {"ok", "bad crc", "bad command", "full", "late"};
+      printf("frame    %-11s taken %d, first id %d, %d free\n", p[1] < 5 ? names[p[1]] : "?", p[2], p[3], p[4]);
+      frameStatus.push_back(p[1]);
+    }
+    else if(p[0] == REPLY_STREAM && p.size() == 18)
+    {
+      printf("stream   id %d, %u pairs, %u bytes, %d underruns, %u us\n", p[1], get32(p, 2), get32(p, 6), p[10] | (p[11] << 8), get32(p, 14));
+      check((streams < NUM_ELEM(wantPairs)) && (get32(p, 2) == wantPairs[streams]) && (get32(p, 6) == wantBytes[streams]), "stream pairs and bytes");
+      streams++;
+    }
+    else if(p[0] == REPLY_STATUS && p.size() == 10)
+    {
+      printf("status   %d waiting, %d free, %s, next id %d, last id %d took %u us\n",
+             p[1], p[2], p[3] ? "sending" : "quiet", p[4], p[5], get32(p, 6));
+    }
+    else if(p[0] == REPLY_DONE && p.size() == 10)
+    {
+      uint32_t reported = get32(p, 4);
+      uint64_t first = 0;
+      uint64_t last = 0;
+      double actual = 0;
+      double space = 0; //from the last mark to the reply
+      uint16_t dropped = p[8] | (p[9] << 8);
+      if(!(p[2] | p[3]))
+      {
+        //a dropped stream, nothing went out for it
+        printf("done     id %d, no codes, %d dropped, %u us\n", p[1], dropped, reported);
+        check((dropped == 1) && !reported && !marks(after, got[i].time, &first, &last), "dropped stream sent nothing");
+        doneIds.push_back(p[1]);
+        continue;
+      }
+      if(marks(after, got[i].time, &first, &last))
+      {
+        actual = (double)(got[i].time - first) / CYCLES_US;
+        space = (double)(got[i].time - last) / CYCLES_US;
+        after = last;
+      }
+      double error = reported - actual;
+      if(fabs(error) > fabs(worst)) { worst = error; }
+
+      printf("done     id %d, %d codes, %u us (first mark to reply %.0f us, %+.0f, last mark %.0f us before)\n",
+             p[1], p[2] | (p[3] << 8), reported, actual, error, space);
+      check(first && (fabs(error) <= tolerance) && !dropped, "reported time");
+      doneIds.push_back(p[1]);
+    }
+    else
+    {
+      printf("?\n");
+      check(false, "unknown reply");
+    }
+  }
+
+  const uint8_t wantStatus[] = {COMMAND_OK, COMMAND_OK, COMMAND_BAD_CRC, COMMAND_BAD, COMMAND_LATE, COMMAND_OK,
+                                COMMAND_BAD, COMMAND_OK, COMMAND_OK, COMMAND_BAD, COMMAND_OK, COMMAND_OK};
+  const uint8_t wantIds[] = {0, 1, 2, 3, 4, 5};
+  check(frameStatus == std::vector<uint8_t>(wantStatus, wantStatus + sizeof(wantStatus)), "frame statuses");
+  check(doneIds == std::vector<uint8_t>(wantIds, wantIds + sizeof(wantIds)), "commands done, in order");
+  check(simSerialLost() == 0, "bytes lost");
+
+  printf("\nworst reported time %+.0f us off the emitters, %u bytes lost, %d problems\n", worst, simSerialLost(), failures());
+  return failures() ? 1 : 0;
+}
+
+
+
+//runs the sketch against a pseudo terminal, in step with the wall clock
+static int pty()
+{
+  int master = posix_openpt(O_RDWR | O_NOCTTY);
+  if((master < 0) || grantpt(master) || unlockpt(master)) { fail("can't open a pseudo terminal"); }
+  fcntl(master, F_SETFL, O_NONBLOCK);
+  printf("%s\n", ptsname(master));
+  fflush(stdout);
+
+  simReset();
+  setup();
+
+  struct timespec start;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  size_t written = 0;
+
+  for(;;)
+  {
+    uint8_t buffer[256];
+    ssize_t n = read(master, buffer, sizeof(buffer));
+    if(n > 0) { simSerialSend(simNow(), buffer, n); }
+
+    pass();
+
+    const std::vector<SimSerialByte>& out = simSerialWritten();
+    for(; written < out.size(); written++)
+    {
+      if(write(master, &out[written].data, 1) != 1) { fail("lost the pseudo terminal"); }
+    }
+
+    //don't get ahead of the wall clock
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    double real = (now.tv_sec - start.tv_sec) * 1e6 + (now.tv_nsec - start.tv_nsec) / 1e3;
+    double ahead = (double)simNow() / CYCLES_US - real;
+    if(ahead > 1000) { usleep((useconds_t)ahead); }
+  }
+  return 0;
+}
+
+int main(int argc, char** argv)
+{
+  double tolerance = 100;
+  bool usePty = false;
+
+  for(int i = 1; i < argc; i++)
+  {
+    if(!strcmp(argv[i], "--tolerance") && (i + 1 < argc)) { tolerance = atof(argv[++i]); }
+    else if(!strcmp(argv[i], "--pty")) { usePty = true; }
+    else { fail("usage: serialsim [--tolerance 100] | serialsim --pty"); }
+  }
+
+  return usePty ? pty() : script(tolerance);
+}
@@ -0,0 +1,367 @@
+/*
+ * Written by Brendan Whitfield
+ *
+ * Streaming test.
+ * Builds the sketch itself (IR_Transmit.ino) like serialsim.cpp does, and streams it a Pronto
+ * capture played over and over as one long code, far longer than the ring holds (see Pronto.h).
+ * It's sent the way a PC would: a COMMAND_STREAM, then DATA frames as fast as the line and
+ * the credit allow. Once as Pronto hex, and once in the compact binary format. Each time:
+ *
+ *   every burst pair comes out of the emitter as it was sent, apart from the stalls
+ *   the underruns and stalled cycles the board reports are the ones seen on the emitter
+ *   every frame is taken, and no bytes are lost
+ *
+ * and the throughput is reported, end to end: from the STREAM frame going out to its
+ * REPLY_STREAM coming back, against how long the code itself lasts.
+ * Then a short stream in each format with an empty pair (no ON, no OFF) in it: the frame
+ * carrying it has to be turned away, and the pair after it played.
+ * Exits with 1 if anything is off.
+ *
+ * --squeeze cuts every OFF longer than that many carrier cycles down to it, dropping the gaps
+ * between frames, so the code plays faster than Pronto hex can come in and the ring runs dry.
+ *
+ *   g++ -O2 -I host -I . host/streamsim.cpp host/Captures.cpp host/TransmitSim.cpp host/ButtonsSim.cpp host/LearnSim.cpp host/CommandSim.cpp host/HitsSim.cpp Buttons.cpp Learn.cpp Command.cpp Hits.cpp Transmit.cpp Sweep.cpp Codes.cpp Protocols.cpp Pronto.cpp -o streamsim
+ *   ./streamsim [--codes codes/atv.txt] [--code 0x9602] [--repeat 20] [--channel 0] [--squeeze 0]
+ */
+
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "Arduino.h"
+#include "Captures.h"
+#include "CommandSim.h"
+#include "Pronto.h"
+
+//the Arduino IDE generates these for the sketch
+void setDisplay(int n);
+
+#include "IR_Transmit.ino"
+
+
+
+#define LOOP_CYCLES 150 //the sketch's own work in each pass of loop(), besides the calls it makes
+#define CYCLES_US   (SIM_F_CPU / 1000000)
+#define DATA_BYTES  (COMMAND_FRAME - 2) //stream bytes a DATA frame holds
+
+//a DATA frame's worth of the stream
+struct Chunk
+{
+  std::vector<uint8_t> bytes;
+  int pairs; //burst pairs it finishes
+};
+
+//a reply, as it came back
+struct Reply
+{
+  uint64_t time;
+  std::vector<uint8_t> payload;
+};
+
+const char* toolName = "streamsim";
+
+
+
+static void pass()
+{
+  loop();
+  simRun(simNow() + LOOP_CYCLES);
+}
+
+static uint8_t crc8(uint8_t crc, uint8_t data)
+{
+  crc ^= data;
+  for(int i = 0; i < 8; i++) { crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : (crc << 1); }
+  return crc;
+}
+
+//sends a frame around `payload`, after whatever's already on the line
+static void send(const std::vector<uint8_t>& payload)
+{
+  std::vector<uint8_t> bytes;
+  bytes.push_back(COMMAND_SYNC);
+  bytes.push_back(payload.size());
+  uint8_t crc = crc8(0, payload.size());
+  for(size_t i = 0; i < payload.size(); i++)
+  {
+    bytes.push_back(payload[i]);
+    crc = crc8(crc, payload[i]);
+  }
+  bytes.push_back(crc);
+  simSerialSend(simNow(), bytes.data(), bytes.size());
+}
+
+static uint32_t get32(const std::vector<uint8_t>& p, size_t at)
+{
+  return p[at] | (p[at + 1] << 8) | (p[at + 2] << 16) | ((uint32_t)p[at + 3] << 24);
+}
+
+//the next whole reply the board wrote, after the `*read` bytes already seen. False if there's none yet
+static bool nextReply(size_t* read, Reply* r)
+{
+  const std::vector<SimSerialByte>& bytes = simSerialWritten();
+  size_t i = *read;
+  if((i + 2 >= bytes.size()) || (i + 2 + bytes[i + 1].data >= bytes.size())) { return false; }
+  if(bytes[i].data != COMMAND_SYNC) { fail("reply framing"); }
+
+  uint8_t length = bytes[i + 1].data;
+  uint8_t crc = crc8(0, length);
+  r->time = bytes[i].time;
+  r->payload.clear();
+  for(uint8_t n = 0; n < length; n++)
+  {
+    r->payload.push_back(bytes[i + 2 + n].data);
+    crc = crc8(crc, bytes[i + 2 + n].data);
+  }
+  check(crc == bytes[i + 2 + length].data, "reply crc");
+  *read = i + 3 + length;
+  return true;
+}
+
+
+
+//Pronto hex, a whole word or two at a time
+static std::vector<Chunk> hexChunks(const std::vector<uint16_t>& header, const std::vector<uint16_t>& pairs)
+{
+  std::vector<Chunk> chunks(1);
+  for(size_t i = 0; i < header.size() + pairs.size(); i++)
+  {
+    char word[8];
+    snprintf(word, sizeof(word), "%04x ", (i < header.size()) ? header[i] : pairs[i - header.size()]);
+    if(chunks.back().bytes.size() + strlen(word) > DATA_BYTES) { chunks.push_back(Chunk()); }
+
+    Chunk& c = chunks.back();
+    c.bytes.insert(c.bytes.end(), word, word + strlen(word));
+    if((i >= header.size()) && ((i - header.size()) % 2)) { c.pairs++; }
+  }
+  return chunks;
+}
+
+static std::vector<Chunk> binaryChunks(const std::vector<uint16_t>& pairs)
+{
+  std::vector<Chunk> chunks(1);
+  for(size_t i = 0; i < pairs.size(); i++)
+  {
+    std::vector<uint8_t> value;
+    if(pairs[i] < 0x80) { value.push_back(pairs[i]); }
+    else                { value.push_back(0x80 | (pairs[i] >> 8)); value.push_back(pairs[i] & 0xFF); }
+    if(chunks.back().bytes.size() + value.size() > DATA_BYTES) { chunks.push_back(Chunk()); }
+
+    Chunk& c = chunks.back();
+    c.bytes.insert(c.bytes.end(), value.begin(), value.end());
+    if(i % 2) { c.pairs++; }
+  }
+  return chunks;
+}
+
+//what a channel put out from tick `from` on, as ON, OFF, ON... in carrier cycles
+static std::vector<uint32_t> emitted(uint8_t channel, size_t from)
+{
+  const std::vector<SimTick>& ticks = simTicks(channel);
+  std::vector<uint32_t> found;
+  uint32_t on = 0;   //cycles of the mark so far
+  uint32_t idle = 0; //ticks since it ended
+
+  for(size_t i = from; i < ticks.size(); i++)
+  {
+    if(ticks[i].level == 1)
+    {
+      if(on && idle)
+      {
+        found.push_back(on);
+        found.push_back(idle / 2);
+        on = 0;
+        idle = 0;
+      }
+      on++;
+    }
+    else if((ticks[i].level == SIM_IDLE) && on) { idle++; }
+  }
+  found.push_back(on);
+  found.push_back(idle / 2);
+  return found;
+}
+
+
+
+//streams `pairs` to the board, and checks what came of it
+static void stream(const char* title, uint8_t format, uint16_t carrier, const std::vector<Chunk>& chunks,
+                   const std::vector<uint16_t>& pairs, uint8_t channel, double period)
+{
+  printf("%s\n", title);
+  size_t from = simTicks(channel).size();
+  size_t read = simSerialWritten().size();
+  uint64_t start = simNow();
+
+  send({COMMAND_STREAM, channel, format, (uint8_t)carrier, (uint8_t)(carrier >> 8)});
+
+  int credit = STREAM_PAIRS;
+  size_t next = 0;
+  int rejected = 0;
+  Reply r;
+  Reply done;
+  Reply result;
+  while(result.payload.empty())
+  {
+    //as much as the credit allows, straight onto the line
+    while((next < chunks.size()) && (chunks[next].pairs <= credit))
+    {
+      std::vector<uint8_t> payload = {COMMAND_DATA, (uint8_t)(next + 1 == chunks.size())};
+      payload.insert(payload.end(), chunks[next].bytes.begin(), chunks[next].bytes.end());
+      send(payload);
+      credit -= chunks[next].pairs;
+      next++;
+    }
+
+    pass();
+    while(nextReply(&read, &r))
+    {
+      if(r.payload[0] == REPLY_FRAME)       { rejected += (r.payload[1] != COMMAND_OK); }
+      else if(r.payload[0] == REPLY_CREDIT) { credit += r.payload[1]; }
+      else if(r.payload[0] == REPLY_DONE)   { done = r; }
+      else if(r.payload[0] == REPLY_STREAM) { result = r; }
+    }
+    if(simNow() - start > 600 * SIM_F_CPU) { fail("the stream never finished"); }
+  }
+
+  //what the board says
+  const std::vector<uint8_t>& p = result.payload;
+  uint32_t gotPairs = get32(p, 2);
+  uint32_t bytes = get32(p, 6);
+  uint16_t underruns = p[10] | (p[11] << 8);
+  uint16_t starved = p[12] | (p[13] << 8);
+  uint32_t micros = get32(p, 14);
+
+  //what the emitter says (the last pair's OFF runs on into the gap after it)
+  std::vector<uint32_t> got = emitted(channel, from);
+  uint32_t stalls = 0;
+  uint32_t stalled = 0;
+  bool same = (got.size() == pairs.size());
+  for(size_t i = 0; same && (i < pairs.size()); i++)
+  {
+    if((i % 2 == 0) || (i + 1 == pairs.size())) { same = (got[i] == pairs[i]) || ((i + 1 == pairs.size()) && (got[i] >= pairs[i])); continue; }
+    if(got[i] < pairs[i]) { same = false; }
+    if(got[i] > pairs[i]) { stalls++; stalled += got[i] - pairs[i]; }
+  }
+
+  double code = 0; //microseconds the code itself lasts
+  for(size_t i = 0; i < pairs.size(); i++) { code += pairs[i] * period; }
+  double total = (double)(result.time - start) / CYCLES_US; //end to end, as the sender sees it
+
+  printf("  %u burst pairs, %u bytes in %zu frames, %d turned away\n", gotPairs, bytes, chunks.size(), rejected);
+  printf("  underruns %u (%u seen), stalled %u carrier cycles (%u seen)\n", underruns, stalls, starved, stalled);
+  printf("  code lasts %.1f ms, stream took %.1f ms (%.1f end to end), first mark to done %.1f ms\n",
+         code / 1000, micros / 1000.0, total / 1000, get32(done.payload, 4) / 1000.0);
+  printf("  throughput %.0f bytes/s, %.0f pairs/s (the code plays %.0f pairs/s)\n\n",
+         bytes * 1e6 / micros, gotPairs * 1e6 / micros, (pairs.size() / 2) * 1e6 / code);
+
+  check(same, "burst pairs as sent");
+  check(gotPairs == pairs.size() / 2, "pairs reported");
+  check((underruns == stalls) && (starved == stalled), "stalls reported");
+  check(!rejected, "frames taken");
+  check(simSerialLost() == 0, "bytes lost");
+
+  //let it settle before the next one
+  while(!commandsIdle() || isSending()) { pass(); }
+}
+
+//a stream with an empty burst pair in it, sent in a frame of its own between `header` (if
+//any) and `good`, a pair that ends it. The empty one is turned away, and only `good` plays
+static void emptyPair(const char* title, uint8_t format, uint16_t carrier, const std::vector<uint8_t>& header,
+                      const std::vector<uint8_t>& empty, const std::vector<uint8_t>& good, uint32_t goodOn)
+{
+  printf("%s\n", title);
+  size_t from = simTicks(0).size();
+  size_t read = simSerialWritten().size();
+  uint64_t start = simNow();
+  std::vector<uint8_t> want = {COMMAND_OK};
+
+  send({COMMAND_STREAM, 0, format, (uint8_t)carrier, (uint8_t)(carrier >> 8)});
+  const std::vector<uint8_t>* parts[] = {&header, &empty, &good};
+  for(int i = 0; i < 3; i++)
+  {
+    if(parts[i]->empty()) { continue; }
+    std::vector<uint8_t> payload = {COMMAND_DATA, (uint8_t)(i == 2)};
+    payload.insert(payload.end(), parts[i]->begin(), parts[i]->end());
+    send(payload);
+    want.push_back((i == 1) ? COMMAND_BAD : COMMAND_OK);
+  }
+
+  std::vector<uint8_t> statuses;
+  Reply r;
+  Reply result;
+  while(result.payload.empty())
+  {
+    pass();
+    while(nextReply(&read, &r))
+    {
+      if(r.payload[0] == REPLY_FRAME)       { statuses.push_back(r.payload[1]); }
+      else if(r.payload[0] == REPLY_STREAM) { result = r; }
+    }
+    if(simNow() - start > 10 * SIM_F_CPU) { fail("the stream never finished"); }
+  }
+
+  std::vector<uint32_t> got = emitted(0, from);
+  printf("  %zu frames answered, %u burst pairs played, first mark %u cycles\n\n",
+         statuses.size(), get32(result.payload, 2), got[0]);
+  check(statuses == want, "empty pair turned away");
+  check((get32(result.payload, 2) == 1) && (got.size() == 2) && (got[0] == goodOn), "only the good pair played");
+
+  while(!commandsIdle() || isSending()) { pass(); }
+}
+
+int main(int argc, char** argv)
+{
+  const char* codes = "codes/atv.txt";
+  const char* key = "0x9602";
+  int repeat = 20;
+  uint8_t channel = 0;
+  int squeeze = 0;
+
+  for(int i = 1; i < argc; i++)
+  {
+    if(!strcmp(argv[i], "--codes") && (i + 1 < argc))        { codes = argv[++i]; }
+    else if(!strcmp(argv[i], "--code") && (i + 1 < argc))    { key = argv[++i]; }
+    else if(!strcmp(argv[i], "--repeat") && (i + 1 < argc))  { repeat = atoi(argv[++i]); }
+    else if(!strcmp(argv[i], "--channel") && (i + 1 < argc)) { channel = atoi(argv[++i]); }
+    else if(!strcmp(argv[i], "--squeeze") && (i + 1 < argc)) { squeeze = atoi(argv[++i]); }
+    else { fail("usage: streamsim [--codes codes/atv.txt] [--code 0x9602] [--repeat 20] [--channel 0] [--squeeze 0]"); }
+  }
+  if((repeat < 1) || (channel >= SEND_CHANNELS)) { fail("bad --repeat or --channel"); }
+
+  std::vector<Capture> captures = readCaptures(codes);
+  const Capture& capture = findCapture(captures, key, codes);
+  const std::vector<uint16_t>& words = capture.words;
+  std::vector<uint16_t> header(words.begin(), words.begin() + PRONTO_HEADER);
+  std::vector<uint16_t> pairs;
+  for(int i = 0; i < repeat; i++) { pairs.insert(pairs.end(), words.begin() + PRONTO_HEADER, words.end()); }
+  for(size_t i = 1; squeeze && (i < pairs.size()); i += 2)
+  {
+    if(pairs[i] > squeeze) { pairs[i] = squeeze; }
+  }
+  double period = capture.period;
+  uint16_t carrier = (uint16_t)(period * CARRIER_SCALE + 0.5);
+
+  printf("%s %s, %d times over: %zu burst pairs, ring of %d\n\n", codes, key, repeat, pairs.size() / 2, STREAM_PAIRS);
+
+  simReset();
+  setup();
+  simRun(simNow() + SIM_F_CPU / 1000);
+
+  stream("Pronto hex", STREAM_PRONTO, 0, hexChunks(header, pairs), pairs, channel, period);
+  stream("binary", STREAM_BINARY, carrier, binaryChunks(pairs), pairs, channel, period);
+
+  std::vector<uint8_t> none;
+  std::vector<uint8_t> hexHeader(hexChunks(header, std::vector<uint16_t>())[0].bytes);
+  const char* hexEmpty = "0000 0000 ";
+  const char* hexGood = "0016 0016";
+  emptyPair("Pronto hex, empty pair", STREAM_PRONTO, 0, hexHeader, std::vector<uint8_t>(hexEmpty, hexEmpty + strlen(hexEmpty)),
+            std::vector<uint8_t>(hexGood, hexGood + strlen(hexGood)), 22);
+  emptyPair("binary, empty pair", STREAM_BINARY, carrier, none, {0, 0}, {22, 22}, 22);
+
+  printf("%d problems\n", failures());
+  return failures() ? 1 : 0;
+}
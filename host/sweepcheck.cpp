@@ -0,0 +1,109 @@
+/*
+ * Written by Brendan Whitfield
+ *
+ * Sweep size check.
+ * A sweep counts its codes in a byte, over all of its tables (SWEEP_CODES). Builds tables
+ * of copies of the POWER_ON codes, big enough together to pass that, and checks:
+ *
+ *   a table that would take the sweep past SWEEP_CODES is turned away by addToSweep()
+ *   a sweep of exactly SWEEP_CODES sends every code once, and none after it
+ *   sweepFirst() takes the last position, and none past it
+ *
+ * Exits with 1 if any of them doesn't hold.
+ *
+ *   g++ -O2 -I host -I . host/sweepcheck.cpp host/TransmitSim.cpp Sweep.cpp Transmit.cpp Codes.cpp Protocols.cpp Pronto.cpp -o sweepcheck
+ *   ./sweepcheck
+ */
+
+
+
+#include <stdio.h>
+#include <vector>
+#include "Sweep.h"
+#include "TransmitSim.h"
+
+
+
+static int failures = 0;
+
+
+
+static void check(bool ok, const char* what)
+{
+  printf("%-44s %s\n", what, ok ? "ok" : "FAILED");
+  if(!ok) { failures++; }
+}
+
+//`total` codes, the POWER_ON ones over and over (so the carriers are mixed)
+static std::vector<IRCode> makeTable(uint8_t total)
+{
+  uint8_t have = pgm_read_byte(&codeTables[TABLE_POWER_ON].total);
+  std::vector<IRCode> table;
+  for(uint8_t i = 0; i < total; i++) { table.push_back(POWER_ON[i % have]); }
+  return table;
+}
+
+//runs the sweep to the end, and counts how often each code of `tables` went out
+static std::vector<int> runSweep(const std::vector<const std::vector<IRCode>*>& tables)
+{
+  std::vector<int> sent;
+  for(size_t t = 0; t < tables.size(); t++) { sent.resize(sent.size() + tables[t]->size()); }
+
+  const IRCode* code;
+  for(int ticket = sweep(&code); ticket != SWEEP_DONE; ticket = sweep(&code))
+  {
+    if(ticket == SEND_FULL)
+    {
+      simStep();
+      continue;
+    }
+
+    size_t position = 0;
+    for(size_t t = 0; t < tables.size(); t++)
+    {
+      const std::vector<IRCode>& table = *tables[t];
+      if((code >= table.data()) && (code < table.data() + table.size())) { sent[position + (code - table.data())]++; }
+      position += table.size();
+    }
+  }
+  while(simStep()) { }
+  return sent;
+}
+
+static bool eachOnce(const std::vector<int>& sent)
+{
+  for(size_t i = 0; i < sent.size(); i++)
+  {
+    if(sent[i] != 1) { return false; }
+  }
+  return true;
+}
+
+
+
+int main()
+{
+  std::vector<IRCode> big = makeTable(200);
+  std::vector<IRCode> rest = makeTable(SWEEP_CODES - 200);
+  std::vector<IRCode> over = makeTable(SWEEP_CODES - 200 + 1);
+
+  simReset();
+  beginTransmit();
+
+  //a table that doesn't fit leaves the sweep as it was
+  beginSweep(big.data(), big.size());
+  check(!addToSweep(over.data(), over.size()), "table past SWEEP_CODES turned away");
+  check(eachOnce(runSweep({&big})), "sweep without it sends its own codes once");
+
+  //one that just fits
+  beginSweep(big.data(), big.size());
+  check(addToSweep(rest.data(), rest.size()), "table up to SWEEP_CODES taken");
+  check(!addToSweep(big.data(), 1), "no room for one more code");
+  check(sweepFirst(SWEEP_CODES - 1), "last position can go first");
+  check(!sweepFirst(SWEEP_CODES), "no position past it");
+  std::vector<int> sent = runSweep({&big, &rest});
+  check(eachOnce(sent), "every code of a full sweep sent once");
+
+  printf("\n%d problems\n", failures);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,701 @@
+#!/usr/bin/env python3
+#
+# Written by Brendan Whitfield
+#
+# Builds the code tables in Codes.cpp/Codes.h from Pronto hex captures.
+#
+#   tools/gencodes.py [codes/manifest.txt] [--tolerance 0.03] [--no-protocols] [--no-packing] [--no-repeats] [--check]
+#
+# The manifest lists which capture goes into which table (see codes/manifest.txt).
+# For each brand, near-equal ON and OFF durations are clustered together, and the
+# distinct burst pairs that remain become that brand's dictionary. Brands that end up
+# with the same dictionary share a single copy in flash.
+#
+# When every code of a brand fits one of the protocols in Protocols.h, the codes are
+# stored as protocol payloads instead of nibble strings (--no-protocols turns this off).
+# Other codes with a dictionary of 8 or fewer pairs get their indices packed into 1-3 bits
+# each, rather than a whole nibble (--no-packing turns this off). Where frames or bursts
+# repeat, the indices are split into segments that are stored once and played several
+# times, if that comes out smaller (--no-repeats turns this off).
+#
+# Everything from the "Raw dictionary" comment to the end of Codes.cpp, and from
+# "//code tables" to the closing #endif of Codes.h, is rewritten. A report of the
+# flash used by each table is printed once the files are written.
+#
+
+import argparse
+import math
+import os
+import sys
+
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+PRONTO_UNIT = 0.241246 #microseconds per Pronto frequency unit
+CARRIER_SCALE = 16     #IRCode carriers are in 1/16ths of a microsecond
+MAX_DICT = 16          #indices are stored in nibbles
+
+#sizes on the AVR, used for the report
+SIZE_IRCODE = 8 #2 pointers, carrier (2 bytes), length, format
+SIZE_BURST = 4
+SIZE_SEGMENT = 2 #bursts, repeats
+
+MAX_REPEATS = 0x7F #SEGMENT_REPEATS
+MAX_LENGTH = 255    #codeLength is a byte
+
+
+
+class Code:
+    def __init__(self, section, table, brand, function, bursts, carrier):
+        self.section = section
+        self.table = table
+        self.brand = brand
+        self.function = function
+        self.bursts = bursts   #list of (on, off), in carrier cycles
+        self.carrier = carrier #period of the carrier, in 1/CARRIER_SCALE microseconds
+        self.indices = []      #filled in once the dictionary is known
+        self.dict_name = None
+        self.protocol = None   #set if stored as a protocol payload
+        self.payload = []      #payload bits, in the order they're sent
+        self.width = 4         #bits per dictionary index
+        self.segments = None   #[(bursts, repeats, final index or None)] if stored as a repeat code
+
+    def name(self):
+        return "code_%s_%s" % (self.brand, self.function)
+
+
+
+def fail(msg):
+    sys.exit("gencodes: " + msg)
+
+
+def parse_pronto(text, where):
+    words = [int(w, 16) for w in text.split()]
+    if len(words) < 4 or words[0] != 0x0000:
+        fail("%s: only learned (0000) pronto codes are supported" % where)
+
+    freq, once, repeat = words[1], words[2], words[3]
+    if freq == 0:
+        fail("%s: carrier frequency is zero" % where)
+
+    durations = words[4:]
+    if len(durations) != 2 * (once + repeat):
+        fail("%s: expected %d burst pairs, found %d" % (where, once + repeat, len(durations) / 2))
+
+    #the once sequence, followed by one pass of the repeat sequence
+    bursts = [(durations[i], durations[i + 1]) for i in range(0, len(durations), 2)]
+    carrier = int(round(freq * PRONTO_UNIT * CARRIER_SCALE))
+    return bursts, carrier
+
+
+def read_pronto_file(path):
+    codes = {}
+    with open(path) as f:
+        for n, line in enumerate(f, 1):
+            line = line.strip()
+            if not line or line.startswith("#"):
+                continue
+            if "=" not in line:
+                fail("%s:%d: expected <key>=<pronto hex>" % (path, n))
+            key, text = line.split("=", 1)
+            codes[key.strip()] = (text, "%s:%d" % (path, n))
+    return codes
+
+
+def read_manifest(path):
+    base = os.path.dirname(path)
+    files = {}
+    sections = [] #[(section name, [table names])]
+    codes = []
+
+    with open(path) as f:
+        for n, line in enumerate(f, 1):
+            line = line.split("#", 1)[0].strip()
+            if not line:
+                continue
+
+            if line.startswith("@section"):
+                sections.append((line[len("@section"):].strip(), []))
+                continue
+
+            fields = line.split()
+            if len(fields) not in (4, 5):
+                fail("%s:%d: expected <table> <brand> <function> <file> [<key>]" % (path, n))
+            table, brand, function, source = fields[:4]
+            key = fields[4] if len(fields) == 5 else "%s_%s" % (brand, function)
+
+            source = os.path.join(base, source)
+            if source not in files:
+                files[source] = read_pronto_file(source)
+            if key not in files[source]:
+                fail("%s:%d: no code named %s in %s" % (path, n, key, source))
+
+            text, where = files[source][key]
+            bursts, carrier = parse_pronto(text, where)
+            if len(bursts) > MAX_LENGTH:
+                fail("%s: %d bursts, at most %d fit in an IRCode" % (where, len(bursts), MAX_LENGTH))
+            if not sections:
+                sections.append(("", []))
+            codes.append(Code(sections[-1][0], table, brand, function, bursts, carrier))
+
+            if table != "-":
+                if not any(table in s[1] for s in sections):
+                    sections[-1][1].append(table)
+
+    return sections, codes
+
+
+
+def cluster(values, tolerance):
+    #maps every value to the count-weighted mean of its cluster
+    #a cluster spans values within `tolerance` of its smallest member (never less than 1 cycle)
+    counts = {}
+    for v in values:
+        counts[v] = counts.get(v, 0) + 1
+
+    mapping = {}
+    group = []
+    for v in sorted(counts) + [None]:
+        if group and (v is None or v - group[0] > max(1, int(group[0] * tolerance))):
+            total = sum(counts[g] for g in group)
+            mean = int(round(sum(g * counts[g] for g in group) / float(total)))
+            for g in group:
+                mapping[g] = mean
+            group = []
+        if v is not None:
+            group.append(v)
+    return mapping
+
+
+class Protocol:
+    #mirrors the table in Protocols.h
+    def __init__(self, name, bits, leader=False, stop=False, frame=0, manchester=False, rc6=False):
+        self.name = name
+        self.bits = bits #payload lengths this protocol can have
+        self.leader = leader
+        self.stop = stop
+        self.frame = frame
+        self.manchester = manchester
+        self.rc6 = rc6
+
+PROTOCOLS = [
+    Protocol("PROTOCOL_NEC", [32], leader=True, stop=True),
+    Protocol("PROTOCOL_SIRC", [12, 15, 20], leader=True),
+    Protocol("PROTOCOL_KASEIKYO", [48], leader=True, stop=True),
+    Protocol("PROTOCOL_JVC", [16], leader=True, stop=True),
+    Protocol("PROTOCOL_SHARP", [15, 30], stop=True, frame=16),
+    Protocol("PROTOCOL_MITSUBISHI", [16], stop=True),
+    Protocol("PROTOCOL_RC5", [14], frame=14, manchester=True),
+    Protocol("PROTOCOL_RC6", [21], frame=21, manchester=True, rc6=True),
+]
+
+
+def pulse_kinds(proto, length):
+    #what each burst of a pulse protocol code is: "extra", "zero" or "bit"
+    kinds = []
+    frame = proto.frame or (length - (1 if proto.leader else 0))
+    left = frame
+    for i in range(length):
+        if proto.leader and i == 0:
+            kinds.append("extra")
+            continue
+        if proto.stop:
+            left -= 1
+            if left == 0:
+                kinds.append("zero" if i == length - 1 else "extra")
+                left = frame
+                continue
+        kinds.append("bit")
+    return kinds
+
+
+def half_bit_levels(proto, bits):
+    if proto.rc6:
+        levels = [1] * 6 + [0] * 2
+        for i, b in enumerate(bits):
+            width = 2 if i == 4 else 1 #trailer bit
+            levels += [b] * width + [1 - b] * width
+        return levels
+    levels = []
+    for b in bits:
+        levels += [1 - b, b]
+    return levels
+
+
+def encode(proto, pairs, bits, length):
+    #the bursts the C encoder would send, given the payload
+    if proto.manchester:
+        unit = pairs[0][0]
+        levels = half_bit_levels(proto, bits)
+        while levels and not levels[0]:
+            levels.pop(0)
+        bursts = []
+        while levels:
+            on = off = 0
+            while levels and levels[0]:
+                on += 1
+                levels.pop(0)
+            while levels and not levels[0]:
+                off += 1
+                levels.pop(0)
+            bursts.append((on * unit, max(off, 1) * unit))
+        return bursts[:length]
+
+    bits = list(bits)
+    bursts = []
+    for kind in pulse_kinds(proto, length):
+        if kind == "bit":
+            bursts.append(pairs[bits.pop(0)])
+        else:
+            bursts.append(pairs[0 if kind == "zero" else 2])
+    return bursts
+
+
+def fit_pulse(proto, members):
+    groups = {"extra": set(), "zero": set(), "bit": set()}
+    for c in members:
+        kinds = pulse_kinds(proto, len(c.bursts))
+        if kinds.count("bit") not in proto.bits:
+            return None
+        for kind, b in zip(kinds, c.bursts):
+            groups[kind].add(b)
+
+    extra, zero = groups["extra"], groups["zero"]
+    symbols = groups["bit"] | zero
+    if len(extra) > 1 or len(zero) > 1 or len(symbols) != 2 or (extra & symbols):
+        return None
+
+    zero = zero.pop() if zero else min(symbols, key=lambda b: b[0] + b[1])
+    one = (symbols - set([zero])).pop()
+    pairs = [zero, one] + list(extra)
+
+    payloads = []
+    for c in members:
+        kinds = pulse_kinds(proto, len(c.bursts))
+        payloads.append([pairs.index(b) for kind, b in zip(kinds, c.bursts) if kind == "bit"])
+    return pairs, payloads
+
+
+def fit_manchester(proto, members):
+    unit = min(min(b) for c in members for b in c.bursts)
+    payloads = []
+    for c in members:
+        #the final space is the gap before the next frame, not part of this one
+        levels = []
+        for i, (on, off) in enumerate(c.bursts):
+            if i == len(c.bursts) - 1:
+                off = 0
+            if on % unit or off % unit:
+                return None
+            levels += [1] * (on // unit) + [0] * (off // unit)
+
+        #line the levels up with the first mark of a reference frame, then read the bits back
+        reference = half_bit_levels(proto, [1] * proto.bits[0])
+        levels = [0] * reference.index(1) + levels
+        bits = []
+        for i in range(proto.bits[0]):
+            if proto.rc6:
+                at = 8 + 2 * i + (2 if i > 4 else 0)
+                bits.append(levels[at] if at < len(levels) else 0)
+            else:
+                at = 2 * i + 1
+                bits.append(levels[at] if at < len(levels) else 0)
+        payloads.append(bits)
+    return [(unit, unit)], payloads
+
+
+def same_frame(proto, encoded, bursts):
+    #a manchester code's final space is left to the protocol's gap (see getProtocolGap()),
+    #so a capture that ends in a long space between frames still matches
+    if proto.manchester and encoded and len(encoded) == len(bursts):
+        return encoded[:-1] == bursts[:-1] and encoded[-1][0] == bursts[-1][0] and encoded[-1][1] <= bursts[-1][1]
+    return encoded == bursts
+
+
+def fit_protocol(members):
+    for proto in PROTOCOLS:
+        fit = fit_manchester(proto, members) if proto.manchester else fit_pulse(proto, members)
+        if not fit:
+            continue
+        pairs, payloads = fit
+        if all(same_frame(proto, encode(proto, pairs, bits, len(c.bursts)), c.bursts) for c, bits in zip(members, payloads)):
+            return proto, pairs, payloads
+    return None
+
+
+def find_segments(indices, width):
+    #cheapest split of the indices into segments, costed in bits of flash
+    n = len(indices)
+    best = [0] * (n + 1)
+    choice = [None] * (n + 1)
+    for i in range(n - 1, -1, -1):
+        best[i] = None
+
+        def consider(bursts, repeats, final):
+            end = i + bursts * repeats
+            cost = SIZE_SEGMENT * 8 + (bursts + (final is not None)) * width + best[end]
+            if best[i] is None or cost < best[i]:
+                best[i] = cost
+                choice[i] = (bursts, repeats, final)
+
+        for bursts in range(1, n - i + 1):
+            unit = indices[i:i + bursts]
+            repeats = 1
+            while True:
+                end = i + bursts * repeats
+                consider(bursts, repeats, None)
+                following = indices[end:end + bursts]
+                if len(following) < bursts or repeats == MAX_REPEATS:
+                    break
+                if following[:-1] == unit[:-1] and following[-1] != unit[-1]:
+                    consider(bursts, repeats + 1, following[-1])
+                if following != unit:
+                    break
+                repeats += 1
+
+    segments = []
+    i = 0
+    while i < n:
+        bursts, repeats, final = choice[i]
+        segments.append((bursts, repeats, final))
+        i += bursts * repeats
+    return segments
+
+
+def expand(indices, segments):
+    #the index string of a repeat code: each segment once, then its final index
+    out = []
+    i = 0
+    for bursts, repeats, final in segments:
+        out += indices[i:i + bursts]
+        if final is not None:
+            out.append(final)
+        i += bursts * repeats
+    return out
+
+
+def build_dictionaries(codes, tolerance, protocols, packing, repeats):
+    brands = []
+    for c in codes:
+        if c.brand not in brands:
+            brands.append(c.brand)
+
+    dicts = [] #[(name, [(on, off)])] in order of first use
+    for brand in brands:
+        members = [c for c in codes if c.brand == brand]
+        on = cluster([b[0] for c in members for b in c.bursts], tolerance)
+        off = cluster([b[1] for c in members for b in c.bursts], tolerance)
+
+        pairs = []
+        for c in members:
+            c.bursts = [(on[b[0]], off[b[1]]) for b in c.bursts]
+            for b in c.bursts:
+                if b not in pairs:
+                    pairs.append(b)
+
+        fit = fit_protocol(members) if protocols else None
+        if fit:
+            proto, pairs, payloads = fit
+            for c, bits in zip(members, payloads):
+                c.protocol = proto
+                c.payload = bits
+        elif len(pairs) > MAX_DICT:
+            fail("%s has %d distinct burst pairs, at most %d fit in a nibble" % (brand, len(pairs), MAX_DICT))
+
+        #reuse an identical dictionary from another brand, if there is one
+        #(protocol codes rely on the order of the dictionary, nibble strings don't)
+        name = "dict_" + brand
+        for other, other_pairs in dicts:
+            if other_pairs == pairs or (not fit and sorted(other_pairs) == sorted(pairs)):
+                name, pairs = other, other_pairs
+                break
+        else:
+            dicts.append((name, pairs))
+
+        for c in members:
+            c.dict_name = name
+            if not fit:
+                c.indices = [pairs.index(b) for b in c.bursts]
+                if packing:
+                    c.width = max(1, int(math.ceil(math.log(len(pairs), 2))))
+                if repeats:
+                    c.segments = find_segments(c.indices, c.width)
+                    if repeat_bytes(c) >= plain_bytes(c):
+                        c.segments = None
+
+    return dicts
+
+
+
+def pairs_of(items):
+    #groups a list pair-wise (padding with 0), the way Nibbles are written
+    items = list(items)
+    if len(items) % 2:
+        items.append(0)
+    return ["{%d, %d}" % (items[i], items[i + 1]) for i in range(0, len(items), 2)]
+
+
+def pack(values, width):
+    #packed LSB first, the way payloadBit() and packedIndex() read them
+    bits = [(v >> i) & 1 for v in values for i in range(width)]
+    data = []
+    for i, b in enumerate(bits):
+        if i % 8 == 0:
+            data.append(0)
+        data[-1] |= b << (i % 8)
+    return data
+
+
+def segment_header(c):
+    header = [len(c.segments)]
+    for bursts, repeats, final in c.segments:
+        header += [bursts, repeats | (0x80 if final is not None else 0)] #SEGMENT_FINAL
+    return header
+
+
+def code_data(c):
+    #contents of code[] (None for a Nibbles string)
+    if c.protocol:
+        return pack(c.payload, 1)
+    if c.segments:
+        return segment_header(c) + pack(expand(c.indices, c.segments), c.width)
+    if c.width < 4:
+        return pack(c.indices, c.width)
+    return None
+
+
+def code_format(c):
+    if c.protocol:
+        return c.protocol.name
+    if c.width < 4:
+        base = "FORMAT_BITS_%d" % c.width
+    else:
+        base = "FORMAT_NIBBLES"
+    if c.segments:
+        return "FORMAT_BITS_%d | FORMAT_REPEAT" % c.width #the index string is always bytes, even for nibbles
+    return base
+
+
+def plain_bytes(c):
+    return int(math.ceil(len(c.indices) * c.width / 8.0))
+
+
+def repeat_bytes(c):
+    return 1 + SIZE_SEGMENT * len(c.segments) + int(math.ceil(len(expand(c.indices, c.segments)) * c.width / 8.0))
+
+
+def code_bytes(c):
+    data = code_data(c)
+    if data is not None:
+        return len(data)
+    return int(math.ceil(len(c.bursts) / 2.0))
+
+
+def banner(table):
+    name = table[len("PROJ_"):] if table.startswith("PROJ_") else table
+    name = name.replace("_", " ")
+    return "//" + name + "=" * max(3, 58 - len(name))
+
+
+def emit_source(sections, codes, dicts):
+    out = []
+    out.append("/*")
+    out.append(" * Raw dictionary and code data. Linked to functions by pointers (shared dictionaries save space)")
+    out.append(" * Dictionaries store the different burst pairs.")
+    out.append(" * Codes store the a list of dictionary indices in the order of transmission.")
+    out.append(" * Indices for the codes are stored in nibbles to save space (hence the grouping),")
+    out.append(" * or packed even tighter when the dictionary is small (FORMAT_BITS_*)")
+    out.append(" * Repeated frames and runs of the same burst are stored once, with a count (FORMAT_REPEAT)")
+    out.append(" * Codes in a standard protocol store just their payload bits, and use the dictionary for timing (see Protocols.h)")
+    out.append(" * Bursts are decoded one at a time during transmission (see CodeCursor)")
+    out.append(" *")
+    out.append(" * Generated by tools/gencodes.py from codes/manifest.txt, edit those rather than this")
+    out.append(" */")
+
+    emitted = set()
+    for section, tables in sections:
+        out.append("")
+        if section:
+            out.append("//" + section)
+
+        brands = []
+        for c in codes:
+            if c.section == section and c.brand not in brands and c.brand not in emitted:
+                brands.append(c.brand)
+
+        for brand in brands:
+            emitted.add(brand)
+            members = [c for c in codes if c.brand == brand]
+            out.append("")
+            for name, pairs in dicts:
+                if name == "dict_" + brand:
+                    out.append("constexpr BurstPair %s[] PROGMEM = {%s};" % (name, ", ".join("{%d, %d}" % p for p in pairs)))
+            width = max(len(c.name()) for c in members) + len("[]")
+            for c in members:
+                data = code_data(c)
+                if data is not None:
+                    data = ", ".join("0x%02X" % b for b in data)
+                    out.append("constexpr uint8_t %s PROGMEM = {%s};" % ((c.name() + "[]").ljust(width), data))
+                else:
+                    out.append("constexpr Nibbles %s PROGMEM = {%s};" % ((c.name() + "[]").ljust(width), ", ".join(pairs_of(c.indices))))
+
+    out.append("")
+    out.append("")
+    out.append("")
+    out.append("")
+    out.append("/*")
+    out.append(" * Codes organized by function, then sorted by manufacturers (major to minor)")
+    out.append(" */")
+
+    for section, tables in sections:
+        out.append("")
+        if section:
+            out.append("//" + section)
+        for table in tables:
+            entries = [c for c in codes if c.table == table]
+            out.append("")
+            out.append(banner(table))
+            out.append("const IRCode %s[] PROGMEM = {" % table)
+            out.append(",\n".join("  IR_CODE(%s, %s, %d, %d, %s)" % (c.dict_name, c.name(), c.carrier, len(c.bursts), code_format(c))
+                                   for c in entries))
+            out.append("};")
+            out.append("static_assert(NUM_ELEM(%s) == %s_TOTAL, \"%s_TOTAL is out of date\");" % (table, table, table))
+
+    unlisted = [c for c in codes if c.table == "-"]
+    if unlisted:
+        out.append("")
+        out.append("//codes in no table, for the checks in host/ (nothing in the sketch uses them, so they're left out of its flash)")
+        out.append("const IRCode UNLISTED[] PROGMEM = {")
+        out.append(",\n".join("  IR_CODE(%s, %s, %d, %d, %s)" % (c.dict_name, c.name(), c.carrier, len(c.bursts), code_format(c))
+                               for c in unlisted))
+        out.append("};")
+        out.append("static_assert(NUM_ELEM(UNLISTED) == UNLISTED_TOTAL, \"UNLISTED_TOTAL is out of date\");")
+
+    out.append("")
+    out.append("")
+    out.append("")
+    out.append("//every table, numbered by its TABLE_ constant")
+    out.append("const CodeTable codeTables[NUM_TABLES] PROGMEM = {")
+    out.append(",\n".join("  {%s, %s_TOTAL}" % (table, table) for _, tables in sections for table in tables))
+    out.append("};")
+    return "\n".join(out) + "\n"
+
+
+def emit_header(sections, codes):
+    out = ["//code tables"]
+    for section, tables in sections:
+        out.append("")
+        if section:
+            out.append("//" + section)
+        for table in tables:
+            out.append("extern const IRCode %s[] PROGMEM;" % table)
+            out.append("constexpr uint8_t %s_TOTAL = %d;" % (table, len([c for c in codes if c.table == table])))
+
+    unlisted = len([c for c in codes if c.table == "-"])
+    if unlisted:
+        out.append("")
+        out.append("//codes in no table (not in codeTables)")
+        out.append("extern const IRCode UNLISTED[] PROGMEM;")
+        out.append("constexpr uint8_t UNLISTED_TOTAL = %d;" % unlisted)
+
+    #numbers for picking a table at run time (the serial commands, see Command.h)
+    out.append("")
+    out.append("//every table (codeTables[TABLE_...])")
+    names = [table for _, tables in sections for table in tables]
+    for n, table in enumerate(names):
+        out.append("constexpr uint8_t TABLE_%s = %d;" % (table, n))
+    out.append("constexpr uint8_t NUM_TABLES = %d;" % len(names))
+    out.append("extern const CodeTable codeTables[NUM_TABLES] PROGMEM;")
+    return "\n".join(out) + "\n"
+
+
+
+def splice(path, start, end, text):
+    with open(path) as f:
+        old = f.read()
+    a = old.find(start)
+    if a < 0:
+        fail("couldn't find '%s' in %s" % (start.strip(), path))
+    b = len(old) if end is None else old.find(end, a)
+    if b < 0:
+        fail("couldn't find '%s' in %s" % (end.strip(), path))
+    return old, old[:a] + text + old[b:]
+
+
+def report(sections, codes, dicts):
+    sizes = dict((name, len(pairs) * SIZE_BURST) for name, pairs in dicts)
+
+    print("%-20s %7s %7s %7s %7s %7s" % ("table", "entries", "ircode", "codes", "dicts", "total"))
+    counted = set()
+    grand = 0
+    for section, tables in sections:
+        for table in tables:
+            entries = [c for c in codes if c.table == table]
+            ircode = len(entries) * SIZE_IRCODE
+            nibbles = sum(code_bytes(c) for c in entries)
+
+            #a shared dictionary is charged to the first table that uses it
+            new = set(c.dict_name for c in entries) - counted
+            counted |= new
+            dict_bytes = sum(sizes[d] for d in new)
+
+            total = ircode + nibbles + dict_bytes
+            grand += total
+            print("%-20s %7d %7d %7d %7d %7d" % (table, len(entries), ircode, nibbles, dict_bytes, total))
+
+    #unlisted codes aren't in the total, nothing in the sketch uses them so the linker leaves them out
+    unlisted = [c for c in codes if c.table == "-"]
+    ircode = len(unlisted) * SIZE_IRCODE
+    nibbles = sum(code_bytes(c) for c in unlisted)
+    dict_bytes = sum(sizes[d] for d in set(c.dict_name for c in unlisted) - counted)
+    print("%-20s %7d %7d %7d %7d %7d" % ("(unlisted)", len(unlisted), ircode, nibbles, dict_bytes, ircode + nibbles + dict_bytes))
+
+    shared = len(set(c.brand for c in codes)) - len(dicts)
+    protocol = len([c for c in codes if c.protocol])
+    packed = len([c for c in codes if not c.protocol and c.width < 4])
+    repeat = len([c for c in codes if c.segments])
+    print("")
+    print("flash: %d bytes, not counting the unlisted codes, %d dictionaries (%d shared between brands)" % (grand, len(dicts), shared))
+    print("codes: %d stored as protocol payloads, %d as packed indices, %d as nibble strings"
+          % (protocol, packed, len(codes) - protocol - packed))
+    print("       %d of the indexed codes use repeat segments (%d of them unlisted)" % (repeat, len([c for c in unlisted if c.segments])))
+
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Build the Codes.cpp tables from Pronto captures")
+    parser.add_argument("manifest", nargs="?", default=os.path.join(ROOT, "codes", "manifest.txt"))
+    parser.add_argument("--tolerance", type=float, default=0.03, help="relative spread of a duration cluster")
+    parser.add_argument("--source", default=os.path.join(ROOT, "Codes.cpp"))
+    parser.add_argument("--header", default=os.path.join(ROOT, "Codes.h"))
+    parser.add_argument("--no-protocols", action="store_true", help="store every code as a nibble string")
+    parser.add_argument("--no-packing", action="store_true", help="always use a whole nibble per dictionary index")
+    parser.add_argument("--no-repeats", action="store_true", help="store every repeated frame in full")
+    parser.add_argument("--check", action="store_true", help="fail if the files are out of date, rather than writing them")
+    args = parser.parse_args()
+
+    sections, codes = read_manifest(args.manifest)
+    dicts = build_dictionaries(codes, args.tolerance, not args.no_protocols, not args.no_packing, not args.no_repeats)
+
+    outputs = [
+        splice(args.source, "/*\n * Raw dictionary and code data.", None, emit_source(sections, codes, dicts)),
+        splice(args.header, "//code tables\n", "\n#endif", emit_header(sections, codes)),
+    ]
+
+    stale = False
+    for path, (old, new) in zip([args.source, args.header], outputs):
+        if old == new:
+            continue
+        stale = True
+        if not args.check:
+            with open(path, "w") as f:
+                f.write(new)
+
+    if args.check and stale:
+        fail("tables are out of date, run tools/gencodes.py")
+
+    report(sections, codes, dicts)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,314 @@
+#!/usr/bin/env python3
+#
+# Written by Brendan Whitfield
+#
+# Sends serial commands to the board (see Command.h), and prints what comes back.
+#
+#   tools/ircmd.py PORT COMMAND [COMMAND ...] [--timeout 10]
+#
+#   send TABLE INDEX [CHANNEL]   send one code, on pin 12 (channel 0) or 13 (channel 1)
+#   sweep TABLE                  sweep a table over both emitters
+#   repeat COUNT [GAP]           run the next command COUNT times, GAP microseconds after each code (sends)
+#   status                       how things stand
+#
+# Tables go by their name in Codes.h (POWER_OFF, PROJ_VOLUME_UP...) or their number.
+# All the commands go in one frame, and the tool waits for every one of them to be done.
+# PORT is the board's serial port, or the pseudo terminal host/serialsim.cpp --pty prints.
+#
+#   tools/ircmd.py /dev/ttyUSB0 repeat 3 20000 send POWER_ON 0 sweep PROJ_POWER_OFF status
+#
+# A code that isn't in the tables can be streamed instead (see Pronto.h), from a file holding
+# a learned Pronto code, or from a file of them like codes/atv.txt, picked by its name:
+#
+#   tools/ircmd.py PORT stream SOURCE [binary] [channel N] [times N]
+#   tools/ircmd.py /dev/ttyUSB0 stream codes/atv.txt:0x9602 binary times 5
+#
+# It's sent as Pronto hex unless `binary` is given, played `times` over as one code.
+#
+
+import argparse
+import os
+import re
+import select
+import sys
+import termios
+import time
+
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+BAUD = termios.B57600 #COMMAND_BAUD
+SYNC = 0xA5           #COMMAND_SYNC
+MAX_FRAME = 32        #COMMAND_FRAME
+
+SEND, SWEEP, REPEAT, STATUS, STREAM, DATA = 0x01, 0x02, 0x03, 0x04, 0x05, 0x06
+REPLY_FRAME, REPLY_DONE, REPLY_STATUS, REPLY_CREDIT, REPLY_STREAM = 0x81, 0x82, 0x83, 0x84, 0x85
+FRAME_STATUS = ["ok", "bad crc", "bad command", "full", "late"]
+
+STREAM_PRONTO, STREAM_BINARY = 0, 1
+STREAM_PAIRS = 64          #STREAM_PAIRS, the credit a stream starts with
+DATA_BYTES = MAX_FRAME - 2 #stream bytes in a DATA frame
+PRONTO_UNIT = 0.241246     #microseconds per Pronto frequency unit
+CARRIER_SCALE = 16
+
+
+
+def fail(msg):
+    sys.stderr.write("ircmd: %s\n" % msg)
+    sys.exit(2)
+
+
+def crc8(data):
+    crc = 0
+    for byte in data:
+        crc ^= byte
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x07) & 0xFF if crc & 0x80 else (crc << 1) & 0xFF
+    return crc
+
+
+def frame(payload):
+    body = bytes([len(payload)]) + bytes(payload)
+    return bytes([SYNC]) + body + bytes([crc8(body)])
+
+
+def read_tables():
+    """table name -> number, from the TABLE_ constants in Codes.h"""
+    with open(os.path.join(ROOT, "Codes.h")) as f:
+        return dict((m.group(1), int(m.group(2)))
+                    for m in re.finditer(r"constexpr uint8_t TABLE_(\w+) = (\d+);", f.read()))
+
+
+def parse_commands(words, tables):
+    def table(word):
+        if word.isdigit():
+            return int(word)
+        if word not in tables:
+            fail("no table %s (%s)" % (word, ", ".join(sorted(tables))))
+        return tables[word]
+
+    def number(word, top):
+        if not word.isdigit() or int(word) > top:
+            fail("expected a number up to %d, not %s" % (top, word))
+        return int(word)
+
+    payload = []
+    taken = 0 #commands that will get a REPLY_DONE
+    status = False
+    i = 0
+    while i < len(words):
+        word = words[i]
+        args = []
+        while i + 1 + len(args) < len(words) and words[i + 1 + len(args)] not in ("send", "sweep", "repeat", "status"):
+            args.append(words[i + 1 + len(args)])
+        i += 1 + len(args)
+
+        if word == "send" and len(args) in (2, 3):
+            payload += [SEND, table(args[0]), number(args[1], 255), number(args[2], 255) if len(args) == 3 else 0]
+            taken += 1
+        elif word == "sweep" and len(args) == 1:
+            payload += [SWEEP, table(args[0])]
+            taken += 1
+        elif word == "repeat" and len(args) in (1, 2):
+            gap = number(args[1], 65535) if len(args) == 2 else 0
+            payload += [REPEAT, number(args[0], 255), gap & 0xFF, gap >> 8]
+        elif word == "status" and not args:
+            payload += [STATUS]
+            status = True
+        else:
+            fail("can't make sense of '%s'" % " ".join([word] + args))
+
+    if len(payload) > MAX_FRAME:
+        fail("that's %d bytes, a frame holds %d" % (len(payload), MAX_FRAME))
+    return payload, taken, status
+
+
+def open_port(path):
+    fd = os.open(path, os.O_RDWR | os.O_NOCTTY)
+    attrs = termios.tcgetattr(fd)
+    attrs[0] = 0                                            #iflag: no translation
+    attrs[1] = 0                                            #oflag
+    attrs[2] = termios.CS8 | termios.CREAD | termios.CLOCAL #cflag: 8N1
+    attrs[3] = 0                                            #lflag: raw
+    attrs[4] = attrs[5] = BAUD
+    termios.tcsetattr(fd, termios.TCSANOW, attrs)
+    return fd
+
+
+class Replies:
+    """the replies coming back from the board"""
+
+    def __init__(self, fd):
+        self.fd = fd
+        self.data = b""
+
+    def poll(self, wait):
+        """reply payloads that came in, waiting up to `wait` seconds for the first"""
+        ready, _, _ = select.select([self.fd], [], [], max(0, wait))
+        if ready:
+            self.data += os.read(self.fd, 256)
+
+        found = []
+        while self.data:
+            start = self.data.find(bytes([SYNC]))
+            if start < 0:
+                self.data = b""
+                break
+            self.data = self.data[start:]
+            if len(self.data) < 2 or len(self.data) < self.data[1] + 3:
+                break
+            body, check = self.data[1:self.data[1] + 2], self.data[self.data[1] + 2]
+            self.data = self.data[self.data[1] + 3:]
+            if crc8(body) != check:
+                print("(damaged reply)")
+                continue
+            found.append(body[1:])
+        return found
+
+    def until(self, deadline):
+        """yields each reply payload as it comes in, until the deadline"""
+        while time.time() < deadline:
+            for p in self.poll(deadline - time.time()):
+                yield p
+
+
+def u32(p, at):
+    return p[at] | (p[at + 1] << 8) | (p[at + 2] << 16) | (p[at + 3] << 24)
+
+
+def read_pronto(source):
+    """the words of a learned Pronto code, from FILE or FILE:NAME"""
+    path, _, name = source.partition(":")
+    try:
+        with open(path) as f:
+            text = f.read()
+    except OSError as e:
+        fail("can't read %s (%s)" % (path, e.strerror))
+
+    if name:
+        found = [line.split("=", 1)[1] for line in text.splitlines()
+                 if not line.startswith("#") and line.split("=", 1)[0].strip() == name and "=" in line]
+        if not found:
+            fail("no code named %s in %s" % (name, path))
+        text = found[0]
+
+    try:
+        words = [int(w, 16) for w in text.split()]
+    except ValueError:
+        fail("%s isn't Pronto hex" % source)
+    if len(words) < 6 or words[0] != 0 or not words[1] or len(words) % 2:
+        fail("%s isn't a learned (0000) Pronto code" % source)
+    return words
+
+
+def chunk(values, header_values):
+    """splits encoded values [(bytes, finishes a pair)] into DATA frames [(bytes, pairs)]"""
+    chunks = [[b"", 0]]
+    for data, pair in header_values + values:
+        if len(chunks[-1][0]) + len(data) > DATA_BYTES:
+            chunks.append([b"", 0])
+        chunks[-1][0] += data
+        chunks[-1][1] += pair
+    return chunks
+
+
+def stream(fd, words, fmt, channel, times, timeout):
+    pairs = words[4:] * times
+    carrier = int(round(words[1] * PRONTO_UNIT * CARRIER_SCALE))
+    if fmt == STREAM_BINARY:
+        values = [(bytes([v]) if v < 0x80 else bytes([0x80 | (v >> 8), v & 0xFF]), i % 2) for i, v in enumerate(pairs)]
+        chunks = chunk(values, [])
+    else:
+        values = [(b"%04x " % v, i % 2) for i, v in enumerate(pairs)]
+        chunks = chunk(values, [(b"%04x " % v, 0) for v in words[:4]])
+    if max(pairs) > 0x7FFF:
+        fail("a burst is too long to stream (0x7fff cycles at most)")
+
+    replies = Replies(fd)
+    os.write(fd, frame([STREAM, channel, fmt, carrier & 0xFF, carrier >> 8]))
+    started = time.time()
+    credit = STREAM_PAIRS
+    sent = 0
+    opened = False
+    done = None
+    deadline = time.time() + timeout
+
+    while time.time() < deadline:
+        while opened and sent < len(chunks) and chunks[sent][1] <= credit:
+            data, count = chunks[sent]
+            os.write(fd, frame([DATA, int(sent + 1 == len(chunks))] + list(data)))
+            credit -= count
+            sent += 1
+            deadline = time.time() + timeout
+
+        for p in replies.poll(0.05):
+            if p[0] == REPLY_FRAME and len(p) == 5:
+                if p[1] != 0:
+                    fail("the board turned a frame away (%s)" % (FRAME_STATUS[p[1]] if p[1] < len(FRAME_STATUS) else "?"))
+                opened = True
+            elif p[0] == REPLY_CREDIT and len(p) == 2:
+                credit += p[1]
+            elif p[0] == REPLY_DONE and len(p) == 10:
+                done = u32(p, 4)
+            elif p[0] == REPLY_STREAM and len(p) == 18:
+                took = u32(p, 14)
+                print("stream  id %d, %d pairs, %d bytes in %d frames" % (p[1], u32(p, 2), u32(p, 6), len(chunks)))
+                print("        %d underruns, %d carrier cycles stalled" % (p[10] | (p[11] << 8), p[12] | (p[13] << 8)))
+                print("        %.1f ms on the emitter, %.1f ms on the board, %.1f ms end to end"
+                      % ((done or 0) / 1000, took / 1000, (time.time() - started) * 1000))
+                print("        %.0f bytes/s, %.0f pairs/s" % (u32(p, 6) * 1e6 / took, u32(p, 2) * 1e6 / took))
+                return
+
+    fail("timed out")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Send serial commands to the IR transmitter")
+    parser.add_argument("port")
+    parser.add_argument("commands", nargs="+")
+    parser.add_argument("--timeout", type=float, default=10, help="seconds to wait for the commands to be done")
+    args = parser.parse_args()
+
+    if args.commands[0] == "stream":
+        fmt = STREAM_BINARY if "binary" in args.commands else STREAM_PRONTO
+        words = [w for w in args.commands[1:] if w != "binary"]
+        options = dict(zip(words[1::2], words[2::2]))
+        if len(words) % 2 == 0 or set(options) - {"channel", "times"} or not all(v.isdigit() for v in options.values()):
+            fail("can't make sense of '%s'" % " ".join(args.commands))
+        source = read_pronto(words[0])
+        stream(open_port(args.port), source, fmt, int(options.get("channel", 0)), int(options.get("times", 1)), args.timeout)
+        return
+
+    payload, taken, status = parse_commands(args.commands, read_tables())
+    fd = open_port(args.port)
+    os.write(fd, frame(payload))
+
+    waiting = None #ids still to be done
+    for p in Replies(fd).until(time.time() + args.timeout):
+        if p[0] == REPLY_FRAME and len(p) == 5:
+            print("frame   %s, %d taken (ids from %d), %d free"
+                  % (FRAME_STATUS[p[1]] if p[1] < len(FRAME_STATUS) else "?", p[2], p[3], p[4]))
+            if p[1] != 0:
+                sys.exit(1)
+            waiting = set((p[3] + n) & 0xFF for n in range(taken))
+        elif p[0] == REPLY_DONE and len(p) == 10:
+            dropped = p[8] | (p[9] << 8)
+            print("done    id %d, %d codes in %.1f ms%s" % (p[1], p[2] | (p[3] << 8), u32(p, 4) / 1000,
+                                                     ", %d dropped (no carrier)" % dropped if dropped else ""))
+            if waiting is not None:
+                waiting.discard(p[1])
+        elif p[0] == REPLY_STATUS and len(p) == 10:
+            print("status  %d waiting, %d free, %s, next id %d, last id %d took %.1f ms"
+                  % (p[1], p[2], "sending" if p[3] else "quiet", p[4], p[5], u32(p, 6) / 1000))
+            status = False
+        else:
+            print("(unknown reply %s)" % p.hex())
+
+        if waiting is not None and not waiting and not status:
+            return
+
+    fail("timed out")
+
+
+if __name__ == "__main__":
+    main()